@@ -0,0 +1,360 @@
+/*
+*	Throughput / cycles per byte of every sha1, sha2 and sha3 entry point, per backend and message size
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I.. sha_bench.cpp -o sha_bench -lpthread   (from bench/)
+*
+*	Usage:
+*		sha_bench [--min-size N] [--max-size N] [--min-time SECONDS] [--filter TEXT] [--json FILE]
+*
+*		sizes accept k / m / g suffixes (powers of 1024), default 0 B to 1 GiB in steps of 4x
+*		JSON goes to stdout (or --json FILE), a readable table to stderr
+*/
+
+
+#include "sha.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using namespace neo::hash;
+
+
+
+struct result {
+	std::string name, mode, backend;
+	size_t size, batch, calls;
+	double ns_per_call, mb_per_s, cycles_per_byte;
+};
+
+struct options {
+	size_t min_size = 0;
+	size_t max_size = size_t(1) << 30;
+	double min_time = 0.2;
+	std::string filter;
+	std::string json;
+};
+
+static options opt;
+static std::vector<result> results;
+static std::vector<uint8_t> data;
+static volatile uint8_t sink;
+
+
+
+static size_t parse_size(const std::string& s) {
+	size_t n = std::strtoull(s.c_str(), nullptr, 10);
+	switch(s.empty() ? 0 : s.back()) {
+		case 'g': case 'G': return n << 30;
+		case 'm': case 'M': return n << 20;
+		case 'k': case 'K': return n << 10;
+	}
+	return n;
+}
+
+static const char* backend_name(backend b) {
+	switch(b) {
+		case backend::automatic: return "automatic";
+		case backend::scalar:    return "scalar";
+		case backend::sha_ni:    return "sha_ni";
+		case backend::avx2:      return "avx2";
+		case backend::avx512:    return "avx512";
+	}
+	return "?";
+}
+
+static uint64_t ticks() {
+	return __rdtsc();
+}
+
+// runs fn (hashing bytes_per_call bytes) for at least opt.min_time, doubling the call count until it gets there
+static void measure(const std::string& name, const char* mode, backend b, size_t size, size_t batch, const std::function<void()>& fn) {
+
+	if(!opt.filter.empty() && name.find(opt.filter) == std::string::npos)
+		return;
+
+	typedef std::chrono::steady_clock clock;
+
+	fn(); // warm up (kernel pick, page faults)
+
+	size_t calls = 1;
+	double secs;
+	uint64_t cycles;
+	while(true) {
+		clock::time_point t0 = clock::now();
+		uint64_t c0 = ticks();
+		for(size_t i = 0; i < calls; i++)
+			fn();
+		cycles = ticks() - c0;
+		secs   = std::chrono::duration<double>(clock::now() - t0).count();
+		if(secs >= opt.min_time || calls >= (size_t(1) << 40))
+			break;
+		calls *= secs > 0 ? std::max<size_t>(2, std::min<size_t>(100, static_cast<size_t>(opt.min_time / secs * 1.2))) : 100;
+	}
+
+	double bytes = static_cast<double>(size) * batch * calls;
+	result r;
+	r.name            = name;
+	r.mode            = mode;
+	r.backend         = backend_name(b);
+	r.size            = size;
+	r.batch           = batch;
+	r.calls           = calls;
+	r.ns_per_call     = secs * 1e9 / calls;
+	r.mb_per_s        = bytes / secs / 1e6;
+	r.cycles_per_byte = bytes > 0 ? cycles / bytes : 0;
+	results.push_back(r);
+
+	std::fprintf(stderr, "%-28s %-11s %-9s %10zu x%-4zu %12.1f ns %10.1f MB/s %8.2f cpb\n",
+		r.name.c_str(), r.mode.c_str(), r.backend.c_str(), r.size, r.batch, r.ns_per_call, r.mb_per_s, r.cycles_per_byte);
+}
+
+static std::vector<size_t> sizes() {
+	std::vector<size_t> v;
+	if(opt.min_size == 0)
+		v.push_back(0);
+	for(size_t s = 1; s <= opt.max_size; s *= 4)
+		if(s >= opt.min_size)
+			v.push_back(s);
+	return v;
+}
+
+// batches are 64 messages laid out one after the other, up to 4 MiB each
+static const size_t batch_count = 64;
+static const size_t batch_max   = size_t(4) << 20;
+
+static std::vector<buffer> batch_of(size_t size) {
+	std::vector<buffer> msgs(batch_count);
+	for(size_t i = 0; i < batch_count; i++)
+		msgs[i] = buffer{&data[i * size], size};
+	return msgs;
+}
+
+
+
+template<class F>
+static void single(const std::string& name, backend b, F hash) {
+	for(size_t s : sizes())
+		measure(name, "single", b, s, 1, [&] { sink = hash(data.data(), s)[0]; });
+}
+
+template<class Hasher>
+static void incremental(const std::string& name, backend b) {
+	// 16 KiB updates, the way a file or socket would feed it
+	for(size_t s : sizes())
+		measure(name, "incremental", b, s, 1, [&] {
+			Hasher h;
+			for(size_t off = 0; off < s; off += 16384)
+				h.update(&data[off], std::min<size_t>(16384, s - off));
+			sink = h.finalize()[0];
+		});
+}
+
+template<size_t Bits>
+static void many(const std::string& name, backend b, void (*fn)(const buffer*, size_t, sha_t<Bits>*)) {
+	std::vector<sha_t<Bits>> out(batch_count);
+	for(size_t s : sizes()) {
+		if(s > batch_max)
+			break;
+		std::vector<buffer> msgs = batch_of(s);
+		measure(name, "batch", b, s, batch_count, [&] {
+			fn(msgs.data(), msgs.size(), out.data());
+			sink = out[0][0];
+		});
+	}
+}
+
+
+
+static void bench_sha1() {
+	for(backend b : {backend::scalar, backend::sha_ni}) {
+		if(!sha1::set_backend(b))
+			continue;
+		single("sha1::hash", b, [](const uint8_t* p, size_t n) { return sha1::hash(p, n); });
+		incremental<sha1::hasher>("sha1::hasher", b);
+		hmac<sha1::hasher> mac("key", 3);
+		single("hmac<sha1>", b, [&](const uint8_t* p, size_t n) { return mac.hash(p, n); });
+	}
+	sha1::set_backend(backend::automatic);
+}
+
+static void bench_sha2() {
+
+	for(backend b : {backend::scalar, backend::sha_ni}) {
+		if(!sha2::set_backend_256(b))
+			continue;
+		single("sha2::hash_224", b, [](const uint8_t* p, size_t n) { return sha2::hash_224(p, n); });
+		single("sha2::hash_256", b, [](const uint8_t* p, size_t n) { return sha2::hash_256(p, n); });
+		incremental<sha2::hasher_224>("sha2::hasher_224", b);
+		incremental<sha2::hasher_256>("sha2::hasher_256", b);
+		hmac<sha2::hasher_256> mac("key", 3);
+		single("hmac<sha2_256>", b, [&](const uint8_t* p, size_t n) { return mac.hash(p, n); });
+	}
+	sha2::set_backend_256(backend::automatic);
+
+	for(backend b : {backend::scalar, backend::sha_ni, backend::avx2, backend::avx512}) {
+		if(!sha2::set_backend_512(b))
+			continue;
+		single("sha2::hash_384", b, [](const uint8_t* p, size_t n) { return sha2::hash_384(p, n); });
+		single("sha2::hash_512", b, [](const uint8_t* p, size_t n) { return sha2::hash_512(p, n); });
+		single("sha2::hash_512_224", b, [](const uint8_t* p, size_t n) { return sha2::hash_512_224(p, n); });
+		single("sha2::hash_512_256", b, [](const uint8_t* p, size_t n) { return sha2::hash_512_256(p, n); });
+		incremental<sha2::hasher_384>("sha2::hasher_384", b);
+		incremental<sha2::hasher_512>("sha2::hasher_512", b);
+		incremental<sha2::hasher_512_224>("sha2::hasher_512_224", b);
+		incremental<sha2::hasher_512_256>("sha2::hasher_512_256", b);
+		hmac<sha2::hasher_512> mac("key", 3);
+		single("hmac<sha2_512>", b, [&](const uint8_t* p, size_t n) { return mac.hash(p, n); });
+	}
+	sha2::set_backend_512(backend::automatic);
+
+	for(backend b : {backend::scalar, backend::avx2, backend::avx512}) {
+		// without lanes (backend::scalar) the batch runs on the single buffer backend, report that one
+		if(sha2::set_batch_backend_256(b)) {
+			many<224>("sha2::hash_224_many", sha2::active_batch_backend_256(), sha2::hash_224_many);
+			many<256>("sha2::hash_256_many", sha2::active_batch_backend_256(), sha2::hash_256_many);
+		}
+		if(sha2::set_batch_backend_512(b)) {
+			many<384>("sha2::hash_384_many", sha2::active_batch_backend_512(), sha2::hash_384_many);
+			many<512>("sha2::hash_512_many", sha2::active_batch_backend_512(), sha2::hash_512_many);
+			many<224>("sha2::hash_512_224_many", sha2::active_batch_backend_512(), sha2::hash_512_224_many);
+			many<256>("sha2::hash_512_256_many", sha2::active_batch_backend_512(), sha2::hash_512_256_many);
+		}
+	}
+	sha2::set_batch_backend_256(backend::automatic);
+	sha2::set_batch_backend_512(backend::automatic);
+
+	// iterations per call rather than bytes: size is the iteration count, 64 output bytes
+	for(size_t it : {1000, 100000}) {
+		uint8_t out[64];
+		measure("pbkdf2<sha2_256>", "iterations", sha2::active_batch_backend_256(), it, 1, [&] { pbkdf2<sha2::hasher_256>("password", 8, "salt", 4, it, out, sizeof(out)); });
+		measure("pbkdf2<sha2_512>", "iterations", sha2::active_batch_backend_512(), it, 1, [&] { pbkdf2<sha2::hasher_512>("password", 8, "salt", 4, it, out, sizeof(out)); });
+	}
+}
+
+static void bench_sha3() {
+
+	single("sha3::hash_224", backend::scalar, [](const uint8_t* p, size_t n) { return sha3::hash_224(p, n); });
+	single("sha3::hash_256", backend::scalar, [](const uint8_t* p, size_t n) { return sha3::hash_256(p, n); });
+	single("sha3::hash_384", backend::scalar, [](const uint8_t* p, size_t n) { return sha3::hash_384(p, n); });
+	single("sha3::hash_512", backend::scalar, [](const uint8_t* p, size_t n) { return sha3::hash_512(p, n); });
+	single("sha3::hash_shake_128<256>", backend::scalar, [](const uint8_t* p, size_t n) { return sha3::hash_shake_128<256>(p, n); });
+	single("sha3::hash_shake_256<512>", backend::scalar, [](const uint8_t* p, size_t n) { return sha3::hash_shake_256<512>(p, n); });
+	incremental<sha3::hasher_256>("sha3::hasher_256", backend::scalar);
+	incremental<sha3::hasher_shake_128<256>>("sha3::hasher_shake_128<256>", backend::scalar);
+	hmac<sha3::hasher_256> mac("key", 3);
+	single("hmac<sha3_256>", backend::scalar, [&](const uint8_t* p, size_t n) { return mac.hash(p, n); });
+
+	for(backend b : {backend::scalar, backend::avx2, backend::avx512}) {
+		if(!sha3::set_batch_backend(b))
+			continue;
+		many<224>("sha3::hash_224_many", b, sha3::hash_224_many);
+		many<256>("sha3::hash_256_many", b, sha3::hash_256_many);
+		many<384>("sha3::hash_384_many", b, sha3::hash_384_many);
+		many<512>("sha3::hash_512_many", b, sha3::hash_512_many);
+		many<256>("sha3::hash_shake_128_many<256>", b, sha3::hash_shake_128_many<256>);
+		many<512>("sha3::hash_shake_256_many<512>", b, sha3::hash_shake_256_many<512>);
+		// tree modes hash their leaves through the batch backend (and every core)
+		single("sha3::hash_parallel_128<256>", b, [](const uint8_t* p, size_t n) { return sha3::hash_parallel_128<256>(p, n); });
+		single("sha3::hash_parallel_256<512>", b, [](const uint8_t* p, size_t n) { return sha3::hash_parallel_256<512>(p, n); });
+		single("sha3::hash_kt128<256>", b, [](const uint8_t* p, size_t n) { return sha3::hash_kt128<256>(p, n); });
+		single("sha3::hash_kt256<512>", b, [](const uint8_t* p, size_t n) { return sha3::hash_kt256<512>(p, n); });
+	}
+	sha3::set_batch_backend(backend::automatic);
+}
+
+
+
+static std::string json_escape(const std::string& s) {
+	std::string r;
+	for(char c : s) {
+		if(c == '"' || c == '\\')
+			r += '\\';
+		r += c;
+	}
+	return r;
+}
+
+static void write_json(FILE* f) {
+
+	std::fprintf(f, "{\n  \"meta\": {\n");
+	#if defined(__clang__)
+	std::fprintf(f, "    \"compiler\": \"clang %s\",\n", json_escape(__clang_version__).c_str());
+	#elif defined(__GNUC__)
+	std::fprintf(f, "    \"compiler\": \"gcc %s\",\n", json_escape(__VERSION__).c_str());
+	#elif defined(_MSC_VER)
+	std::fprintf(f, "    \"compiler\": \"msvc %d\",\n", _MSC_VER);
+	#endif
+	std::fprintf(f, "    \"threads\": %u,\n", std::thread::hardware_concurrency());
+	// the automatic picks on this cpu (every backend is back to automatic once the runs are done)
+	std::fprintf(f, "    \"backends\": {");
+	for(int a = 0; a <= static_cast<int>(hash_stats::algorithm::kt256); a++) {
+		hash_stats::algorithm alg = static_cast<hash_stats::algorithm>(a);
+		std::fprintf(f, "%s\"%s\": {\"single\": \"%s\", \"batch\": \"%s\"}", a ? ", " : "", hash_stats::name(alg),
+			hash_stats::name(hash_stats::active_backend(alg)), hash_stats::name(hash_stats::active_batch_backend(alg)));
+	}
+	std::fprintf(f, "},\n");
+	std::fprintf(f, "    \"cycles\": \"rdtsc reference cycles\",\n");
+	std::fprintf(f, "    \"min_time_s\": %g\n  },\n  \"results\": [\n", opt.min_time);
+
+	for(size_t i = 0; i < results.size(); i++) {
+		const result& r = results[i];
+		std::fprintf(f, "    {\"name\": \"%s\", \"mode\": \"%s\", \"backend\": \"%s\", \"size\": %zu, \"batch\": %zu, \"calls\": %zu, "
+			"\"ns_per_call\": %.3f, \"mb_per_s\": %.3f, \"cycles_per_byte\": %.4f}%s\n",
+			json_escape(r.name).c_str(), r.mode.c_str(), r.backend.c_str(), r.size, r.batch, r.calls, r.ns_per_call, r.mb_per_s, r.cycles_per_byte,
+			i + 1 < results.size() ? "," : "");
+	}
+
+	std::fprintf(f, "  ]\n}\n");
+}
+
+
+
+int main(int argc, char* argv[]) {
+
+	for(int i = 1; i < argc; i++) {
+		std::string a = argv[i];
+		std::string v = i + 1 < argc ? argv[i + 1] : "";
+		if(a == "--min-size")
+			opt.min_size = parse_size(v), i++;
+		else if(a == "--max-size")
+			opt.max_size = parse_size(v), i++;
+		else if(a == "--min-time")
+			opt.min_time = std::atof(v.c_str()), i++;
+		else if(a == "--filter")
+			opt.filter = v, i++;
+		else if(a == "--json")
+			opt.json = v, i++;
+		else {
+			std::fprintf(stderr, "usage: %s [--min-size N] [--max-size N] [--min-time SECONDS] [--filter TEXT] [--json FILE]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	size_t batch_bytes = batch_count * std::min(opt.max_size, batch_max);
+	data.resize(std::max(opt.max_size, batch_bytes));
+	for(size_t i = 0; i < data.size(); i++)
+		data[i] = static_cast<uint8_t>(i * 131 + 7);
+
+	bench_sha1();
+	bench_sha2();
+	bench_sha3();
+
+	FILE* f = opt.json.empty() ? stdout : std::fopen(opt.json.c_str(), "w");
+	if(!f) {
+		std::fprintf(stderr, "cannot open %s\n", opt.json.c_str());
+		return 1;
+	}
+	write_json(f);
+	if(f != stdout)
+		std::fclose(f);
+
+	return 0;
+}
@@ -10,18 +10,69 @@
 *
 *	Notes:
 *		- Compile with std=c++11 or greater
+*		- Link with pthread (parallelhash and kangarootwelve run on a thread pool)
 */
 
 
 #include <array>
+#include <cstdint>
+#include <cstring>
 #include <string>
-#include <sstream>
-#include <iomanip>
+#include <type_traits>
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+#include <initializer_list>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 #ifdef _MSC_VER
 #include <stdlib.h>
+#include <intrin.h>
+#include <immintrin.h>
 #else
 #include <x86intrin.h>
+#include <cpuid.h>
+#endif
+
+// kernels using instruction sets beyond the compile flags are enabled per function and picked at runtime through cpuid
+#if defined(__GNUC__) || defined(__clang__)
+#define __NEO_SHA_TARGET(isa) __attribute__((target(isa)))
+#define __NEO_SHA_INLINE __attribute__((always_inline)) inline
+// multi-lane kernels share one body written on gcc vector types, instantiated under each target
+#define __NEO_SHA_VECTORS
+#else
+#define __NEO_SHA_TARGET(isa)
+#define __NEO_SHA_INLINE __forceinline
+#endif
+
+// constexpr overloads need c++14 constexpr and a way to tell constant evaluation apart, so the runtime keeps the fast kernels
+#if defined(__cpp_constexpr) && __cpp_constexpr >= 201304
+#if defined(__cpp_lib_is_constant_evaluated)
+#define __NEO_SHA_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define __NEO_SHA_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#elif (defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define __NEO_SHA_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#ifdef __NEO_SHA_CONSTANT_EVALUATED
+#define __NEO_SHA_CONSTEXPR
+#endif
+#endif
+
+// opt-in kernel counters (NEO_SHA_STATS, plus rdtsc timings with NEO_SHA_STATS_TSC) read through hash_stats, compiled out otherwise
+#if defined(NEO_SHA_STATS_TSC) && !defined(NEO_SHA_STATS)
+#define NEO_SHA_STATS
+#endif
+#ifdef NEO_SHA_STATS
+#define __NEO_SHA_COUNT(alg, blocks) ::neo::hash::__sha_details::__shared::_stats_scope __neo_sha_stats(alg, blocks)
+#else
+#define __NEO_SHA_COUNT(alg, blocks)
 #endif
 
 
@@ -30,6 +81,15 @@ namespace neo {
 
 	namespace hash {
 
+		namespace __sha_details {
+			namespace __shared {
+				template<size_t... Is>
+				struct index;
+				inline void _to_hex(char* out, const uint8_t* in, size_t n);
+				inline bool _from_hex(uint8_t* out, const char* in, size_t n);
+			}
+		}
+
 		template<size_t Bits> 
 		struct sha_t : std::array<uint8_t, Bits / 8 + (Bits % 8 != 0)> {
 
@@ -39,6 +99,9 @@ namespace neo {
 				static constexpr size_t bytes = Bits / 8 + (Bits % 8 != 0);
 
 				sha_t() {}
+				// from any buffer indexable in constant expressions, b[Is] for every byte
+				template<class B, size_t... Is>
+				constexpr sha_t(const B& b, __sha_details::__shared::index<Is...>) : std::array<uint8_t, bytes>{{b[Is]...}} {}
 				template<class T, size_t N>
 				sha_t(const std::array<T, N>& other) : std::array<uint8_t, bytes>(reinterpret_cast<const std::array<uint8_t, bytes>&>(other)) {}
 				template<class T>
@@ -51,24 +114,94 @@ namespace neo {
 						(*this)[i] = 0;
 				}
 				sha_t(const std::string& hex) {
-					size_t i = 0;
-					for(; i < hex.size() / 2; i++)
-						(*this)[i] = static_cast<uint8_t>(std::stoul(hex.substr(i * 2, 2), nullptr, 16));
-					if(hex.size() & 1)
-						(*this)[i++] = static_cast<uint8_t>(std::stoul(hex.substr(hex.size() - 1, 1), nullptr, 16)) << 4;
-					for(; i < bytes; i++)
-						(*this)[i] = 0;
+					if(!from_chars(hex.data(), hex.size()))
+						throw std::invalid_argument("sha_t: invalid hex string");
 				}
 
 				std::string to_str() const {
-					std::stringstream ss;
-					for(size_t i = 0; i < bytes; i++)
-						ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<uint32_t>((*this)[i]);
-					return ss.str();
+					std::string str(bytes * 2, '0');
+					to_chars(&str[0]);
+					return str;
+				}
+
+				// writes bytes * 2 lowercase hex chars (no terminator), returns the end of the written range
+				char* to_chars(char* out) const {
+					__sha_details::__shared::_to_hex(out, this->data(), bytes);
+					return out + bytes * 2;
+				}
+				// parses up to bytes * 2 hex chars of any case, missing trailing nibbles read as zero; false (and unchanged) on bad input
+				bool from_chars(const char* in, size_t len) {
+					std::array<uint8_t, bytes> tmp = {};
+					if(len > bytes * 2 || !__sha_details::__shared::_from_hex(tmp.data(), in, len / 2))
+						return false;
+					if(len & 1) {
+						uint8_t last;
+						char pair[2] = {in[len - 1], '0'};
+						if(!__sha_details::__shared::_from_hex(&last, pair, 1))
+							return false;
+						tmp[len / 2] = last;
+					}
+					static_cast<std::array<uint8_t, bytes>&>(*this) = tmp;
+					return true;
+				}
+				// count digests back to back into out (count * bytes * 2 chars), returns the end of the written range
+				static char* to_chars_many(const sha_t* digests, size_t count, char* out) {
+					if(!count)
+						return out;
+					if(sizeof(sha_t) == bytes)
+						__sha_details::__shared::_to_hex(out, digests->data(), count * bytes);
+					else
+						for(size_t i = 0; i < count; i++)
+							digests[i].to_chars(&out[i * bytes * 2]);
+					return out + count * bytes * 2;
 				}
 
 		};
 
+		enum class backend {
+			automatic,	// best one supported by the running cpu
+			scalar,
+			sha_ni,		// intel sha extensions (sha1 and sha224/256)
+			avx2,
+			avx512
+		};
+
+		// one message of a batch
+		struct buffer {
+			const void* data;
+			size_t size;
+		};
+
+		// a nonce of a sha2::scan_256d() and the digest that put it below the target
+		struct nonce_match {
+			uint32_t nonce;
+			sha_t<256> digest;
+		};
+
+		// what hash_stats keeps apart (also hash_stats::algorithm): a compress function or keccak permutation and the digests sharing it
+		enum class stats_algorithm {
+			sha1,
+			sha2_256,	// sha224, sha256
+			sha2_512,	// sha384, sha512, sha512/224, sha512/256
+			sha3_224,
+			sha3_256,
+			sha3_384,
+			sha3_512,
+			shake_128,	// also cshake128, kmac128, parallelhash128
+			shake_256,	// also cshake256, kmac256, parallelhash256
+			kt128,		// 12 round keccak of kangarootwelve
+			kt256
+		};
+
+		// kernel work of an algorithm since the start of the program, see hash_stats
+		struct hash_counters {
+			uint64_t calls;			// kernel calls, a multi-lane call counts once
+			uint64_t blocks;		// blocks compressed or permuted, every lane of a multi-lane call counts
+			uint64_t bytes;			// blocks times the block size
+			uint64_t cycles;		// rdtsc ticks spent in those calls (NEO_SHA_STATS_TSC)
+			uint64_t histogram[32];	// calls by rdtsc ticks, [i] counts [2^i, 2^(i + 1)) and [31] anything longer (NEO_SHA_STATS_TSC)
+		};
+
 		namespace __sha_details {
 
 			namespace __shared {
@@ -107,7 +240,7 @@ namespace neo {
 				}
 				inline uint64_t _rotrr(uint64_t x, int sh) {
 					#if !defined(_MSC_VER ) && !defined(_rotr64)
-					return (x >> sh) | (x << (64 - sh));
+					return (x >> sh) | (x << ((64 - sh) & 63));
 					#else
 					return _rotr64(x, sh);
 					#endif
@@ -117,479 +250,4320 @@ namespace neo {
 				}
 				inline uint64_t _rotrl(uint64_t x, int sh) {
 					#if !defined(_MSC_VER ) && !defined(_rotl64)
-					return (x << sh) | (x >> (64 - sh));
+					return (x << sh) | (x >> ((64 - sh) & 63));
 					#else
 					return _rotl64(x, sh);
 					#endif
 				}
 
-				template<size_t Bits, size_t N, size_t... Is>
-				inline sha_t<Bits> return_hash(const std::array<uint8_t, N>& hash, index<Is...>) {
-					return {hash[Is]...};
+				// full 64 x 64 bit product, returns the low half and stores the high half in hi
+				inline uint64_t _mul128(uint64_t a, uint64_t b, uint64_t& hi) {
+					#if defined(_MSC_VER) && defined(_M_X64)
+					return _umul128(a, b, &hi);
+					#elif defined(__SIZEOF_INT128__)
+					__extension__ typedef unsigned __int128 u128;
+					u128 p = static_cast<u128>(a) * b;
+					hi = static_cast<uint64_t>(p >> 64);
+					return static_cast<uint64_t>(p);
+					#else
+					uint64_t lo_lo = (a & 0xffffffff) * (b & 0xffffffff), hi_lo = (a >> 32) * (b & 0xffffffff);
+					uint64_t lo_hi = (a & 0xffffffff) * (b >> 32), hi_hi = (a >> 32) * (b >> 32);
+					uint64_t mid = (lo_lo >> 32) + (hi_lo & 0xffffffff) + lo_hi;
+					hi = hi_hi + (hi_lo >> 32) + (mid >> 32);
+					return (mid << 32) | (lo_lo & 0xffffffff);
+					#endif
 				}
-				template<size_t Bits, size_t N, size_t... Is>
-				inline sha_t<Bits> return_hash(const std::array<uint32_t, N>& hash, index<Is...>) {
-					return {hash[Is]...};
+
+				template<class T>
+				inline T _load_be(const uint8_t* p) {
+					T x;
+					std::memcpy(&x, p, sizeof(T));
+					return _bswap(x);
 				}
-				template<size_t Bits, size_t N, size_t... Is>
-				inline sha_t<Bits> return_hash(const std::array<uint64_t, N>& hash, index<Is...>) {
-					return {reinterpret_cast<const std::array<uint32_t, 16>&>(hash)[Is + !(Is & 1) - (Is & 1)]...};
+				template<class T>
+				inline void _store_be(uint8_t* p, T x) {
+					x = _bswap(x);
+					std::memcpy(p, &x, sizeof(T));
 				}
 
-			}
-
-			namespace __sha1 {
+				struct cpu_info {
+					bool ssse3, sse41, sha, avx2, avx512f, avx512vl, bmi2;
+				};
 
-				using namespace neo::hash::__sha_details::__shared;
+				inline void _cpuid(uint32_t leaf, uint32_t sub, uint32_t (&r)[4]) {
+					#ifdef _MSC_VER
+					__cpuidex(reinterpret_cast<int*>(r), static_cast<int>(leaf), static_cast<int>(sub));
+					#else
+					__cpuid_count(leaf, sub, r[0], r[1], r[2], r[3]);
+					#endif
+				}
+				inline uint64_t _xgetbv0() {
+					#ifdef _MSC_VER
+					return _xgetbv(0);
+					#else
+					uint32_t lo, hi;
+					__asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+					return (static_cast<uint64_t>(hi) << 32) | lo;
+					#endif
+				}
+				inline cpu_info _detect_cpu() {
 
-				struct _sha1_base {
+					cpu_info info = {};
+					uint32_t r[4];
 
-					static sha_t<160> hash(const uint8_t* msg, size_t len) {
+					_cpuid(0, 0, r);
+					uint32_t max_leaf = r[0];
+					if(max_leaf < 1)
+						return info;
 
-						std::array<uint32_t, 5> hash = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+					_cpuid(1, 0, r);
+					info.ssse3 = (r[2] >> 9) & 1;
+					info.sse41 = (r[2] >> 19) & 1;
 
-						size_t off;
-						for(off = 0; len - off >= 64; off += 64)
-							compress(hash, &msg[off]);
+					// avx state must be enabled by the os (osxsave + xcr0), not only reported by the cpu
+					bool os_avx    = ((r[2] >> 27) & 1) && ((r[2] >> 28) & 1) && (_xgetbv0() & 0x06) == 0x06;
+					bool os_avx512 = os_avx && (_xgetbv0() & 0xE6) == 0xE6;
 
-						// last block stuff (padding)
+					if(max_leaf < 7)
+						return info;
 
-						std::array<uint8_t, 64> block = {0};
-						size_t lst = len - off;
+					_cpuid(7, 0, r);
+					info.sha      = (r[1] >> 29) & 1;
+					info.avx2     = os_avx && ((r[1] >> 5) & 1);
+					info.bmi2     = (r[1] >> 8) & 1;
+					info.avx512f  = os_avx512 && ((r[1] >> 16) & 1);
+					info.avx512vl = os_avx512 && ((r[1] >> 31) & 1);
 
-						std::copy(&msg[off], &msg[off] + lst, block.begin());
-						block[lst] = 0x80;
+					return info;
+				}
+				inline const cpu_info& cpu() {
+					static const cpu_info info = _detect_cpu();
+					return info;
+				}
 
-						if(lst >= 56) {
-							compress(hash, block.data());
-							block.fill(0);
+				// hex text behind sha_t::to_chars() / from_chars(), n bytes <-> 2 * n chars (lowercase out, either case in)
+				inline void _to_hex_scalar(char* out, const uint8_t* in, size_t n) {
+					static const char digits[] = "0123456789abcdef";
+					for(size_t i = 0; i < n; i++) {
+						out[i * 2]     = digits[in[i] >> 4];
+						out[i * 2 + 1] = digits[in[i] & 0x0F];
+					}
+				}
+				inline bool _from_hex_scalar(uint8_t* out, const char* in, size_t n) {
+					for(size_t i = 0; i < n; i++) {
+						int v[2];
+						for(int j = 0; j < 2; j++) {
+							char c = in[i * 2 + j];
+							v[j] = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+							if(v[j] < 0)
+								return false;
 						}
+						out[i] = static_cast<uint8_t>((v[0] << 4) | v[1]);
+					}
+					return true;
+				}
 
-						reinterpret_cast<size_t&>(block[64 - sizeof(size_t)]) = _bswap(len << 3); // 3º
-						compress(hash, block.data());
-
-						return return_hash<160>(hash, gen_seq<5>());
+				// nibbles looked up through pshufb and interleaved high / low, 16 bytes -> 32 chars
+				__NEO_SHA_TARGET("ssse3")
+				inline void _to_hex_ssse3(char* out, const uint8_t* in, size_t n) {
+					const __m128i digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+					const __m128i low    = _mm_set1_epi8(0x0F);
+					size_t i = 0;
+					for(; i + 16 <= n; i += 16) {
+						__m128i x  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[i]));
+						__m128i hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(x, 4), low));
+						__m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(x, low));
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i * 2]), _mm_unpacklo_epi8(hi, lo));
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i * 2 + 16]), _mm_unpackhi_epi8(hi, lo));
+					}
+					_to_hex_scalar(&out[i * 2], &in[i], n - i);
+				}
+				__NEO_SHA_TARGET("avx2")
+				inline void _to_hex_avx2(char* out, const uint8_t* in, size_t n) {
+					const __m256i digits = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+															'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+					const __m256i low    = _mm256_set1_epi8(0x0F);
+					size_t i = 0;
+					for(; i + 32 <= n; i += 32) {
+						__m256i x  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&in[i]));
+						__m256i hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(x, 4), low));
+						__m256i lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(x, low));
+						// unpack works per 128 bit half, put the halves back in order
+						__m256i a  = _mm256_unpacklo_epi8(hi, lo);
+						__m256i b  = _mm256_unpackhi_epi8(hi, lo);
+						_mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[i * 2]), _mm256_permute2x128_si256(a, b, 0x20));
+						_mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[i * 2 + 32]), _mm256_permute2x128_si256(a, b, 0x31));
 					}
+					_to_hex_ssse3(&out[i * 2], &in[i], n - i);
+				}
 
-					static void compress(std::array<uint32_t, 5>& state, const uint8_t block[64]) {
+				// digits and (case folded) letters checked by unsigned range, then high * 16 + low per char pair through pmaddubsw,
+				// 32 chars -> 16 bytes
+				__NEO_SHA_TARGET("ssse3")
+				inline bool _from_hex_ssse3(uint8_t* out, const char* in, size_t n) {
+					size_t i = 0;
+					for(; i + 8 <= n; i += 8) {
+						__m128i c   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[i * 2]));
+						__m128i d   = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+						__m128i l   = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+						__m128i isd = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+						__m128i isl = _mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8(5)), l);
+						if(_mm_movemask_epi8(_mm_or_si128(isd, isl)) != 0xFFFF)
+							return false;
+						__m128i v = _mm_or_si128(_mm_and_si128(isd, d), _mm_and_si128(isl, _mm_add_epi8(l, _mm_set1_epi8(10))));
+						v = _mm_maddubs_epi16(v, _mm_set1_epi16(0x0110));
+						_mm_storel_epi64(reinterpret_cast<__m128i*>(&out[i]), _mm_packus_epi16(v, v));
+					}
+					return _from_hex_scalar(&out[i], &in[i * 2], n - i);
+				}
+				__NEO_SHA_TARGET("avx2")
+				inline bool _from_hex_avx2(uint8_t* out, const char* in, size_t n) {
+					size_t i = 0;
+					for(; i + 16 <= n; i += 16) {
+						__m256i c   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&in[i * 2]));
+						__m256i d   = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+						__m256i l   = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+						__m256i isd = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+						__m256i isl = _mm256_cmpeq_epi8(_mm256_min_epu8(l, _mm256_set1_epi8(5)), l);
+						if(_mm256_movemask_epi8(_mm256_or_si256(isd, isl)) != -1)
+							return false;
+						__m256i v = _mm256_or_si256(_mm256_and_si256(isd, d), _mm256_and_si256(isl, _mm256_add_epi8(l, _mm256_set1_epi8(10))));
+						v = _mm256_maddubs_epi16(v, _mm256_set1_epi16(0x0110));
+						// packus works per 128 bit half, the 8 bytes of each half go to out[i] and out[i + 8]
+						v = _mm256_packus_epi16(v, v);
+						_mm_storel_epi64(reinterpret_cast<__m128i*>(&out[i]), _mm256_castsi256_si128(v));
+						_mm_storel_epi64(reinterpret_cast<__m128i*>(&out[i + 8]), _mm256_extracti128_si256(v, 1));
+					}
+					return _from_hex_ssse3(&out[i], &in[i * 2], n - i);
+				}
 
-						// schedule => w
-						std::array<uint32_t, 80> schedule;
+				inline void _to_hex(char* out, const uint8_t* in, size_t n) {
+					typedef void (*fn_t)(char*, const uint8_t*, size_t);
+					static const fn_t fn = cpu().avx2 ? _to_hex_avx2 : cpu().ssse3 ? _to_hex_ssse3 : _to_hex_scalar;
+					fn(out, in, n);
+				}
+				inline bool _from_hex(uint8_t* out, const char* in, size_t n) {
+					typedef bool (*fn_t)(uint8_t*, const char*, size_t);
+					static const fn_t fn = cpu().avx2 ? _from_hex_avx2 : cpu().ssse3 ? _from_hex_ssse3 : _from_hex_scalar;
+					return fn(out, in, n);
+				}
 
-						//  break chunk into sixteen 32-bit big-endian words w[i], 0 ≤ i ≤ 15
-						for(size_t i = 0; i < 16; i++)
-							schedule[i] = _bswap(reinterpret_cast<const uint32_t&>(block[i * sizeof(uint32_t)]));
+				#ifdef NEO_SHA_STATS
+				// counters of every algorithm per thread, only written by their own thread (relaxed load + store, no locked ops) and
+				// summed over the live threads plus those already gone by hash_stats::total()
+				class _stats {
 
-						// Extend the sixteen 32-bit words into eighty 32-bit words:
-						for(size_t i = 16; i < 80; i++)
-							schedule[i] = _rotrl(schedule[i - 3] ^ schedule[i - 8] ^ schedule[i - 14] ^ schedule[i - 16], 1);
+					public:
 
-						std::array<uint32_t, 5> hbuff = state;
+						enum { calls, blocks, cycles, histogram, fields = histogram + 32, algorithms = static_cast<int>(stats_algorithm::kt256) + 1 };
 
-						// main loop
-						for(size_t i = 0; i < 4; i++) {
-							roundfn_0_20<0, 1, 2, 3, 4>(hbuff, schedule[i * 5 + 0]);
-							roundfn_0_20<4, 0, 1, 2, 3>(hbuff, schedule[i * 5 + 1]);
-							roundfn_0_20<3, 4, 0, 1, 2>(hbuff, schedule[i * 5 + 2]);
-							roundfn_0_20<2, 3, 4, 0, 1>(hbuff, schedule[i * 5 + 3]);
-							roundfn_0_20<1, 2, 3, 4, 0>(hbuff, schedule[i * 5 + 4]);
+						static void add(stats_algorithm a, int field, uint64_t n) {
+							std::atomic<uint64_t>& c = local().v[static_cast<int>(a)][field];
+							c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
 						}
-						for(size_t i = 4; i < 8; i++) {
-							roundfn_20_40<0, 1, 2, 3, 4>(hbuff, schedule[i * 5 + 0]);
-							roundfn_20_40<4, 0, 1, 2, 3>(hbuff, schedule[i * 5 + 1]);
-							roundfn_20_40<3, 4, 0, 1, 2>(hbuff, schedule[i * 5 + 2]);
-							roundfn_20_40<2, 3, 4, 0, 1>(hbuff, schedule[i * 5 + 3]);
-							roundfn_20_40<1, 2, 3, 4, 0>(hbuff, schedule[i * 5 + 4]);
+
+						static void read(stats_algorithm a, bool all, uint64_t (&out)[fields]) {
+							std::fill(out, out + fields, 0);
+							if(!all) {
+								local().sum(a, out);
+								return;
+							}
+							registry& r = reg();
+							std::lock_guard<std::mutex> lock(r.mtx);
+							for(size_t i = 0; i < fields; i++)
+								out[i] = r.retired[static_cast<int>(a)][i];
+							for(counters* c : r.live)
+								c->sum(a, out);
 						}
-						for(size_t i = 8; i < 12; i++) {
-							roundfn_40_60<0, 1, 2, 3, 4>(hbuff, schedule[i * 5 + 0]);
-							roundfn_40_60<4, 0, 1, 2, 3>(hbuff, schedule[i * 5 + 1]);
-							roundfn_40_60<3, 4, 0, 1, 2>(hbuff, schedule[i * 5 + 2]);
-							roundfn_40_60<2, 3, 4, 0, 1>(hbuff, schedule[i * 5 + 3]);
-							roundfn_40_60<1, 2, 3, 4, 0>(hbuff, schedule[i * 5 + 4]);
+
+					private:
+
+						struct counters {
+							std::atomic<uint64_t> v[algorithms][fields];
+							counters() {
+								for(size_t a = 0; a < algorithms; a++)
+									for(size_t i = 0; i < fields; i++)
+										v[a][i].store(0, std::memory_order_relaxed);
+								std::lock_guard<std::mutex> lock(reg().mtx);
+								reg().live.push_back(this);
+							}
+							~counters() {
+								registry& r = reg();
+								std::lock_guard<std::mutex> lock(r.mtx);
+								for(size_t a = 0; a < algorithms; a++)
+									for(size_t i = 0; i < fields; i++)
+										r.retired[a][i] += v[a][i].load(std::memory_order_relaxed);
+								r.live.erase(std::find(r.live.begin(), r.live.end(), this));
+							}
+							void sum(stats_algorithm a, uint64_t (&out)[fields]) const {
+								for(size_t i = 0; i < fields; i++)
+									out[i] += v[static_cast<int>(a)][i].load(std::memory_order_relaxed);
+							}
+						};
+						struct registry {
+							std::mutex mtx;
+							std::vector<counters*> live;
+							uint64_t retired[algorithms][fields] = {};
+						};
+
+						// never destroyed, pool threads still exit (and fold their counters in) while statics are torn down
+						static registry& reg() {
+							static registry* r = new registry();
+							return *r;
 						}
-						for(size_t i = 12; i < 16; i++) {
-							roundfn_60_80<0, 1, 2, 3, 4>(hbuff, schedule[i * 5 + 0]);
-							roundfn_60_80<4, 0, 1, 2, 3>(hbuff, schedule[i * 5 + 1]);
-							roundfn_60_80<3, 4, 0, 1, 2>(hbuff, schedule[i * 5 + 2]);
-							roundfn_60_80<2, 3, 4, 0, 1>(hbuff, schedule[i * 5 + 3]);
-							roundfn_60_80<1, 2, 3, 4, 0>(hbuff, schedule[i * 5 + 4]);
+						static counters& local() {
+							static thread_local counters c;
+							return c;
 						}
+				};
 
-						for(size_t i = 0; i < 5; i++)
-							state[i] += hbuff[i];
+				// counts one kernel call of blocks blocks when it goes out of scope, timed from its construction with NEO_SHA_STATS_TSC
+				class _stats_scope {
 
-					}
+					public:
 
-					template<size_t a, size_t b, size_t c, size_t d, size_t e>
-					inline static void roundfn_0_20(std::array<uint32_t, 5>& st, uint32_t w) {
-						roundfn_shared<a, b, c, d, e>(st, (st[b] & st[c]) | (~st[b] & st[d]), 0x5A827999, w);
-					}
-					template<size_t a, size_t b, size_t c, size_t d, size_t e>
-					inline static void roundfn_20_40(std::array<uint32_t, 5>& st, uint32_t w) {
-						roundfn_shared<a, b, c, d, e>(st, st[b] ^ st[c] ^ st[d], 0x6ED9EBA1, w);
-					}
-					template<size_t a, size_t b, size_t c, size_t d, size_t e>
-					inline static void roundfn_40_60(std::array<uint32_t, 5>& st, uint32_t w) {
-						roundfn_shared<a, b, c, d, e>(st, (st[b] & st[c]) | (st[b] & st[d]) | (st[c] & st[d]), 0x8F1BBCDC, w);
-					}
-					template<size_t a, size_t b, size_t c, size_t d, size_t e>
-					inline static void roundfn_60_80(std::array<uint32_t, 5>& st, uint32_t w) {
-						roundfn_shared<a, b, c, d, e>(st, st[b] ^ st[c] ^ st[d], 0xCA62C1D6, w);
-					}
-					template<size_t a, size_t b, size_t c, size_t d, size_t e>
-					inline static void roundfn_shared(std::array<uint32_t, 5>& st, uint32_t f, uint32_t k, uint32_t w) {
-						st[e] = _rotrl(st[a], 5) + f + st[e] + k + w;
-						st[b] = _rotrl(st[b], 30);
-					}
+						_stats_scope(stats_algorithm a, uint64_t blocks) : alg(a), blocks(blocks) {
+							#ifdef NEO_SHA_STATS_TSC
+							start = __rdtsc();
+							#endif
+						}
+						~_stats_scope() {
+							_stats::add(alg, _stats::calls, 1);
+							_stats::add(alg, _stats::blocks, blocks);
+							#ifdef NEO_SHA_STATS_TSC
+							uint64_t ticks = __rdtsc() - start;
+							int bucket = 0;
+							while(bucket < 31 && (ticks >> (bucket + 1)))
+								bucket++;
+							_stats::add(alg, _stats::cycles, ticks);
+							_stats::add(alg, _stats::histogram + bucket, 1);
+							#endif
+						}
 
+					private:
+
+						stats_algorithm alg;
+						uint64_t blocks;
+						#ifdef NEO_SHA_STATS_TSC
+						uint64_t start;
+						#endif
 				};
+				#endif
 
-			}
-			namespace __sha2 {
+				// a compress kernel with the backend it belongs to, picked once on first use and overridable through set_backend()
+				template<class Fn>
+				struct _kernel {
+					Fn fn;
+					backend id;
+				};
 
-				using namespace neo::hash::__sha_details::__shared;
+				// the active kernel of a family: every backend's entry is built once up front and switching swaps one pointer, so threads
+				// hashing during a set_backend() always read a kernel and an id that belong together
+				template<class Fn>
+				class _kernel_slot {
+
+					public:
+
+						template<class Select>
+						explicit _kernel_slot(Select select) {
+							for(size_t i = 0; i < 5; i++)
+								table[i] = select(static_cast<backend>(i));
+							set(select(backend::automatic).id);
+						}
+
+						_kernel<Fn> get() const {
+							return *active.load(std::memory_order_acquire);
+						}
+						void set(backend id) {
+							active.store(&table[static_cast<size_t>(id)], std::memory_order_release);
+						}
+
+					private:
+
+						_kernel<Fn> table[5];
+						std::atomic<const _kernel<Fn>*> active;
 
-				template<class T, size_t Bits>
-				constexpr std::array<T, 8> init_hash() {
-					throw "Base method called";
-				}
-				template<> constexpr std::array<uint32_t, 8> init_hash<uint32_t, 224>() { // sha224
-					return {
-						0xC1059ED8, 0x367CD507, 0x3070DD17, 0xF70E5939,
-						0xFFC00B31, 0x68581511, 0x64F98FA7, 0xBEFA4FA4
-					};
-				};
-				template<> constexpr std::array<uint32_t, 8> init_hash<uint32_t, 256>() { // sha256
-					return {
-						0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
-						0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
-					};
 				};
-				template<> constexpr std::array<uint64_t, 8> init_hash<uint64_t, 384>() { // sha384
-					return {
-						0xCBBB9D5DC1059ED8, 0x629A292A367CD507, 0x9159015A3070DD17, 0x152FECD8F70E5939,
-						0x67332667FFC00B31, 0x8EB44A8768581511, 0xDB0C2E0D64F98FA7, 0x47B5481DBEFA4FA4
-					};
+
+				#ifdef __NEO_SHA_VECTORS
+				typedef uint32_t _u32x8  __attribute__((vector_size(32)));
+				typedef uint32_t _u32x16 __attribute__((vector_size(64)));
+				typedef uint64_t _u64x2  __attribute__((vector_size(16)));
+				typedef uint64_t _u64x4  __attribute__((vector_size(32)));
+				typedef uint64_t _u64x8  __attribute__((vector_size(64)));
+
+				// lane helpers write through references, wide vectors by value outside their target trip -Wpsabi
+				template<class R>
+				__NEO_SHA_INLINE void _vrotr(R& out, const R& x, int sh) {
+					out = (x >> sh) | (x << (static_cast<int>(sizeof(x[0]) * 8) - sh));
 				}
-				template<> constexpr std::array<uint64_t, 8> init_hash<uint64_t, 512>() { // sha512
-					return {
-						0x6A09E667F3BCC908, 0xBB67AE8584CAA73B, 0x3C6EF372FE94F82B, 0xA54FF53A5F1D36F1,
-						0x510E527FADE682D1, 0x9B05688C2B3E6C1F, 0x1F83D9ABFB41BD6B, 0x5BE0CD19137E2179
-					};
+				template<class R>
+				__NEO_SHA_INLINE void _vrotl(R& out, const R& x, int sh) {
+					out = (x << sh) | (x >> (static_cast<int>(sizeof(x[0]) * 8) - sh));
 				}
-				template<> constexpr std::array<uint64_t, 8> init_hash<uint64_t, 224>() { // sha512/224
-					return {
-						0x8C3D37C819544DA2, 0x73E1996689DCD4D6, 0x1DFAB7AE32FF9C82, 0x679DD514582F9FCF,
-						0x0F6D2B697BD44DA8, 0x77E36F7304C48942, 0x3F9D85A86A1D36C8, 0x1112E6AD91D692A1
-					};
+				// rotr(x, a) ^ rotr(x, b) ^ rotr(x, c), or a shift for c when Shr
+				template<bool Shr, class R>
+				__NEO_SHA_INLINE void _vsigma(R& out, const R& x, int a, int b, int c) {
+					R ra, rb;
+					_vrotr(ra, x, a);
+					_vrotr(rb, x, b);
+					if(Shr)
+						out = ra ^ rb ^ (x >> c);
+					else {
+						_vrotr(out, x, c);
+						out ^= ra ^ rb;
+					}
 				}
-				template<> constexpr std::array<uint64_t, 8> init_hash<uint64_t, 256>() { // sha512/256
-					return {
-						0x22312194FC2BF72C, 0x9F555FA3C84C64C2, 0x2393B86B6F53B151, 0x963877195940EABD,
-						0x96283EE2A88EFFE3, 0xBE5E1E2553863992, 0x2B0199FC2C85B8AA, 0x0EB72DDC81C52CA2
-					};
+				// {a[1], b[0]}, the two words straddling a and b
+				__NEO_SHA_INLINE void _valign(_u64x2& out, const _u64x2& a, const _u64x2& b) {
+					#ifdef __clang__
+					out = __builtin_shufflevector(a, b, 1, 2);
+					#else
+					out = __builtin_shuffle(a, b, _u64x2{1, 2});
+					#endif
 				}
+				#endif
 
-				template<class T, size_t N>
-				constexpr std::array<T, N> get_round_table() {
-					throw "Base method called";
+				template<size_t Bits, size_t N, size_t... Is>
+				inline sha_t<Bits> return_hash(const std::array<uint8_t, N>& hash, index<Is...>) {
+					return {hash[Is]...};
 				}
-				template<> constexpr std::array<uint32_t, 64> get_round_table<uint32_t, 64>() { // sha224/256
-					return {
-						0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
-						0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
-						0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
-						0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
-						0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
-						0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
-						0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
-						0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
-					};
+				template<size_t Bits, size_t N, size_t... Is>
+				inline sha_t<Bits> return_hash(const std::array<uint32_t, N>& hash, index<Is...>) {
+					return {hash[Is]...};
 				}
-				template<> constexpr std::array<uint64_t, 80> get_round_table<uint64_t, 80>() { // sha384/512
-					return {
-						0x428A2F98D728AE22, 0x7137449123EF65CD, 0xB5C0FBCFEC4D3B2F, 0xE9B5DBA58189DBBC, 0x3956C25BF348B538,	0x59F111F1B605D019, 0x923F82A4AF194F9B, 0xAB1C5ED5DA6D8118,
-						0xD807AA98A3030242, 0x12835B0145706FBE,	0x243185BE4EE4B28C, 0x550C7DC3D5FFB4E2, 0x72BE5D74F27B896F, 0x80DEB1FE3B1696B1, 0x9BDC06A725C71235,	0xC19BF174CF692694,
-						0xE49B69C19EF14AD2, 0xEFBE4786384F25E3, 0x0FC19DC68B8CD5B5, 0x240CA1CC77AC9C65, 0x2DE92C6F592B0275, 0x4A7484AA6EA6E483, 0x5CB0A9DCBD41FBD4, 0x76F988DA831153B5,
-						0x983E5152EE66DFAB, 0xA831C66D2DB43210, 0xB00327C898FB213F, 0xBF597FC7BEEF0EE4, 0xC6E00BF33DA88FC2, 0xD5A79147930AA725, 0x06CA6351E003826F, 0x142929670A0E6E70,
-						0x27B70A8546D22FFC, 0x2E1B21385C26C926, 0x4D2C6DFC5AC42AED, 0x53380D139D95B3DF, 0x650A73548BAF63DE, 0x766A0ABB3C77B2A8, 0x81C2C92E47EDAEE6, 0x92722C851482353B,
-						0xA2BFE8A14CF10364, 0xA81A664BBC423001, 0xC24B8B70D0F89791, 0xC76C51A30654BE30, 0xD192E819D6EF5218, 0xD69906245565A910, 0xF40E35855771202A, 0x106AA07032BBD1B8,
-						0x19A4C116B8D2D0C8, 0x1E376C085141AB53, 0x2748774CDF8EEB99, 0x34B0BCB5E19B48A8, 0x391C0CB3C5C95A63, 0x4ED8AA4AE3418ACB, 0x5B9CCA4F7763E373, 0x682E6FF3D6B2B8A3,
-						0x748F82EE5DEFB2FC, 0x78A5636F43172F60, 0x84C87814A1F0AB72, 0x8CC702081A6439EC, 0x90BEFFFA23631E28, 0xA4506CEBDE82BDE9, 0xBEF9A3F7B2C67915, 0xC67178F2E372532B,
-						0xCA273ECEEA26619C, 0xD186B8C721C0C207, 0xEADA7DD6CDE0EB1E, 0xF57D4F7FEE6ED178, 0x06F067AA72176FBA, 0x0A637DC5A2C898A6, 0x113F9804BEF90DAE, 0x1B710B35131C471B,
-						0x28DB77F523047D84, 0x32CAAB7B40C72493, 0x3C9EBE0A15C9BEBC, 0x431D67C49C100D4C, 0x4CC5D4BECB3E42B6, 0x597F299CFC657E2A, 0x5FCB6FAB3AD6FAEC, 0x6C44198C4A475817
-					};
+				template<size_t Bits, size_t N, size_t... Is>
+				inline sha_t<Bits> return_hash(const std::array<uint64_t, N>& hash, index<Is...>) {
+					return {static_cast<uint32_t>(hash[Is / 2] >> ((Is & 1) ? 0 : 32))...};
 				}
 
-				template<class T>
-				constexpr std::array<int, 12> unique_vals() {
-					throw "Base method called";
-				}
-				template<> constexpr std::array<int, 12> unique_vals<uint32_t>() {
-					return {
-						7, 18, 3, 17, 19, 10,
-						6, 11, 25, 2, 13, 22
-					};
-				}
-				template<> constexpr std::array<int, 12> unique_vals<uint64_t>() {
-					return {
-						1, 8, 7, 19, 61, 6,
-						14, 18, 41, 28, 34, 39
-					};
+				#ifdef __NEO_SHA_CONSTEXPR
+				// byte buffer for constant evaluation (std::array's non const operator[] is only constexpr since c++17)
+				template<size_t N>
+				struct _cbytes {
+					uint8_t v[N];
+					constexpr uint8_t operator[](size_t i) const {
+						return v[i];
+					}
+				};
+				// byte i of the md padded message: msg, 0x80, zeros and the 64 bit big endian bit length closing the last block
+				constexpr uint8_t _md_padded(const char* msg, size_t len, size_t total, size_t i) {
+					return i < len ? static_cast<uint8_t>(msg[i]) : i == len ? 0x80
+						: i + 8 >= total ? static_cast<uint8_t>((static_cast<uint64_t>(len) << 3) >> ((total - 1 - i) * 8)) : 0;
 				}
+				#endif
 
-				template<class T, size_t Bits, size_t Rounds, size_t Blk>
-				struct _sha2_base {
+				// incremental front-end for the Merkle-Damgard digests (sha1, sha2), Base supplies init(), compress() and finalize()
+				template<class Base>
+				class _md_hasher {
 
-					static constexpr std::array<int, 12> seq = unique_vals<T>();
+					public:
 
-					static sha_t<Bits> hash(const uint8_t* msg, size_t len) {
+						typedef Base base_type;
+						typedef typename Base::state_type state_type;
+
+						static constexpr size_t bits     = Base::bits;
+						static constexpr size_t blk_size = Base::blk_size;
+
+						// trivially copyable snapshot: chaining state, byte count and the bytes still waiting for a full block
+						struct midstate {
+							state_type state;
+							uint64_t length;
+							std::array<uint8_t, blk_size> tail;
+						};
+
+						_md_hasher() {
+							reset();
+						}
+						explicit _md_hasher(const midstate& m) {
+							restore(m);
+						}
 
-						std::array<T, 8> hash = init_hash<T, Bits>();
+						void reset() {
+							state    = Base::init();
+							buffered = 0;
+							length   = 0;
+						}
+
+						// hash a shared prefix once, save() it and restore() (or construct from it) to continue with each suffix
+						midstate save() const {
+							midstate m;
+							std::memset(&m, 0, sizeof(m));	// the padding too (e.g. after sha1's 20 byte state)
+							m.state  = state;
+							m.length = length;
+							std::copy(buffer.begin(), buffer.begin() + buffered, m.tail.begin());
+							std::fill(m.tail.begin() + buffered, m.tail.end(), 0);
+							return m;
+						}
+						void restore(const midstate& m) {
+							state    = m.state;
+							length   = m.length;
+							buffered = static_cast<size_t>(m.length % blk_size);
+							buffer   = m.tail;
+						}
 
-						size_t off;
-						for(off = 0; len - off >= Blk; off += Blk)
-							compress(hash, &msg[off]);
+						template<class T>
+						_md_hasher& update(const T* msg, size_t byte_len) {
 
-						// last block stuff (padding)
+							const uint8_t* data = reinterpret_cast<const uint8_t*>(msg);
+							length += byte_len;
 
-						std::array<uint8_t, Blk> block = {0};
-						size_t lst = len - off;
+							// top up a partially filled block first
+							if(buffered) {
+								size_t take = blk_size - buffered;
+								if(take > byte_len)
+									take = byte_len;
+								std::copy(data, data + take, &buffer[buffered]);
+								buffered += take;
+								data     += take;
+								byte_len -= take;
+								if(buffered < blk_size)
+									return *this;
+								Base::compress(state, buffer.data());
+								buffered = 0;
+							}
+
+							// full blocks are compressed straight from the input
+							size_t full = byte_len / blk_size;
+							Base::compress(state, data, full);
+							data     += full * blk_size;
+							byte_len -= full * blk_size;
 
-						std::copy(&msg[off], &msg[off] + lst, block.begin());
-						block[lst] = 0x80;
+							std::copy(data, data + byte_len, buffer.begin());
+							buffered = byte_len;
 
-						if(lst >= Blk - 8) {
-							compress(hash, block.data());
-							block.fill(0);
+							return *this;
 						}
 
-						reinterpret_cast<size_t&>(block[Blk - sizeof(size_t)]) = _bswap(len << 3); // 3º
-						compress(hash, block.data());
+						sha_t<bits> finalize() const {
+							state_type st = state;
+							return Base::finalize(st, buffer.data(), buffered, length);
+						}
 
-						return return_hash<Bits>(hash, gen_seq<Bits / 32>());
+						// count independent messages on the batch kernel, out[i] receives the digest of msgs[i]
+						static void hash_many(const buffer* msgs, size_t count, sha_t<bits>* out) {
+							Base::hash_many(msgs, count, out);
+						}
+
+					private:
+
+						state_type state;
+						std::array<uint8_t, blk_size> buffer;
+						size_t buffered;
+						uint64_t length;
+
+				};
+
+				// one message given as count fragments (iovec style), full blocks go to the compress function straight from each fragment,
+				// only the blocks straddling a fragment boundary are put together in the hasher
+				template<class Hasher>
+				inline sha_t<Hasher::bits> _hash_gather(const buffer* parts, size_t count) {
+					Hasher h;
+					for(size_t i = 0; i < count; i++)
+						h.update(static_cast<const uint8_t*>(parts[i].data), parts[i].size);
+					return h.finalize();
+				}
+
+				// one message of a length known at compile time: the whole blocks go through Base::compress(), the tail through
+				// Base::compress_tail<Len % blk_size>(), which sees the padding and the length words as constants
+				template<class Base, size_t Len, class Out>
+				__NEO_SHA_INLINE Out _hash_fixed(const uint8_t* msg, Out (*output)(typename Base::state_type&)) {
+
+					static constexpr size_t full = Len / Base::blk_size;
+
+					typename Base::state_type state = Base::init();
+
+					if(full)
+						Base::compress(state, msg, full);
+					Base::template compress_tail<Len % Base::blk_size>(state, &msg[full * Base::blk_size], Len);
+
+					return output(state);
+				}
+
+				// runs count independent messages through a multi-lane kernel (one block per lane and call), refilling the lanes as messages
+				// finish; Base supplies word_type, state_type, lanes_fn, blk_size, state_words, max_lanes, init(), word(), pad(),
+				// compress() and run_lanes(), without a kernel (fn == nullptr) every message goes through compress() on its own
+				template<class Base, class Out>
+				inline void _hash_many(const buffer* msgs, size_t count, Out* out, Out (*output)(typename Base::state_type&), typename Base::lanes_fn fn, size_t lanes) {
+
+					typedef typename Base::word_type word_type;
+					typedef typename Base::state_type state_type;
+
+					static constexpr size_t blk_size = Base::blk_size;
+					static constexpr size_t max_lanes = Base::max_lanes;
+
+					if(!fn) {
+						for(size_t i = 0; i < count; i++) {
+							const uint8_t* data = static_cast<const uint8_t*>(msgs[i].data);
+							size_t full = msgs[i].size / blk_size;
+							uint8_t tail[blk_size * 2];
+							state_type state = Base::init();
+							Base::compress(state, data, full);
+							Base::compress(state, tail, Base::pad(tail, &data[full * blk_size], msgs[i].size % blk_size, msgs[i].size));
+							out[i] = output(state);
+						}
+						return;
 					}
 
-					static void compress(std::array<T, 8>& state, const uint8_t block[Blk]) {
+					struct lane_t {
+						size_t msg;				// index in msgs, count when idle
+						const uint8_t* data;
+						size_t full;			// blocks read straight from data
+						size_t total;			// full + padding blocks
+						size_t done;
+						uint8_t tail[blk_size * 2];
+					};
 
-						// round_table => k
-						static constexpr std::array<T, Rounds> round_table = get_round_table<T, Rounds>();
+					static const std::array<uint8_t, blk_size> idle_block = {};
+					state_type state = Base::init();
 
-						// schedule => w
-						std::array<T, Rounds> schedule;
+					lane_t lane[max_lanes];
+					word_type st[Base::state_words * max_lanes];
+					const uint8_t* blocks[max_lanes];
+					size_t next = 0, active = 0;
 
-						// copy chunk into first 16 words w[0,16) of the message schedule array, big-endian encoding
-						for(size_t i = 0; i < 16; i++)
-							schedule[i] = _bswap(reinterpret_cast<const T&>(block[i * sizeof(T)]));
+					for(size_t l = 0; l < lanes; l++)
+						lane[l].msg = count;
 
-						// first 16 words expansion to [16,64/80)
-						for(size_t i = 16; i < Rounds; i++)
-							schedule[i] = schedule[i - 16] + schedule[i - 7]
-							+ (_rotrr(schedule[i - 15], seq[0]) ^ _rotrr(schedule[i - 15], seq[1]) ^ (schedule[i - 15] >> seq[2]))
-							+ (_rotrr(schedule[i - 2], seq[3]) ^ _rotrr(schedule[i - 2], seq[4]) ^ (schedule[i - 2] >> seq[5]));
+					while(true) {
 
-						std::array<T, 8> hbuff = state;
+						// refill idle lanes
+						for(size_t l = 0; l < lanes && next < count; l++) {
+							if(lane[l].msg != count)
+								continue;
+							lane_t& ln = lane[l];
+							size_t size = msgs[next].size;
+							ln.msg   = next++;
+							ln.data  = static_cast<const uint8_t*>(msgs[ln.msg].data);
+							ln.full  = size / blk_size;
+							ln.total = ln.full + Base::pad(ln.tail, &ln.data[ln.full * blk_size], size % blk_size, size);
+							ln.done  = 0;
+							state = Base::init();
+							for(size_t i = 0; i < Base::state_words; i++)
+								st[i * lanes + l] = Base::word(state, i);
+							active++;
+						}
 
-						// main compression loop (64/80 rounds)
-						for(size_t i = 0; i < Rounds / 8; i++) {
-							round_fn<0, 1, 2, 3, 4, 5, 6, 7>(hbuff, schedule[i * 8 + 0], round_table[i * 8 + 0]);
-							round_fn<7, 0, 1, 2, 3, 4, 5, 6>(hbuff, schedule[i * 8 + 1], round_table[i * 8 + 1]);
-							round_fn<6, 7, 0, 1, 2, 3, 4, 5>(hbuff, schedule[i * 8 + 2], round_table[i * 8 + 2]);
-							round_fn<5, 6, 7, 0, 1, 2, 3, 4>(hbuff, schedule[i * 8 + 3], round_table[i * 8 + 3]);
-							round_fn<4, 5, 6, 7, 0, 1, 2, 3>(hbuff, schedule[i * 8 + 4], round_table[i * 8 + 4]);
-							round_fn<3, 4, 5, 6, 7, 0, 1, 2>(hbuff, schedule[i * 8 + 5], round_table[i * 8 + 5]);
-							round_fn<2, 3, 4, 5, 6, 7, 0, 1>(hbuff, schedule[i * 8 + 6], round_table[i * 8 + 6]);
-							round_fn<1, 2, 3, 4, 5, 6, 7, 0>(hbuff, schedule[i * 8 + 7], round_table[i * 8 + 7]);
+						// too few messages left to fill half the lanes: finish them one by one
+						if(next == count && active * 2 <= lanes) {
+							for(size_t l = 0; l < lanes; l++) {
+								lane_t& ln = lane[l];
+								if(ln.msg == count)
+									continue;
+								for(size_t i = 0; i < Base::state_words; i++)
+									Base::word(state, i) = st[i * lanes + l];
+								if(ln.done < ln.full)
+									Base::compress(state, &ln.data[ln.done * blk_size], ln.full - ln.done);
+								size_t pad_done = ln.done > ln.full ? ln.done - ln.full : 0;
+								Base::compress(state, &ln.tail[pad_done * blk_size], ln.total - ln.full - pad_done);
+								out[ln.msg] = output(state);
+							}
+							return;
 						}
 
-						for(size_t i = 0; i < 8; i++)
-							state[i] += hbuff[i];
+						// run every lane in lockstep until the next one finishes
+						size_t steps = ~size_t(0);
+						for(size_t l = 0; l < lanes; l++)
+							if(lane[l].msg != count && lane[l].total - lane[l].done < steps)
+								steps = lane[l].total - lane[l].done;
 
-					}
+						for(size_t s = 0; s < steps; s++) {
+							for(size_t l = 0; l < lanes; l++) {
+								const lane_t& ln = lane[l];
+								blocks[l] = ln.msg == count ? idle_block.data()
+									: ln.done + s < ln.full ? &ln.data[(ln.done + s) * blk_size] : &ln.tail[(ln.done + s - ln.full) * blk_size];
+							}
+							Base::run_lanes(fn, st, blocks);
+						}
 
-					template<size_t a, size_t b, size_t c, size_t d, size_t e, size_t f, size_t g, size_t h>
-					inline static void round_fn(std::array<T, 8>& st, T w, T k) {
-						T tmp = (_rotrr(st[e], seq[6]) ^ _rotrr(st[e], seq[7]) ^ _rotrr(st[e], seq[8])) + ((st[e] & st[f]) ^ (~st[e] & st[g])) + w + k;
-						st[d] += tmp + st[h];
-						st[h] += tmp + (_rotrr(st[a], seq[9]) ^ _rotrr(st[a], seq[10]) ^ _rotrr(st[a], seq[11])) + ((st[a] & st[b]) ^ (st[a] & st[c]) ^ (st[b] & st[c]));
+						for(size_t l = 0; l < lanes; l++) {
+							lane_t& ln = lane[l];
+							if(ln.msg == count)
+								continue;
+							ln.done += steps;
+							if(ln.done == ln.total) {
+								for(size_t i = 0; i < Base::state_words; i++)
+									Base::word(state, i) = st[i * lanes + l];
+								out[ln.msg] = output(state);
+								ln.msg = count;
+								active--;
+							}
+						}
 					}
+				}
 
-				};
+				// pbkdf2-hmac (rfc 8018) over a merkle-damgard Base: the key pads are compressed once, after the first one every iteration is
+				// one inner and one outer compress of a single prepadded block, output blocks run side by side on the multi-lane kernel
+				template<class Base>
+				struct _pbkdf2 {
 
-			}
-			namespace __sha3 {
+					typedef typename Base::state_type state_type;
+					typedef typename Base::word_type word_type;
 
-				using namespace neo::hash::__sha_details::__shared;
+					static constexpr size_t blk_size  = Base::blk_size;
+					static constexpr size_t out_size  = Base::bits / 8;
+					static constexpr size_t max_lanes = Base::max_lanes;
 
-				template<size_t Bits, size_t Bitrate, size_t Capacity, uint8_t Delimiter>
-				struct _sha3_base {
+					static void derive(const uint8_t* pw, size_t pw_len, const uint8_t* salt, size_t salt_len, size_t iterations, uint8_t* out, size_t out_len) {
 
-					static constexpr size_t blk_size = Bitrate / 8;
+						if(!iterations)
+							throw std::invalid_argument("pbkdf2: iterations must be >= 1");
 
-					typedef union {
-						std::array<std::array<uint64_t, 5>, 5> a_u64;
-						std::array<uint64_t, 25> u64;
-						std::array<uint8_t, 200> u8;
-					} state_t;
+						state_type inner, outer;
+						key(inner, outer, pw, pw_len);
 
-					static sha_t<Bits> hash(const uint8_t* msg, size_t len) {
+						size_t lanes;
+						typename Base::lanes_fn fn = Base::batch(lanes);
 
-						state_t state;
-						sponge(state, msg, len);
+						size_t count = (out_len + out_size - 1) / out_size;
+						uint8_t t[max_lanes][out_size];
 
-						return return_hash<Bits>(state.u8, gen_seq<Bits / 8>());
+						for(size_t first = 0; first < count; ) {
+
+							// same rule as _hash_many(): fewer blocks than half the lanes go one by one
+							size_t n = count - first < lanes ? count - first : lanes;
+							if(!fn || n * 2 <= lanes)
+								n = 1;
+
+							if(n == 1)
+								derive_block(inner, outer, salt, salt_len, first + 1, iterations, t[0]);
+							else
+								derive_lanes(inner, outer, salt, salt_len, first + 1, n, iterations, t, fn, lanes);
+
+							for(size_t l = 0; l < n; l++, first++) {
+								size_t take = out_len - first * out_size < out_size ? out_len - first * out_size : out_size;
+								std::memcpy(&out[first * out_size], t[l], take);
+							}
+						}
 					}
-					static sha_t<Bits> hash_shake(const uint8_t* msg, size_t len) {
 
-						state_t state;
-						sponge(state, msg, len);
-						
-						// squeeze 
-						std::array<uint8_t, Bits / 8> out;
-						for(size_t i = 0; i < Bits / 8; i += 200) {
-							for(size_t j = i; j < i + 200 && j + i < Bits / 8; j++)
-								out[j] = state.u8[j];
-							permute(state.a_u64);
+					// inner and outer midstates: the key (hashed first when longer than a block) xor ipad / opad, compressed
+					static void key(state_type& inner, state_type& outer, const uint8_t* pw, size_t pw_len) {
+
+						uint8_t block[blk_size] = {};
+
+						if(pw_len > blk_size) {
+							state_type st = Base::init();
+							size_t full = pw_len / blk_size;
+							Base::compress(st, pw, full);
+							sha_t<Base::bits> d = Base::finalize(st, &pw[full * blk_size], pw_len % blk_size, pw_len);
+							std::copy(d.begin(), d.end(), block);
 						}
+						else
+							std::copy(pw, pw + pw_len, block);
 
-						return return_hash<Bits>(out, gen_seq<Bits / 8>());
+						for(size_t i = 0; i < blk_size; i++)
+							block[i] ^= 0x36;
+						inner = Base::init();
+						Base::compress(inner, block);
+
+						for(size_t i = 0; i < blk_size; i++)
+							block[i] ^= 0x36 ^ 0x5c;
+						outer = Base::init();
+						Base::compress(outer, block);
 					}
 
-					static void sponge(state_t& state, const uint8_t* msg, size_t len) {
-						
-						state.u64.fill(0);
+					// U1 = hmac(salt || be32(index)) into the prepadded block of the next iterations
+					static void first_iteration(const state_type& inner, const state_type& outer, const uint8_t* salt, size_t salt_len, size_t index, uint8_t* blk) {
 
-						size_t off;
-						for(off = 0; len - off >= blk_size; off += blk_size) {
-							for(size_t i = 0; i < blk_size; i++)
-								state.u8[i] ^= msg[off + i];
-							permute(state.a_u64);
-						}
+						state_type st = inner;
+						size_t full = salt_len / blk_size;
+						Base::compress(st, salt, full);
 
-						size_t lst = len - off;
-						for(size_t i = 0; i < lst; i++)
-							state.u8[i] ^= msg[off + i];
+						// salt tail + block index, then the hmac message padding (the key block counts towards the length)
+						uint8_t tail[blk_size + 4];
+						size_t lst = salt_len % blk_size;
+						std::copy(&salt[full * blk_size], &salt[salt_len], tail);
+						_store_be<uint32_t>(&tail[lst], static_cast<uint32_t>(index));
 
-						state.u8[lst] ^= Delimiter;
-						state.u8[blk_size - 1] ^= 0x80;
-						permute(state.a_u64);
+						uint8_t last[blk_size * 2];
+						Base::compress(st, last, Base::pad(last, tail, lst + 4, blk_size + salt_len + 4));
+
+						sha_t<Base::bits> u = Base::output(st);
+						Base::pad(blk, u.data(), out_size, blk_size + out_size);
+						st = outer;
+						Base::compress(st, blk);
+						digest(blk, st);
 					}
-					static void permute(std::array<std::array<uint64_t, 5>, 5>& a) {
 
-						static constexpr std::array<uint64_t, 24> round_consts = {
-							0x0000000000000001, 0x0000000000008082, 0x800000000000808A, 0x8000000080008000,
-							0x000000000000808B, 0x0000000080000001, 0x8000000080008081, 0x8000000000008009,
-							0x000000000000008A, 0x0000000000000088, 0x0000000080008009, 0x000000008000000A,
-							0x000000008000808B, 0x800000000000008B, 0x8000000000008089, 0x8000000000008003,
-							0x8000000000008002, 0x8000000000000080, 0x000000000000800A, 0x800000008000000A,
-							0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008
-						};
-						static constexpr std::array<std::array<int, 5>, 5> rot_offs = {{
-							{ 0,  1, 62, 28, 27},
-							{36, 44,  6, 55, 20},
-							{ 3, 10, 43, 25, 39},
-							{41, 45, 15, 21,  8},
-							{18,  2, 61, 56, 14}
-						}};
+					static void derive_block(const state_type& inner, const state_type& outer, const uint8_t* salt, size_t salt_len, size_t index, size_t iterations, uint8_t* t) {
+
+						uint8_t blk[blk_size * 2];
+						first_iteration(inner, outer, salt, salt_len, index, blk);
+						std::memcpy(t, blk, out_size);
 
-						std::array<std::array<uint64_t, 5>, 5> b;
-						std::array<uint64_t, 5> c;
+						for(size_t j = 1; j < iterations; j++) {
+							state_type st = inner;
+							Base::compress(st, blk);
+							digest(blk, st);
+							st = outer;
+							Base::compress(st, blk);
+							digest(blk, st);
+							for(size_t i = 0; i < out_size; i++)
+								t[i] ^= blk[i];
+						}
+					}
 
-						for(size_t rd = 0; rd < 24; rd++) {
+					// blocks index .. index + n - 1 on the lanes kernel, idle lanes rerun lane 0 and are ignored
+					static void derive_lanes(const state_type& inner, const state_type& outer, const uint8_t* salt, size_t salt_len, size_t index, size_t n,
+											 size_t iterations, uint8_t (&t)[max_lanes][out_size], typename Base::lanes_fn fn, size_t lanes) {
 
-							// theta
-							for(size_t x = 0; x < 5; x++)
-								c[x] = a[0][x] ^ a[1][x] ^ a[2][x] ^ a[3][x] ^ a[4][x];
-							for(size_t x = 0; x < 5; x++) {
-								uint64_t dx = c[(x + 4) % 5] ^ _rotrl(c[(x + 1) % 5], 1);
-								for(size_t y = 0; y < 5; y++)
-									a[y][x] ^= dx;
+						uint8_t blk[max_lanes][blk_size * 2];
+						const uint8_t* blocks[max_lanes];
+						word_type st[Base::state_words * max_lanes];
+
+						for(size_t l = 0; l < lanes; l++) {
+							if(l < n) {
+								first_iteration(inner, outer, salt, salt_len, index + l, blk[l]);
+								std::memcpy(t[l], blk[l], out_size);
 							}
+							blocks[l] = blk[l < n ? l : 0];
+						}
 
-							// rho & pi
-							for(size_t y = 0; y < 5; y++)
-								for(size_t x = 0; x < 5; x++)
-									b[(x * 2 + y * 3) % 5][y] = _rotrl(a[y][x], rot_offs[y][x]);
+						for(size_t j = 1; j < iterations; j++) {
+							run(st, inner, blocks, blk, n, fn, lanes);
+							run(st, outer, blocks, blk, n, fn, lanes);
+							for(size_t l = 0; l < n; l++)
+								for(size_t i = 0; i < out_size; i++)
+									t[l][i] ^= blk[l][i];
+						}
+					}
+					// one compress of every lane's block from the midstate mid, the digests go back into the blocks
+					static void run(word_type* st, state_type mid, const uint8_t* const* blocks, uint8_t (&blk)[max_lanes][blk_size * 2], size_t n, typename Base::lanes_fn fn, size_t lanes) {
 
-							// chi
-							for(size_t y = 0; y < 5; y++)
-								for(size_t x = 0; x < 5; x++)
-									a[y][x] = b[y][x] ^ (~b[y][(x + 1) % 5] & b[y][(x + 2) % 5]);
+						for(size_t i = 0; i < Base::state_words; i++)
+							for(size_t l = 0; l < lanes; l++)
+								st[i * lanes + l] = Base::word(mid, i);
 
-							// iota
-							a[0][0] ^= round_consts[rd];
+						Base::run_lanes(fn, st, blocks);
 
+						for(size_t l = 0; l < n; l++) {
+							for(size_t i = 0; i < Base::state_words; i++)
+								Base::word(mid, i) = st[i * lanes + l];
+							digest(blk[l], mid);
 						}
+					}
 
+					static void digest(uint8_t* blk, state_type& st) {
+						sha_t<Base::bits> d = Base::output(st);
+						std::copy(d.begin(), d.end(), blk);
 					}
 
 				};
 
-			}
+				// fixed set of worker threads running one parallel_for() at a time, the calling thread takes part in the work too
+				class _thread_pool {
 
-		}
+					public:
+
+						explicit _thread_pool(size_t threads) : busy(false), job(nullptr), stop(false), generation(0), pending(0) {
+							for(size_t i = 0; i < threads; i++)
+								workers.emplace_back([this] { work(); });
+						}
+						~_thread_pool() {
+							{
+								std::lock_guard<std::mutex> lock(mtx);
+								stop = true;
+							}
+							wake.notify_all();
+							for(std::thread& t : workers)
+								t.join();
+						}
 
+						_thread_pool(const _thread_pool&) = delete;
+						_thread_pool& operator=(const _thread_pool&) = delete;
 
-		class sha1 {
+						// threads taking part in a parallel_for(), the caller included
+						size_t size() const {
+							return workers.size() + 1;
+						}
 
-			public:
+						// calls fn(begin, end) over [0, count) in chunks of grain, claimed on demand so slower threads take fewer chunks,
+						// returns once every chunk is done; runs inline when called from this pool's own work, and from another pool's
+						// work when this one is busy (waiting there could close a cycle of pools waiting on each other)
+						template<class Fn>
+						void parallel_for(size_t count, size_t grain, Fn fn) {
 
-				template<class T> inline static sha_t<160> hash(const T* msg, size_t byte_len) {
-					return __sha_details::__sha1::_sha1_base::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
-				}
+							if(!grain)
+								grain = 1;
 
-		};
-		class sha2 {
+							std::unique_lock<std::mutex> serial(submit, std::defer_lock);
+							bool fan_out = !workers.empty() && count > grain && current() != this;
+							if(fan_out && current())
+								fan_out = !busy.load(std::memory_order_acquire) && serial.try_lock();
+							else if(fan_out)
+								serial.lock();
+							if(!fan_out) {
+								if(count)
+									fn(0, count);
+								return;
+							}
 
-			public:
+							busy.store(true, std::memory_order_release);
+							std::atomic<size_t> next(0);
+							std::function<void()> run = [&] {
+								for(size_t b; (b = next.fetch_add(grain)) < count; )
+									fn(b, std::min(b + grain, count));
+							};
 
-				template<class T> inline static sha_t<224> hash_224(const T* msg, size_t byte_len) {
-					return __sha_details::__sha2::_sha2_base<uint32_t, 224, 64, 64>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
-				}
-				template<class T> inline static sha_t<256> hash_256(const T* msg, size_t byte_len) {
-					return __sha_details::__sha2::_sha2_base<uint32_t, 256, 64, 64>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
-				}
-				template<class T> inline static sha_t<384> hash_384(const T* msg, size_t byte_len) {
-					return __sha_details::__sha2::_sha2_base<uint64_t, 384, 80, 128>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
-				}
-				template<class T> inline static sha_t<512> hash_512(const T* msg, size_t byte_len) {
-					return __sha_details::__sha2::_sha2_base<uint64_t, 512, 80, 128>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
-				}
-				template<class T> inline static sha_t<224> hash_512_224(const T* msg, size_t byte_len) {
-					return __sha_details::__sha2::_sha2_base<uint64_t, 224, 80, 128>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
-				}
-				template<class T> inline static sha_t<256> hash_512_256(const T* msg, size_t byte_len) {
-					return __sha_details::__sha2::_sha2_base<uint64_t, 256, 80, 128>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
-				}
+							{
+								std::lock_guard<std::mutex> lock(mtx);
+								job     = &run;
+								pending = workers.size();
+								generation++;
+							}
+							wake.notify_all();
 
-		};
-		class sha3 {
-		
-			public:
+							const _thread_pool* outer = current();
+							current() = this;
+							run();
+							current() = outer;
 
-				template<class T> inline static sha_t<224> hash_224(const T* msg, size_t byte_len) {
-					return __sha_details::__sha3::_sha3_base<224, 1152, 448, 0x06>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
-				}
-				template<class T> inline static sha_t<256> hash_256(const T* msg, size_t byte_len) {
-					return __sha_details::__sha3::_sha3_base<256, 1088, 512, 0x06>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
-				}
-				template<class T> inline static sha_t<384> hash_384(const T* msg, size_t byte_len) {
-					return __sha_details::__sha3::_sha3_base<384, 832, 768, 0x06>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
+							std::unique_lock<std::mutex> lock(mtx);
+							done.wait(lock, [this] { return pending == 0; });
+							job = nullptr;
+							busy.store(false, std::memory_order_release);
+						}
+
+						// shared by the library, one worker less than the hardware threads
+						static _thread_pool& global() {
+							static _thread_pool pool(std::max<unsigned>(std::thread::hardware_concurrency(), 1) - 1);
+							return pool;
+						}
+
+					private:
+
+						// the pool whose work this thread is running: always its own for a worker, this one for a caller inside parallel_for()
+						static const _thread_pool*& current() {
+							static thread_local const _thread_pool* pool = nullptr;
+							return pool;
+						}
+
+						void work() {
+
+							current() = this;
+							size_t seen = 0;
+
+							while(true) {
+
+								const std::function<void()>* task;
+								{
+									std::unique_lock<std::mutex> lock(mtx);
+									wake.wait(lock, [&] { return stop || generation != seen; });
+									if(stop)
+										return;
+									seen = generation;
+									task = job;
+								}
+
+								(*task)();
+
+								std::lock_guard<std::mutex> lock(mtx);
+								if(--pending == 0)
+									done.notify_all();
+							}
+						}
+
+						std::vector<std::thread> workers;
+						std::mutex submit, mtx;
+						std::atomic<bool> busy;	// a parallel_for() holds submit
+						std::condition_variable wake, done;
+						const std::function<void()>* job;
+						bool stop;
+						size_t generation, pending;
+
+				};
+
+				// count tasks dealt out as one contiguous run per participant, each run's front (taken by its owner) and back (stolen by
+				// the others once their own run is empty) packed in one atomic word, so both ends claim a task with a single compare exchange
+				class _steal_runs {
+
+					public:
+
+						// cuts[p] .. cuts[p + 1] is the run of participant p
+						explicit _steal_runs(const std::vector<uint32_t>& cuts) : runs(cuts.size() - 1) {
+							for(size_t p = 0; p < runs.size(); p++)
+								runs[p].span.store(cuts[p] | (static_cast<uint64_t>(cuts[p + 1]) << 32), std::memory_order_relaxed);
+						}
+
+						// the next task of participant p, its own first, then from the back of the next runs around; false once all are taken
+						bool next(size_t p, size_t& task) {
+							if(take(runs[p], false, task))
+								return true;
+							for(size_t i = 1; i < runs.size(); i++)
+								if(take(runs[(p + i) % runs.size()], true, task))
+									return true;
+							return false;
+						}
+
+						size_t size() const {
+							return runs.size();
+						}
+
+					private:
+
+						struct run {
+							std::atomic<uint64_t> span;
+							run() : span(0) {}
+						};
+
+						static bool take(run& r, bool back, size_t& task) {
+							uint64_t s = r.span.load(std::memory_order_relaxed);
+							while(true) {
+								uint32_t front = static_cast<uint32_t>(s), end = static_cast<uint32_t>(s >> 32);
+								if(front >= end)
+									return false;
+								uint64_t next = back ? s - (uint64_t(1) << 32) : s + 1;
+								if(r.span.compare_exchange_weak(s, next, std::memory_order_relaxed)) {
+									task = back ? end - 1 : front;
+									return true;
+								}
+							}
+						}
+
+						std::vector<run> runs;
+				};
+
+				inline buffer _as_buffer(const buffer& b) {
+					return b;
 				}
-				template<class T> inline static sha_t<512> hash_512(const T* msg, size_t byte_len) {
-					return __sha_details::__sha3::_sha3_base<512, 576, 1024, 0x06>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
+				// contiguous containers and views (std::string, std::vector<uint8_t>, std::string_view...)
+				template<class C>
+				inline buffer _as_buffer(const C& c) {
+					return {c.data(), c.size() * sizeof(*c.data())};
 				}
 
-				template<size_t Bits, class T>
-				inline static sha_t<Bits> hash_shake_128(const T* msg, size_t byte_len) {
-					return __sha_details::__sha3::_sha3_base<Bits, 1344, 256, 0x1f>::hash_shake(reinterpret_cast<const uint8_t*>(msg), byte_len);
-				}
-				template<size_t Bits, class T>
-				inline static sha_t<Bits> hash_shake_256(const T* msg, size_t byte_len) {
-					return __sha_details::__sha3::_sha3_base<Bits, 1088, 512, 0x1f>::hash_shake(reinterpret_cast<const uint8_t*>(msg), byte_len);
+				// independent messages msgs[0, count) into out[0, count) on Executor (size(), parallel_for() as in _thread_pool): tasks
+				// of similar byte volume (a large message is a task of its own) are dealt out by volume and balanced by _steal_runs, each
+				// task goes through Hasher::hash_many() a window at a time
+				template<class Hasher, class In, class Out, class Executor>
+				inline void _parallel_hash(In msgs, size_t count, Out out, Executor& executor) {
+
+					static constexpr size_t window = 64;
+					typedef sha_t<Hasher::bits> digest;
+
+					auto hash_range = [&](size_t b, size_t e) {
+						buffer parts[window];
+						digest digests[window];
+						for(size_t i = b; i < e; i += window) {
+							size_t n = std::min(window, e - i);
+							for(size_t j = 0; j < n; j++)
+								parts[j] = _as_buffer(msgs[i + j]);
+							Hasher::hash_many(parts, n, digests);
+							for(size_t j = 0; j < n; j++)
+								out[i + j] = digests[j];
+						}
+					};
+
+					const size_t threads = executor.size();
+					uint64_t total = 0;
+					for(size_t i = 0; i < count; i++)
+						total += _as_buffer(msgs[i]).size;
+
+					// a few tasks per thread to steal, none so small that claiming it costs more than hashing it
+					const uint64_t task_bytes = std::max<uint64_t>(total / (threads * 8), 1 << 16);
+					const size_t task_items = std::max<size_t>(std::min<size_t>(count / (threads * 8), window * 16), window);
+
+					if(threads <= 1 || total <= task_bytes) {
+						hash_range(0, count);
+						return;
+					}
+
+					// task t is items [starts[t], starts[t + 1]), participant p starts on the tasks its share of the volume falls in
+					std::vector<size_t> starts(1, 0);
+					std::vector<uint32_t> cuts(1, 0);
+					uint64_t bytes = 0, volume = 0;
+					for(size_t i = 0; i < count; i++) {
+						uint64_t size = _as_buffer(msgs[i]).size;
+						bytes  += size;
+						volume += size;
+						if(bytes >= task_bytes || i + 1 - starts.back() >= task_items || i + 1 == count) {
+							starts.push_back(i + 1);
+							bytes = 0;
+							while(cuts.size() < threads && volume * threads >= total * cuts.size())
+								cuts.push_back(static_cast<uint32_t>(starts.size() - 1));
+						}
+					}
+					while(cuts.size() <= threads)
+						cuts.push_back(static_cast<uint32_t>(starts.size() - 1));
+
+					_steal_runs runs(cuts);
+					executor.parallel_for(runs.size(), 1, [&](size_t b, size_t e) {
+						for(size_t p = b; p < e; p++)
+							for(size_t t; runs.next(p, t); )
+								hash_range(starts[t], starts[t + 1]);
+					});
 				}
 
+				// rfc 6962 merkle hashes over a merkle-damgard Base whose digest pairs fill exactly one block (sha256, sha512): a leaf is
+				// H(0x00 || digest), one block, a node is H(0x01 || left || right), one block plus a second one that is the last byte of
+				// right followed by a padding known at compile time; the prefixes keep a node from passing as a leaf, hashes of the same
+				// kind run side by side on the multi-lane kernel
+				template<class Base>
+				struct _merkle {
+
+					typedef typename Base::state_type state_type;
+					typedef typename Base::word_type word_type;
+					typedef sha_t<Base::bits> digest;
+
+					static constexpr size_t blk_size  = Base::blk_size;
+					static constexpr size_t max_lanes = Base::max_lanes;
+
+					static_assert(sizeof(digest) * 2 == blk_size, "merkle nodes need two digests to fill one block");
+
+					// last block of a message of total bytes whose first used bytes are in it: those bytes (left zero), 0x80, zeros, big
+					// endian bit length
+					static constexpr uint8_t pad_byte(size_t i, size_t used, size_t total) {
+						return i < used ? 0 : i == used ? 0x80 : i >= blk_size - 8 ? static_cast<uint8_t>((uint64_t(total) * 8) >> ((blk_size - 1 - i) * 8)) : 0;
+					}
+					template<size_t... Is>
+					static constexpr std::array<uint8_t, blk_size> pad_block(size_t used, size_t total, index<Is...>) {
+						return {{pad_byte(Is, used, total)...}};
+					}
+					static constexpr std::array<uint8_t, blk_size> leaf_block = pad_block(1 + sizeof(digest), 1 + sizeof(digest), gen_seq<blk_size>());
+					static constexpr std::array<uint8_t, blk_size> node_tail  = pad_block(1, 1 + blk_size, gen_seq<blk_size>());
+
+					// the padded blocks of a leaf (width 1, one digest at data) or a node (width 2, two digests back to back at data),
+					// returns how many
+					static size_t fill(size_t width, const uint8_t* data, uint8_t (*blocks)[blk_size]) {
+						if(width == 1) {
+							std::memcpy(blocks[0], leaf_block.data(), blk_size);
+							std::memcpy(blocks[0] + 1, data, sizeof(digest));
+							return 1;
+						}
+						blocks[0][0] = 0x01;
+						std::memcpy(blocks[0] + 1, data, blk_size - 1);
+						std::memcpy(blocks[1], node_tail.data(), blk_size);
+						blocks[1][0] = data[blk_size - 1];
+						return 2;
+					}
+
+					// out[i] = the leaf (width 1) or node (width 2) hash of data_at(i), which points to width digests back to back
+					template<class DataAt>
+					static void run(size_t width, size_t count, DataAt data_at, digest* out) {
+
+						size_t lanes;
+						typename Base::lanes_fn fn = Base::batch(lanes);
+						uint8_t scratch[max_lanes][2][blk_size];
+						size_t i = 0;
+
+						if(fn) {
+
+							word_type st[Base::state_words * max_lanes];
+							const uint8_t* blocks[max_lanes];
+							state_type state = Base::init();
+
+							// same rule as _hash_many(): fewer hashes than half the lanes go one by one, idle lanes rerun the last one
+							for(size_t n; (count - i) * 2 > lanes; i += n) {
+
+								n = std::min(lanes, count - i);
+								state = Base::init();
+								size_t nblk = 0;
+								for(size_t l = 0; l < lanes; l++) {
+									nblk = fill(width, data_at(i + std::min(l, n - 1)), scratch[l]);
+									for(size_t w = 0; w < Base::state_words; w++)
+										st[w * lanes + l] = Base::word(state, w);
+								}
+
+								for(size_t b = 0; b < nblk; b++) {
+									for(size_t l = 0; l < lanes; l++)
+										blocks[l] = scratch[l][b];
+									Base::run_lanes(fn, st, blocks);
+								}
+
+								for(size_t l = 0; l < n; l++) {
+									for(size_t w = 0; w < Base::state_words; w++)
+										Base::word(state, w) = st[w * lanes + l];
+									out[i + l] = Base::output(state);
+								}
+							}
+						}
+
+						for(; i < count; i++) {
+							state_type state = Base::init();
+							size_t nblk = fill(width, data_at(i), scratch[0]);
+							for(size_t b = 0; b < nblk; b++)
+								Base::compress(state, scratch[0][b]);
+							out[i] = Base::output(state);
+						}
+					}
+
+					// leaf hashes of count digests, large counts on the pool
+					static void leaves(const digest* in, size_t count, digest* out) {
+						_thread_pool::global().parallel_for(count, max_lanes * 64, [&](size_t b, size_t e) {
+							run(1, e - b, [&](size_t i) {
+								return in[b + i].data();
+							}, &out[b]);
+						});
+					}
+
+					// next level of a tree: pairs of adjacent nodes, an unpaired last node is carried up as it is, large levels on the pool
+					static void level(const digest* nodes, size_t count, digest* out) {
+
+						size_t pairs = count / 2;
+						const size_t grain = max_lanes * 64;
+
+						_thread_pool::global().parallel_for(pairs, grain, [&](size_t b, size_t e) {
+							run(2, e - b, [&](size_t i) {
+								return nodes[(b + i) * 2].data();
+							}, &out[b]);
+						});
+
+						if(count & 1)
+							out[pairs] = nodes[count - 1];
+					}
+
+				};
+
+				template<class Base>
+				constexpr std::array<uint8_t, _merkle<Base>::blk_size> _merkle<Base>::leaf_block;
+				template<class Base>
+				constexpr std::array<uint8_t, _merkle<Base>::blk_size> _merkle<Base>::node_tail;
+
+				// fastcdc cut points: a gear rolling hash with normalized masks (2 bits harder to match before avg_size, 2 bits easier
+				// after), no cut before min_size and a forced one at max_size; cuts depend on the bytes only, not on how they are fed
+				class _gear_chunker {
+
+					public:
+
+						_gear_chunker(size_t min_size, size_t avg_size, size_t max_size) : min_size(min_size), avg_size(avg_size), max_size(max_size) {
+							if(avg_size < 64 || min_size > avg_size || avg_size > max_size)
+								throw std::invalid_argument("cdc_chunker: sizes must be min_size <= avg_size <= max_size, avg_size >= 64");
+							size_t log2 = 0;
+							while((size_t(2) << log2) <= avg_size)
+								log2++;
+							mask_s = ~uint64_t(0) << (64 - (log2 + 2));
+							mask_l = ~uint64_t(0) << (64 - (log2 - 2));
+							reset();
+						}
+
+						void reset() {
+							fp  = 0;
+							pos = 0;
+						}
+						// bytes of the open chunk seen so far
+						size_t pending() const {
+							return pos;
+						}
+
+						// scans n more bytes of the open chunk: true with used = the bytes up to and including the cut, or false with all used
+						bool next(const uint8_t* p, size_t n, size_t& used) {
+
+							const std::array<uint64_t, 256>& gear = table();
+							size_t i = 0;
+
+							// the hash only keeps the last 64 bytes, so bytes before min_size - 64 can't change a cut
+							size_t skip = min_size > 64 ? min_size - 64 : 0;
+							if(pos < skip) {
+								i    = std::min(n, skip - pos);
+								pos += i;
+							}
+
+							for(; i < n && pos + 1 < min_size; i++, pos++)
+								fp = (fp << 1) + gear[p[i]];
+							for(; i < n && pos + 1 < avg_size; )
+								if(roll(gear, p[i++], mask_s))
+									return cut(i, used);
+							for(; i < n && pos + 1 < max_size; )
+								if(roll(gear, p[i++], mask_l))
+									return cut(i, used);
+							if(i < n) {
+								roll(gear, p[i++], 0);
+								return cut(i, used);
+							}
+
+							used = n;
+							return false;
+						}
+
+					private:
+
+						bool roll(const std::array<uint64_t, 256>& gear, uint8_t b, uint64_t mask) {
+							fp = (fp << 1) + gear[b];
+							pos++;
+							return !(fp & mask);
+						}
+						bool cut(size_t i, size_t& used) {
+							used = i;
+							reset();
+							return true;
+						}
+
+						// splitmix64 of the byte value, so the table is the same on every build
+						static constexpr uint64_t mix(uint64_t z, int sh, uint64_t k) {
+							return (z ^ (z >> sh)) * k;
+						}
+						static constexpr uint64_t gear_value(uint64_t x) {
+							return mix(mix(mix(x * 0x9E3779B97F4A7C15ULL + 0x9E3779B97F4A7C15ULL, 30, 0xBF58476D1CE4E5B9ULL), 27, 0x94D049BB133111EBULL), 31, 1);
+						}
+						template<size_t... Is>
+						static constexpr std::array<uint64_t, 256> gear_table(index<Is...>) {
+							return {{gear_value(Is)...}};
+						}
+						static const std::array<uint64_t, 256>& table() {
+							static constexpr std::array<uint64_t, 256> t = gear_table(gen_seq<256>());
+							return t;
+						}
+
+						size_t min_size, avg_size, max_size;
+						uint64_t mask_s, mask_l;
+						uint64_t fp;
+						size_t pos;
+
+				};
+
+			}
+
+			namespace __sha1 {
+
+				using namespace neo::hash::__sha_details::__shared;
+
+				struct _sha1_base {
+
+					typedef std::array<uint32_t, 5> state_type;
+
+					static constexpr size_t bits     = 160;
+					static constexpr size_t blk_size = 64;
+
+					static state_type init() {
+						return {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+					}
+
+					static sha_t<160> hash(const uint8_t* msg, size_t len) {
+
+						state_type hash = init();
+
+						size_t off = len - len % 64;
+						compress(hash, msg, len / 64);
+
+						return finalize(hash, &msg[off], len - off, len);
+					}
+					static sha_t<160> finalize(state_type& hash, const uint8_t* tail, size_t lst, uint64_t len) {
+
+						std::array<uint8_t, 128> blocks;
+						compress(hash, blocks.data(), pad(blocks.data(), tail, lst, len));
+
+						return output(hash);
+					}
+					// blocks taken by a tail of lst bytes once padded, the bit length needs the last 8 bytes
+					static constexpr size_t tail_blocks(size_t lst) {
+						return lst >= 56 ? 2 : 1;
+					}
+					// writes the last 1 or 2 blocks (message tail + padding + bit length) into out, returns the block count
+					static size_t pad(uint8_t* out, const uint8_t* tail, size_t lst, uint64_t len) {
+
+						size_t count = tail_blocks(lst);
+
+						std::fill(out, out + count * 64, 0);
+						std::copy(tail, tail + lst, out);
+						out[lst] = 0x80;
+
+						_store_be<uint64_t>(&out[count * 64 - 8], len << 3);
+
+						return count;
+					}
+					static sha_t<160> output(state_type& hash) {
+						return return_hash<160>(hash, gen_seq<5>());
+					}
+
+					// no multi-lane kernel, the plumbing lets the shared batch code (_pbkdf2) run sha1 one state at a time
+					typedef uint32_t word_type;
+					typedef void (*lanes_fn)(uint32_t* state, const uint8_t* const* blocks);
+
+					static constexpr size_t state_words = 5;
+					static constexpr size_t max_lanes   = 1;
+
+					static uint32_t& word(state_type& state, size_t i) {
+						return state[i];
+					}
+					static void run_lanes(lanes_fn fn, uint32_t* state, const uint8_t* const* blocks) {
+						fn(state, blocks);
+					}
+					static lanes_fn batch(size_t& lanes) {
+						lanes = 1;
+						return nullptr;
+					}
+					static void hash_many(const buffer* msgs, size_t count, sha_t<160>* out) {
+						_hash_many<_sha1_base>(msgs, count, out, output, nullptr, 1);
+					}
+
+					typedef void (*compress_fn)(state_type&, const uint8_t*, size_t);
+
+					static void compress(state_type& state, const uint8_t* blocks, size_t count = 1) {
+						__NEO_SHA_COUNT(stats_algorithm::sha1, count);
+						kernel().fn(state, blocks, count);
+					}
+
+					static _kernel<compress_fn> kernel() {
+						return kernel_slot().get();
+					}
+					static _kernel_slot<compress_fn>& kernel_slot() {
+						static _kernel_slot<compress_fn> slot(select);
+						return slot;
+					}
+					static _kernel<compress_fn> select(backend b) {
+						if((b == backend::automatic || b == backend::sha_ni) && cpu().sha && cpu().sse41)
+							return {compress_ni, backend::sha_ni};
+						if(b == backend::automatic || b == backend::scalar)
+							return {compress_scalar, backend::scalar};
+						return {nullptr, b};
+					}
+					static bool set_backend(backend b) {
+						_kernel<compress_fn> k = select(b);
+						if(!k.fn)
+							return false;
+						kernel_slot().set(k.id);
+						return true;
+					}
+
+					static void compress_scalar(state_type& state, const uint8_t* blocks, size_t count) {
+						for(size_t i = 0; i < count; i++)
+							compress_block(state, &blocks[i * 64]);
+					}
+
+					// the last Lst bytes of a fixed length message (see _hash_fixed()), padded and inlined into the caller so the scalar
+					// rounds see the padding and length words as constants
+					template<size_t Lst>
+					__NEO_SHA_INLINE static void compress_tail(state_type& state, const uint8_t* tail, uint64_t len) {
+
+						static constexpr size_t count = tail_blocks(Lst);
+
+						uint8_t blocks[count * 64];
+						pad(blocks, tail, Lst, len);
+
+						if(kernel().fn != compress_scalar)
+							return compress(state, blocks, count);
+						__NEO_SHA_COUNT(stats_algorithm::sha1, count);
+						for(size_t i = 0; i < count; i++)
+							compress_unrolled(state, &blocks[i * 64], gen_seq<80>());
+					}
+
+					__NEO_SHA_TARGET("sha,sse4.1")
+					static void compress_ni(state_type& state, const uint8_t* blocks, size_t count) {
+
+						const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090A0B0C0D0E0FULL);
+
+						__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state.data())), 0x1B);
+						__m128i e0   = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+						__m128i e1;
+						__m128i w[4];
+
+						for(size_t i = 0; i < count; i++) {
+
+							const uint8_t* block = &blocks[i * 64];
+							__m128i abcd_save = abcd;
+							__m128i e0_save   = e0;
+
+							quad_ni<0>(block, mask, abcd, e0, e1, w);  quad_ni<1>(block, mask, abcd, e0, e1, w);
+							quad_ni<2>(block, mask, abcd, e0, e1, w);  quad_ni<3>(block, mask, abcd, e0, e1, w);
+							quad_ni<4>(block, mask, abcd, e0, e1, w);  quad_ni<5>(block, mask, abcd, e0, e1, w);
+							quad_ni<6>(block, mask, abcd, e0, e1, w);  quad_ni<7>(block, mask, abcd, e0, e1, w);
+							quad_ni<8>(block, mask, abcd, e0, e1, w);  quad_ni<9>(block, mask, abcd, e0, e1, w);
+							quad_ni<10>(block, mask, abcd, e0, e1, w); quad_ni<11>(block, mask, abcd, e0, e1, w);
+							quad_ni<12>(block, mask, abcd, e0, e1, w); quad_ni<13>(block, mask, abcd, e0, e1, w);
+							quad_ni<14>(block, mask, abcd, e0, e1, w); quad_ni<15>(block, mask, abcd, e0, e1, w);
+							quad_ni<16>(block, mask, abcd, e0, e1, w); quad_ni<17>(block, mask, abcd, e0, e1, w);
+							quad_ni<18>(block, mask, abcd, e0, e1, w); quad_ni<19>(block, mask, abcd, e0, e1, w);
+
+							e0   = _mm_sha1nexte_epu32(e0, e0_save);
+							abcd = _mm_add_epi32(abcd, abcd_save);
+						}
+
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(state.data()), _mm_shuffle_epi32(abcd, 0x1B));
+						state[4] = static_cast<uint32_t>(_mm_extract_epi32(e0, 3));
+					}
+
+					// rounds [I * 4, I * 4 + 4), the schedule of quad Q is built by msg1 at Q - 3, xor at Q - 2 and msg2 at Q - 1
+					template<int I>
+					__NEO_SHA_TARGET("sha,sse4.1")
+					inline static void quad_ni(const uint8_t* block, __m128i mask, __m128i& abcd, __m128i& e0, __m128i& e1, __m128i (&w)[4]) {
+
+						__m128i& e_cur = (I & 1) ? e1 : e0;
+						__m128i& e_nxt = (I & 1) ? e0 : e1;
+
+						if(I < 4)
+							w[I] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&block[I * 16])), mask);
+
+						e_cur = I == 0 ? _mm_add_epi32(e_cur, w[0]) : _mm_sha1nexte_epu32(e_cur, w[I % 4]);
+						e_nxt = abcd;
+						if(I >= 3 && I <= 18)
+							w[(I + 1) % 4] = _mm_sha1msg2_epu32(w[(I + 1) % 4], w[I % 4]);
+						abcd = _mm_sha1rnds4_epu32(abcd, e_cur, I / 5);
+						if(I >= 1 && I <= 16)
+							w[(I + 3) % 4] = _mm_sha1msg1_epu32(w[(I + 3) % 4], w[I % 4]);
+						if(I >= 2 && I <= 17)
+							w[(I + 2) % 4] = _mm_xor_si128(w[(I + 2) % 4], w[I % 4]);
+					}
+
+					static void compress_block(state_type& state, const uint8_t block[64]) {
+
+						// schedule => w
+						std::array<uint32_t, 80> schedule;
+
+						//  break chunk into sixteen 32-bit big-endian words w[i], 0 ≤ i ≤ 15
+						for(size_t i = 0; i < 16; i++)
+							schedule[i] = _load_be<uint32_t>(&block[i * sizeof(uint32_t)]);
+
+						// Extend the sixteen 32-bit words into eighty 32-bit words:
+						for(size_t i = 16; i < 80; i++)
+							schedule[i] = _rotrl(schedule[i - 3] ^ schedule[i - 8] ^ schedule[i - 14] ^ schedule[i - 16], 1);
+
+						std::array<uint32_t, 5> hbuff = state;
+
+						// main loop
+						for(size_t i = 0; i < 4; i++) {
+							roundfn_0_20<0, 1, 2, 3, 4>(hbuff, schedule[i * 5 + 0]);
+							roundfn_0_20<4, 0, 1, 2, 3>(hbuff, schedule[i * 5 + 1]);
+							roundfn_0_20<3, 4, 0, 1, 2>(hbuff, schedule[i * 5 + 2]);
+							roundfn_0_20<2, 3, 4, 0, 1>(hbuff, schedule[i * 5 + 3]);
+							roundfn_0_20<1, 2, 3, 4, 0>(hbuff, schedule[i * 5 + 4]);
+						}
+						for(size_t i = 4; i < 8; i++) {
+							roundfn_20_40<0, 1, 2, 3, 4>(hbuff, schedule[i * 5 + 0]);
+							roundfn_20_40<4, 0, 1, 2, 3>(hbuff, schedule[i * 5 + 1]);
+							roundfn_20_40<3, 4, 0, 1, 2>(hbuff, schedule[i * 5 + 2]);
+							roundfn_20_40<2, 3, 4, 0, 1>(hbuff, schedule[i * 5 + 3]);
+							roundfn_20_40<1, 2, 3, 4, 0>(hbuff, schedule[i * 5 + 4]);
+						}
+						for(size_t i = 8; i < 12; i++) {
+							roundfn_40_60<0, 1, 2, 3, 4>(hbuff, schedule[i * 5 + 0]);
+							roundfn_40_60<4, 0, 1, 2, 3>(hbuff, schedule[i * 5 + 1]);
+							roundfn_40_60<3, 4, 0, 1, 2>(hbuff, schedule[i * 5 + 2]);
+							roundfn_40_60<2, 3, 4, 0, 1>(hbuff, schedule[i * 5 + 3]);
+							roundfn_40_60<1, 2, 3, 4, 0>(hbuff, schedule[i * 5 + 4]);
+						}
+						for(size_t i = 12; i < 16; i++) {
+							roundfn_60_80<0, 1, 2, 3, 4>(hbuff, schedule[i * 5 + 0]);
+							roundfn_60_80<4, 0, 1, 2, 3>(hbuff, schedule[i * 5 + 1]);
+							roundfn_60_80<3, 4, 0, 1, 2>(hbuff, schedule[i * 5 + 2]);
+							roundfn_60_80<2, 3, 4, 0, 1>(hbuff, schedule[i * 5 + 3]);
+							roundfn_60_80<1, 2, 3, 4, 0>(hbuff, schedule[i * 5 + 4]);
+						}
+
+						for(size_t i = 0; i < 5; i++)
+							state[i] += hbuff[i];
+
+					}
+
+					// compress_block() as straight-line code, schedule word I and round I per pack element
+					template<size_t... Is>
+					__NEO_SHA_INLINE static void compress_unrolled(state_type& state, const uint8_t* block, index<Is...>) {
+
+						std::array<uint32_t, 80> w;
+						std::array<uint32_t, 5> hbuff = state;
+
+						int expand[] = {(w[Is] = word<Is>(w, block), 0)...};
+						int rounds[] = {(round<Is>(hbuff, w[Is]), 0)...};
+						(void)expand;
+						(void)rounds;
+
+						for(size_t i = 0; i < 5; i++)
+							state[i] += hbuff[i];
+					}
+					template<size_t I>
+					__NEO_SHA_INLINE static uint32_t word(const std::array<uint32_t, 80>& w, const uint8_t* block) {
+						return I < 16 ? _load_be<uint32_t>(&block[I % 16 * 4]) : _rotrl(w[(I + 77) % 80] ^ w[(I + 72) % 80] ^ w[(I + 66) % 80] ^ w[(I + 64) % 80], 1);
+					}
+					template<size_t I>
+					__NEO_SHA_INLINE static void round(std::array<uint32_t, 5>& st, uint32_t w) {
+						I < 20 ? roundfn_0_20<(5 - I % 5) % 5, (6 - I % 5) % 5, (7 - I % 5) % 5, (8 - I % 5) % 5, (9 - I % 5) % 5>(st, w)
+						: I < 40 ? roundfn_20_40<(5 - I % 5) % 5, (6 - I % 5) % 5, (7 - I % 5) % 5, (8 - I % 5) % 5, (9 - I % 5) % 5>(st, w)
+						: I < 60 ? roundfn_40_60<(5 - I % 5) % 5, (6 - I % 5) % 5, (7 - I % 5) % 5, (8 - I % 5) % 5, (9 - I % 5) % 5>(st, w)
+						: roundfn_60_80<(5 - I % 5) % 5, (6 - I % 5) % 5, (7 - I % 5) % 5, (8 - I % 5) % 5, (9 - I % 5) % 5>(st, w);
+					}
+
+					template<size_t a, size_t b, size_t c, size_t d, size_t e>
+					__NEO_SHA_INLINE static void roundfn_0_20(std::array<uint32_t, 5>& st, uint32_t w) {
+						roundfn_shared<a, b, c, d, e>(st, (st[b] & st[c]) | (~st[b] & st[d]), 0x5A827999, w);
+					}
+					template<size_t a, size_t b, size_t c, size_t d, size_t e>
+					__NEO_SHA_INLINE static void roundfn_20_40(std::array<uint32_t, 5>& st, uint32_t w) {
+						roundfn_shared<a, b, c, d, e>(st, st[b] ^ st[c] ^ st[d], 0x6ED9EBA1, w);
+					}
+					template<size_t a, size_t b, size_t c, size_t d, size_t e>
+					__NEO_SHA_INLINE static void roundfn_40_60(std::array<uint32_t, 5>& st, uint32_t w) {
+						roundfn_shared<a, b, c, d, e>(st, (st[b] & st[c]) | (st[b] & st[d]) | (st[c] & st[d]), 0x8F1BBCDC, w);
+					}
+					template<size_t a, size_t b, size_t c, size_t d, size_t e>
+					__NEO_SHA_INLINE static void roundfn_60_80(std::array<uint32_t, 5>& st, uint32_t w) {
+						roundfn_shared<a, b, c, d, e>(st, st[b] ^ st[c] ^ st[d], 0xCA62C1D6, w);
+					}
+					template<size_t a, size_t b, size_t c, size_t d, size_t e>
+					__NEO_SHA_INLINE static void roundfn_shared(std::array<uint32_t, 5>& st, uint32_t f, uint32_t k, uint32_t w) {
+						st[e] = _rotrl(st[a], 5) + f + st[e] + k + w;
+						st[b] = _rotrl(st[b], 30);
+					}
+
+				};
+
+				#ifdef __NEO_SHA_CONSTEXPR
+				// plain sha1 for constant evaluation, the runtime goes through _sha1_base
+				struct _sha1_const {
+
+					static constexpr uint32_t rotl(uint32_t x, int sh) {
+						return (x << sh) | (x >> (32 - sh));
+					}
+
+					static constexpr sha_t<160> hash(const char* msg, size_t len) {
+
+						uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+						size_t total = (len + 8) / 64 * 64 + 64;
+
+						for(size_t blk = 0; blk < total; blk += 64) {
+
+							uint32_t w[80] = {};
+							for(size_t i = 0; i < 16; i++)
+								for(size_t j = 0; j < 4; j++)
+									w[i] = (w[i] << 8) | _md_padded(msg, len, total, blk + i * 4 + j);
+							for(size_t i = 16; i < 80; i++)
+								w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+							uint32_t s[5] = {h[0], h[1], h[2], h[3], h[4]};
+							for(size_t i = 0; i < 80; i++) {
+								uint32_t f = i < 20 ? ((s[1] & s[2]) | (~s[1] & s[3])) + 0x5A827999
+										   : i < 40 ? (s[1] ^ s[2] ^ s[3]) + 0x6ED9EBA1
+										   : i < 60 ? ((s[1] & s[2]) | (s[1] & s[3]) | (s[2] & s[3])) + 0x8F1BBCDC
+										   : (s[1] ^ s[2] ^ s[3]) + 0xCA62C1D6;
+								uint32_t t = rotl(s[0], 5) + f + s[4] + w[i];
+								s[4] = s[3];
+								s[3] = s[2];
+								s[2] = rotl(s[1], 30);
+								s[1] = s[0];
+								s[0] = t;
+							}
+
+							for(size_t i = 0; i < 5; i++)
+								h[i] += s[i];
+						}
+
+						_cbytes<20> out = {};
+						for(size_t i = 0; i < 20; i++)
+							out.v[i] = static_cast<uint8_t>(h[i / 4] >> (24 - (i % 4) * 8));
+
+						return sha_t<160>(out, gen_seq<20>());
+					}
+
+				};
+				#endif
+
+			}
+			namespace __sha2 {
+
+				using namespace neo::hash::__sha_details::__shared;
+
+				template<class T, size_t Bits>
+				constexpr std::array<T, 8> init_hash() {
+					throw "Base method called";
+				}
+				template<> constexpr std::array<uint32_t, 8> init_hash<uint32_t, 224>() { // sha224
+					return {
+						0xC1059ED8, 0x367CD507, 0x3070DD17, 0xF70E5939,
+						0xFFC00B31, 0x68581511, 0x64F98FA7, 0xBEFA4FA4
+					};
+				};
+				template<> constexpr std::array<uint32_t, 8> init_hash<uint32_t, 256>() { // sha256
+					return {
+						0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+						0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+					};
+				};
+				template<> constexpr std::array<uint64_t, 8> init_hash<uint64_t, 384>() { // sha384
+					return {
+						0xCBBB9D5DC1059ED8, 0x629A292A367CD507, 0x9159015A3070DD17, 0x152FECD8F70E5939,
+						0x67332667FFC00B31, 0x8EB44A8768581511, 0xDB0C2E0D64F98FA7, 0x47B5481DBEFA4FA4
+					};
+				}
+				template<> constexpr std::array<uint64_t, 8> init_hash<uint64_t, 512>() { // sha512
+					return {
+						0x6A09E667F3BCC908, 0xBB67AE8584CAA73B, 0x3C6EF372FE94F82B, 0xA54FF53A5F1D36F1,
+						0x510E527FADE682D1, 0x9B05688C2B3E6C1F, 0x1F83D9ABFB41BD6B, 0x5BE0CD19137E2179
+					};
+				}
+				template<> constexpr std::array<uint64_t, 8> init_hash<uint64_t, 224>() { // sha512/224
+					return {
+						0x8C3D37C819544DA2, 0x73E1996689DCD4D6, 0x1DFAB7AE32FF9C82, 0x679DD514582F9FCF,
+						0x0F6D2B697BD44DA8, 0x77E36F7304C48942, 0x3F9D85A86A1D36C8, 0x1112E6AD91D692A1
+					};
+				}
+				template<> constexpr std::array<uint64_t, 8> init_hash<uint64_t, 256>() { // sha512/256
+					return {
+						0x22312194FC2BF72C, 0x9F555FA3C84C64C2, 0x2393B86B6F53B151, 0x963877195940EABD,
+						0x96283EE2A88EFFE3, 0xBE5E1E2553863992, 0x2B0199FC2C85B8AA, 0x0EB72DDC81C52CA2
+					};
+				}
+
+				template<class T, size_t N>
+				constexpr std::array<T, N> get_round_table() {
+					throw "Base method called";
+				}
+				template<> constexpr std::array<uint32_t, 64> get_round_table<uint32_t, 64>() { // sha224/256
+					return {
+						0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+						0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+						0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+						0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+						0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+						0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+						0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+						0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+					};
+				}
+				template<> constexpr std::array<uint64_t, 80> get_round_table<uint64_t, 80>() { // sha384/512
+					return {
+						0x428A2F98D728AE22, 0x7137449123EF65CD, 0xB5C0FBCFEC4D3B2F, 0xE9B5DBA58189DBBC, 0x3956C25BF348B538,	0x59F111F1B605D019, 0x923F82A4AF194F9B, 0xAB1C5ED5DA6D8118,
+						0xD807AA98A3030242, 0x12835B0145706FBE,	0x243185BE4EE4B28C, 0x550C7DC3D5FFB4E2, 0x72BE5D74F27B896F, 0x80DEB1FE3B1696B1, 0x9BDC06A725C71235,	0xC19BF174CF692694,
+						0xE49B69C19EF14AD2, 0xEFBE4786384F25E3, 0x0FC19DC68B8CD5B5, 0x240CA1CC77AC9C65, 0x2DE92C6F592B0275, 0x4A7484AA6EA6E483, 0x5CB0A9DCBD41FBD4, 0x76F988DA831153B5,
+						0x983E5152EE66DFAB, 0xA831C66D2DB43210, 0xB00327C898FB213F, 0xBF597FC7BEEF0EE4, 0xC6E00BF33DA88FC2, 0xD5A79147930AA725, 0x06CA6351E003826F, 0x142929670A0E6E70,
+						0x27B70A8546D22FFC, 0x2E1B21385C26C926, 0x4D2C6DFC5AC42AED, 0x53380D139D95B3DF, 0x650A73548BAF63DE, 0x766A0ABB3C77B2A8, 0x81C2C92E47EDAEE6, 0x92722C851482353B,
+						0xA2BFE8A14CF10364, 0xA81A664BBC423001, 0xC24B8B70D0F89791, 0xC76C51A30654BE30, 0xD192E819D6EF5218, 0xD69906245565A910, 0xF40E35855771202A, 0x106AA07032BBD1B8,
+						0x19A4C116B8D2D0C8, 0x1E376C085141AB53, 0x2748774CDF8EEB99, 0x34B0BCB5E19B48A8, 0x391C0CB3C5C95A63, 0x4ED8AA4AE3418ACB, 0x5B9CCA4F7763E373, 0x682E6FF3D6B2B8A3,
+						0x748F82EE5DEFB2FC, 0x78A5636F43172F60, 0x84C87814A1F0AB72, 0x8CC702081A6439EC, 0x90BEFFFA23631E28, 0xA4506CEBDE82BDE9, 0xBEF9A3F7B2C67915, 0xC67178F2E372532B,
+						0xCA273ECEEA26619C, 0xD186B8C721C0C207, 0xEADA7DD6CDE0EB1E, 0xF57D4F7FEE6ED178, 0x06F067AA72176FBA, 0x0A637DC5A2C898A6, 0x113F9804BEF90DAE, 0x1B710B35131C471B,
+						0x28DB77F523047D84, 0x32CAAB7B40C72493, 0x3C9EBE0A15C9BEBC, 0x431D67C49C100D4C, 0x4CC5D4BECB3E42B6, 0x597F299CFC657E2A, 0x5FCB6FAB3AD6FAEC, 0x6C44198C4A475817
+					};
+				}
+
+				template<class T>
+				constexpr std::array<int, 12> unique_vals() {
+					throw "Base method called";
+				}
+				template<> constexpr std::array<int, 12> unique_vals<uint32_t>() {
+					return {
+						7, 18, 3, 17, 19, 10,
+						6, 11, 25, 2, 13, 22
+					};
+				}
+				template<> constexpr std::array<int, 12> unique_vals<uint64_t>() {
+					return {
+						1, 8, 7, 19, 61, 6,
+						14, 18, 41, 28, 34, 39
+					};
+				}
+
+				// accelerated compress kernels, specialized per word type
+				template<class T>
+				struct _sha2_accel {
+					typedef void (*compress_fn)(std::array<T, 8>&, const uint8_t*, size_t);
+					static _kernel<compress_fn> select(backend b) {
+						return {nullptr, b};
+					}
+				};
+
+				template<>
+				struct _sha2_accel<uint32_t> {
+
+					typedef void (*compress_fn)(std::array<uint32_t, 8>&, const uint8_t*, size_t);
+
+					static _kernel<compress_fn> select(backend b) {
+						if((b == backend::automatic || b == backend::sha_ni) && cpu().sha && cpu().sse41)
+							return {compress_ni, backend::sha_ni};
+						return {nullptr, b};
+					}
+
+					__NEO_SHA_TARGET("sha,sse4.1")
+					static void compress_ni(std::array<uint32_t, 8>& state, const uint8_t* blocks, size_t count) {
+
+						const __m128i mask = _mm_set_epi64x(0x0C0D0E0F08090A0BULL, 0x0405060700010203ULL);
+
+						// sha256rnds2 works on the {a, b, e, f} / {c, d, g, h} halves
+						__m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0])), 0xB1);
+						__m128i s1  = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4])), 0x1B);
+						__m128i s0  = _mm_alignr_epi8(tmp, s1, 8);
+						s1 = _mm_blend_epi16(s1, tmp, 0xF0);
+
+						__m128i w[4];
+
+						for(size_t i = 0; i < count; i++) {
+
+							const uint8_t* block = &blocks[i * 64];
+							__m128i s0_save = s0;
+							__m128i s1_save = s1;
+
+							quad_ni<0>(block, mask, s0, s1, w);  quad_ni<1>(block, mask, s0, s1, w);
+							quad_ni<2>(block, mask, s0, s1, w);  quad_ni<3>(block, mask, s0, s1, w);
+							quad_ni<4>(block, mask, s0, s1, w);  quad_ni<5>(block, mask, s0, s1, w);
+							quad_ni<6>(block, mask, s0, s1, w);  quad_ni<7>(block, mask, s0, s1, w);
+							quad_ni<8>(block, mask, s0, s1, w);  quad_ni<9>(block, mask, s0, s1, w);
+							quad_ni<10>(block, mask, s0, s1, w); quad_ni<11>(block, mask, s0, s1, w);
+							quad_ni<12>(block, mask, s0, s1, w); quad_ni<13>(block, mask, s0, s1, w);
+							quad_ni<14>(block, mask, s0, s1, w); quad_ni<15>(block, mask, s0, s1, w);
+
+							s0 = _mm_add_epi32(s0, s0_save);
+							s1 = _mm_add_epi32(s1, s1_save);
+						}
+
+						tmp = _mm_shuffle_epi32(s0, 0x1B);
+						s1  = _mm_shuffle_epi32(s1, 0xB1);
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), _mm_blend_epi16(tmp, s1, 0xF0));
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), _mm_alignr_epi8(s1, tmp, 8));
+					}
+
+					// rounds [I * 4, I * 4 + 4), the schedule of quad Q is built by msg1 at Q - 3 and msg2 at Q - 1
+					template<int I>
+					__NEO_SHA_TARGET("sha,sse4.1")
+					inline static void quad_ni(const uint8_t* block, __m128i mask, __m128i& s0, __m128i& s1, __m128i (&w)[4]) {
+
+						static constexpr std::array<uint32_t, 64> round_table = get_round_table<uint32_t, 64>();
+
+						if(I < 4)
+							w[I] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&block[I * 16])), mask);
+
+						__m128i msg = _mm_add_epi32(w[I % 4], _mm_loadu_si128(reinterpret_cast<const __m128i*>(&round_table[I * 4])));
+						s1 = _mm_sha256rnds2_epu32(s1, s0, msg);
+						s0 = _mm_sha256rnds2_epu32(s0, s1, _mm_shuffle_epi32(msg, 0x0E));
+
+						if(I >= 3 && I <= 14)
+							w[(I + 1) % 4] = _mm_sha256msg2_epu32(_mm_add_epi32(w[(I + 1) % 4], _mm_alignr_epi8(w[I % 4], w[(I + 3) % 4], 4)), w[I % 4]);
+						if(I >= 1 && I <= 12)
+							w[(I + 3) % 4] = _mm_sha256msg1_epu32(w[(I + 3) % 4], w[I % 4]);
+					}
+
+				};
+
+				#ifdef __NEO_SHA_VECTORS
+				// sha384/512 on a single stream: the rounds stay scalar on immediate rotates (rorx with bmi2), the schedule is expanded two
+				// words per vector op (vprorq with avx512vl) 16 words ahead of the rounds reading it, so both run side by side
+				template<>
+				struct _sha2_accel<uint64_t> {
+
+					typedef void (*compress_fn)(std::array<uint64_t, 8>&, const uint8_t*, size_t);
+
+					static _kernel<compress_fn> select(backend b) {
+						if((b == backend::automatic || b == backend::avx512) && cpu().avx512f && cpu().avx512vl && cpu().bmi2)
+							return {compress_avx512, backend::avx512};
+						if((b == backend::automatic || b == backend::avx2) && cpu().avx2 && cpu().bmi2)
+							return {compress_avx2, backend::avx2};
+						return {nullptr, b};
+					}
+
+					__NEO_SHA_TARGET("avx2,bmi2")
+					static void compress_avx2(std::array<uint64_t, 8>& state, const uint8_t* blocks, size_t count) {
+						compress_vec(state, blocks, count);
+					}
+					__NEO_SHA_TARGET("avx512f,avx512vl,bmi2")
+					static void compress_avx512(std::array<uint64_t, 8>& state, const uint8_t* blocks, size_t count) {
+						compress_vec(state, blocks, count);
+					}
+
+					__NEO_SHA_INLINE static void compress_vec(std::array<uint64_t, 8>& state, const uint8_t* blocks, size_t count) {
+
+						static constexpr std::array<uint64_t, 80> round_table = get_round_table<uint64_t, 80>();
+
+						for(size_t n = 0; n < count; n++) {
+
+							// w[j] holds the words 2j, 2j + 1 of the rolling 16 word window, wk the w + k read by the rounds
+							_u64x2 w[8], k;
+							uint64_t wk[80];
+							for(size_t i = 0; i < 16; i++)
+								wk[i] = _load_be<uint64_t>(&blocks[n * 128 + i * 8]);
+							std::memcpy(w, wk, sizeof(w));
+							for(size_t j = 0; j < 8; j++) {
+								std::memcpy(&k, &round_table[j * 2], sizeof(k));
+								k += w[j];
+								std::memcpy(&wk[j * 2], &k, sizeof(k));
+							}
+
+							std::array<uint64_t, 8> st = state;
+							for(size_t i = 0; i < 64; i += 16)
+								rounds16<true>(st, w, &wk[i], &round_table[i + 16]);
+							rounds16<false>(st, w, &wk[64], nullptr);
+
+							for(size_t i = 0; i < 8; i++)
+								state[i] += st[i];
+						}
+					}
+
+					// 16 rounds on wk[0, 16), expanding the next 16 words into wk[16, 32) with their round constants from k
+					template<bool Expand>
+					__NEO_SHA_INLINE static void rounds16(std::array<uint64_t, 8>& st, _u64x2 (&w)[8], uint64_t* wk, const uint64_t* k) {
+						pair<0, Expand>(st, w, wk, k); pair<1, Expand>(st, w, wk, k);
+						pair<2, Expand>(st, w, wk, k); pair<3, Expand>(st, w, wk, k);
+						pair<4, Expand>(st, w, wk, k); pair<5, Expand>(st, w, wk, k);
+						pair<6, Expand>(st, w, wk, k); pair<7, Expand>(st, w, wk, k);
+					}
+
+					// rounds 2J and 2J + 1, then the words 2J + 16 and 2J + 17 of the schedule replace those of w[J]
+					template<size_t J, bool Expand>
+					__NEO_SHA_INLINE static void pair(std::array<uint64_t, 8>& st, _u64x2 (&w)[8], uint64_t* wk, const uint64_t* k) {
+						round<J * 2>(st, wk[J * 2]);
+						round<J * 2 + 1>(st, wk[J * 2 + 1]);
+						if(Expand) {
+							_u64x2 w15, w7, s0, s1, kv;
+							_valign(w15, w[J], w[(J + 1) % 8]);
+							_valign(w7, w[(J + 4) % 8], w[(J + 5) % 8]);
+							_vsigma<true>(s0, w15, 1, 8, 7);
+							_vsigma<true>(s1, w[(J + 7) % 8], 19, 61, 6);
+							w[J] += s0 + w7 + s1;
+							std::memcpy(&kv, &k[J * 2], sizeof(kv));
+							kv += w[J];
+							std::memcpy(&wk[J * 2 + 16], &kv, sizeof(kv));
+						}
+					}
+
+					// round R % 8 of the usual a..h rotation, with the choose and majority functions in their 3 op forms
+					template<size_t R>
+					__NEO_SHA_INLINE static void round(std::array<uint64_t, 8>& st, uint64_t wk) {
+						const size_t a = (16 - R) % 8, b = (17 - R) % 8, c = (18 - R) % 8, d = (19 - R) % 8;
+						const size_t e = (20 - R) % 8, f = (21 - R) % 8, g = (22 - R) % 8, h = (23 - R) % 8;
+						uint64_t tmp = st[h] + (_rotrr(st[e], 14) ^ _rotrr(st[e], 18) ^ _rotrr(st[e], 41)) + (st[g] ^ (st[e] & (st[f] ^ st[g]))) + wk;
+						st[d] += tmp;
+						st[h] = tmp + (_rotrr(st[a], 28) ^ _rotrr(st[a], 34) ^ _rotrr(st[a], 39)) + ((st[a] & st[b]) ^ (st[c] & (st[a] ^ st[b])));
+					}
+
+				};
+				#endif
+
+				// compress function shared by every digest size of a word type (the sha224/256 and sha384/512 families)
+				template<class T, size_t Rounds, size_t Blk>
+				struct _sha2_compress {
+
+					typedef std::array<T, 8> state_type;
+					typedef void (*compress_fn)(state_type&, const uint8_t*, size_t);
+
+					static constexpr std::array<int, 12> seq = unique_vals<T>();
+
+					static constexpr stats_algorithm stats_id() {
+						return sizeof(T) == 4 ? stats_algorithm::sha2_256 : stats_algorithm::sha2_512;
+					}
+
+					static void compress(state_type& state, const uint8_t* blocks, size_t count = 1) {
+						__NEO_SHA_COUNT(stats_id(), count);
+						kernel().fn(state, blocks, count);
+					}
+
+					static _kernel<compress_fn> kernel() {
+						return kernel_slot().get();
+					}
+					static _kernel_slot<compress_fn>& kernel_slot() {
+						static _kernel_slot<compress_fn> slot(select);
+						return slot;
+					}
+					static _kernel<compress_fn> select(backend b) {
+						_kernel<compress_fn> k = _sha2_accel<T>::select(b);
+						if(k.fn)
+							return k;
+						if(b == backend::automatic || b == backend::scalar)
+							return {compress_scalar, backend::scalar};
+						return {nullptr, b};
+					}
+					static bool set_backend(backend b) {
+						_kernel<compress_fn> k = select(b);
+						if(!k.fn)
+							return false;
+						kernel_slot().set(k.id);
+						return true;
+					}
+
+					static void compress_scalar(state_type& state, const uint8_t* blocks, size_t count) {
+						for(size_t i = 0; i < count; i++)
+							compress_block(state, &blocks[i * Blk]);
+					}
+
+					// the padded tail of a fixed length message (see _sha2_base::compress_tail()), inlined into the caller so the scalar
+					// rounds see the padding and length words as constants
+					template<size_t Count>
+					__NEO_SHA_INLINE static void compress_padded(state_type& state, const uint8_t* blocks) {
+						if(kernel().fn != compress_scalar)
+							return compress(state, blocks, Count);
+						__NEO_SHA_COUNT(stats_id(), Count);
+						for(size_t i = 0; i < Count; i++)
+							compress_unrolled(state, &blocks[i * Blk], gen_seq<Rounds>());
+					}
+
+					// multi-buffer compress: state is 8 words x lanes (word major), one block per lane
+					typedef void (*lanes_fn)(T* state, const uint8_t* const* blocks);
+
+					static constexpr size_t max_lanes = 64 / sizeof(T);
+
+					static _kernel<lanes_fn> batch_kernel() {
+						return batch_slot().get();
+					}
+					static _kernel_slot<lanes_fn>& batch_slot() {
+						static _kernel_slot<lanes_fn> slot(select_batch);
+						return slot;
+					}
+					// a null fn (backend::scalar) hashes one message at a time through compress(), backend::automatic flags an unsupported pick
+					static _kernel<lanes_fn> select_batch(backend b) {
+						#ifdef __NEO_SHA_VECTORS
+						// a single sha_ni stream outruns 8 avx2 lanes (about 2x) and keeps up with 16 avx512 lanes (0.9x to 1.1x from 32 byte
+						// to 16 KiB messages, one core), so the automatic pick only goes multi-lane for sha256 without sha_ni
+						bool ni = sizeof(T) == 4 && cpu().sha && cpu().sse41;
+						if(((b == backend::automatic && !ni) || b == backend::avx512) && cpu().avx512f)
+							return {compress_lanes_avx512, backend::avx512};
+						if(((b == backend::automatic && !ni) || b == backend::avx2) && cpu().avx2)
+							return {compress_lanes_avx2, backend::avx2};
+						#endif
+						return {nullptr, b == backend::automatic || b == backend::scalar ? backend::scalar : backend::automatic};
+					}
+					static bool set_batch_backend(backend b) {
+						_kernel<lanes_fn> k = select_batch(b);
+						if(k.id == backend::automatic)
+							return false;
+						batch_slot().set(k.id);
+						return true;
+					}
+					static backend active_batch_backend() {
+						const _kernel<lanes_fn> k = batch_kernel();
+						return k.fn ? k.id : kernel().id;
+					}
+					static size_t batch_lanes(backend b) {
+						return b == backend::avx512 ? 64 / sizeof(T) : b == backend::avx2 ? 32 / sizeof(T) : 1;
+					}
+
+					#ifdef __NEO_SHA_VECTORS
+					__NEO_SHA_TARGET("avx2")
+					static void compress_lanes_avx2(T* state, const uint8_t* const* blocks) {
+						compress_lanes<typename std::conditional<sizeof(T) == 4, _u32x8, _u64x4>::type>(state, blocks);
+					}
+					__NEO_SHA_TARGET("avx512f")
+					static void compress_lanes_avx512(T* state, const uint8_t* const* blocks) {
+						compress_lanes<typename std::conditional<sizeof(T) == 4, _u32x16, _u64x8>::type>(state, blocks);
+					}
+
+					// same rounds as compress_block() with every operation applied to all the lanes of R
+					template<class R>
+					__NEO_SHA_INLINE static void compress_lanes(T* state, const uint8_t* const* blocks) {
+
+						static constexpr size_t lanes = sizeof(R) / sizeof(T);
+						static constexpr std::array<T, Rounds> round_table = get_round_table<T, Rounds>();
+
+						R st[8], hbuff[8], w[16];
+						std::memcpy(st, state, sizeof(st));
+
+						// transpose the blocks through memory, inserting words into vector registers one by one is far slower
+						T words[16][lanes];
+						for(size_t l = 0; l < lanes; l++)
+							for(size_t i = 0; i < 16; i++)
+								words[i][l] = _load_be<T>(&blocks[l][i * sizeof(T)]);
+						std::memcpy(w, words, sizeof(w));
+
+						for(size_t i = 0; i < 8; i++)
+							hbuff[i] = st[i];
+
+						for(size_t i = 0; i < Rounds / 8; i++) {
+							round_lanes<0, 1, 2, 3, 4, 5, 6, 7>(hbuff, w, i * 8 + 0, round_table[i * 8 + 0]);
+							round_lanes<7, 0, 1, 2, 3, 4, 5, 6>(hbuff, w, i * 8 + 1, round_table[i * 8 + 1]);
+							round_lanes<6, 7, 0, 1, 2, 3, 4, 5>(hbuff, w, i * 8 + 2, round_table[i * 8 + 2]);
+							round_lanes<5, 6, 7, 0, 1, 2, 3, 4>(hbuff, w, i * 8 + 3, round_table[i * 8 + 3]);
+							round_lanes<4, 5, 6, 7, 0, 1, 2, 3>(hbuff, w, i * 8 + 4, round_table[i * 8 + 4]);
+							round_lanes<3, 4, 5, 6, 7, 0, 1, 2>(hbuff, w, i * 8 + 5, round_table[i * 8 + 5]);
+							round_lanes<2, 3, 4, 5, 6, 7, 0, 1>(hbuff, w, i * 8 + 6, round_table[i * 8 + 6]);
+							round_lanes<1, 2, 3, 4, 5, 6, 7, 0>(hbuff, w, i * 8 + 7, round_table[i * 8 + 7]);
+						}
+
+						for(size_t i = 0; i < 8; i++)
+							st[i] += hbuff[i];
+						std::memcpy(state, st, sizeof(st));
+					}
+
+					// the schedule is expanded on the fly over a rolling window of 16 words
+					template<size_t a, size_t b, size_t c, size_t d, size_t e, size_t f, size_t g, size_t h, class R>
+					__NEO_SHA_INLINE static void round_lanes(R (&st)[8], R (&w)[16], size_t i, T k) {
+						R s0, s1;
+						if(i >= 16) {
+							_vsigma<true>(s0, w[(i - 15) % 16], seq[0], seq[1], seq[2]);
+							_vsigma<true>(s1, w[(i - 2) % 16], seq[3], seq[4], seq[5]);
+							w[i % 16] += w[(i - 7) % 16] + s0 + s1;
+						}
+						_vsigma<false>(s1, st[e], seq[6], seq[7], seq[8]);
+						_vsigma<false>(s0, st[a], seq[9], seq[10], seq[11]);
+						R tmp = s1 + ((st[e] & st[f]) ^ (~st[e] & st[g])) + w[i % 16] + k;
+						st[d] += tmp + st[h];
+						st[h] += tmp + s0 + ((st[a] & st[b]) ^ (st[a] & st[c]) ^ (st[b] & st[c]));
+					}
+					#endif
+
+					static void compress_block(state_type& state, const uint8_t block[Blk]) {
+
+						// round_table => k
+						static constexpr std::array<T, Rounds> round_table = get_round_table<T, Rounds>();
+
+						// schedule => w
+						std::array<T, Rounds> schedule;
+
+						// copy chunk into first 16 words w[0,16) of the message schedule array, big-endian encoding
+						for(size_t i = 0; i < 16; i++)
+							schedule[i] = _load_be<T>(&block[i * sizeof(T)]);
+
+						// first 16 words expansion to [16,64/80)
+						for(size_t i = 16; i < Rounds; i++)
+							schedule[i] = schedule[i - 16] + schedule[i - 7]
+							+ (_rotrr(schedule[i - 15], seq[0]) ^ _rotrr(schedule[i - 15], seq[1]) ^ (schedule[i - 15] >> seq[2]))
+							+ (_rotrr(schedule[i - 2], seq[3]) ^ _rotrr(schedule[i - 2], seq[4]) ^ (schedule[i - 2] >> seq[5]));
+
+						std::array<T, 8> hbuff = state;
+
+						// main compression loop (64/80 rounds)
+						for(size_t i = 0; i < Rounds / 8; i++) {
+							round_fn<0, 1, 2, 3, 4, 5, 6, 7>(hbuff, schedule[i * 8 + 0], round_table[i * 8 + 0]);
+							round_fn<7, 0, 1, 2, 3, 4, 5, 6>(hbuff, schedule[i * 8 + 1], round_table[i * 8 + 1]);
+							round_fn<6, 7, 0, 1, 2, 3, 4, 5>(hbuff, schedule[i * 8 + 2], round_table[i * 8 + 2]);
+							round_fn<5, 6, 7, 0, 1, 2, 3, 4>(hbuff, schedule[i * 8 + 3], round_table[i * 8 + 3]);
+							round_fn<4, 5, 6, 7, 0, 1, 2, 3>(hbuff, schedule[i * 8 + 4], round_table[i * 8 + 4]);
+							round_fn<3, 4, 5, 6, 7, 0, 1, 2>(hbuff, schedule[i * 8 + 5], round_table[i * 8 + 5]);
+							round_fn<2, 3, 4, 5, 6, 7, 0, 1>(hbuff, schedule[i * 8 + 6], round_table[i * 8 + 6]);
+							round_fn<1, 2, 3, 4, 5, 6, 7, 0>(hbuff, schedule[i * 8 + 7], round_table[i * 8 + 7]);
+						}
+
+						for(size_t i = 0; i < 8; i++)
+							state[i] += hbuff[i];
+
+					}
+
+					// compress_block() as straight-line code, schedule word I and round I per pack element
+					template<size_t... Is>
+					__NEO_SHA_INLINE static void compress_unrolled(state_type& state, const uint8_t* block, index<Is...>) {
+
+						static constexpr std::array<T, Rounds> round_table = get_round_table<T, Rounds>();
+
+						std::array<T, Rounds> w;
+						std::array<T, 8> hbuff = state;
+
+						int expand[] = {(w[Is] = word<Is>(w, block), 0)...};
+						int rounds[] = {(round_fn<(8 - Is % 8) % 8, (9 - Is % 8) % 8, (10 - Is % 8) % 8, (11 - Is % 8) % 8,
+							(12 - Is % 8) % 8, (13 - Is % 8) % 8, (14 - Is % 8) % 8, (15 - Is % 8) % 8>(hbuff, w[Is], round_table[Is]), 0)...};
+						(void)expand;
+						(void)rounds;
+
+						for(size_t i = 0; i < 8; i++)
+							state[i] += hbuff[i];
+					}
+					template<size_t I>
+					__NEO_SHA_INLINE static T word(const std::array<T, Rounds>& w, const uint8_t* block) {
+						return I < 16 ? _load_be<T>(&block[I % 16 * sizeof(T)]) : w[(I + Rounds - 16) % Rounds] + w[(I + Rounds - 7) % Rounds]
+							+ (_rotrr(w[(I + Rounds - 15) % Rounds], seq[0]) ^ _rotrr(w[(I + Rounds - 15) % Rounds], seq[1]) ^ (w[(I + Rounds - 15) % Rounds] >> seq[2]))
+							+ (_rotrr(w[(I + Rounds - 2) % Rounds], seq[3]) ^ _rotrr(w[(I + Rounds - 2) % Rounds], seq[4]) ^ (w[(I + Rounds - 2) % Rounds] >> seq[5]));
+					}
+
+					template<size_t a, size_t b, size_t c, size_t d, size_t e, size_t f, size_t g, size_t h>
+					__NEO_SHA_INLINE static void round_fn(std::array<T, 8>& st, T w, T k) {
+						T tmp = (_rotrr(st[e], seq[6]) ^ _rotrr(st[e], seq[7]) ^ _rotrr(st[e], seq[8])) + ((st[e] & st[f]) ^ (~st[e] & st[g])) + w + k;
+						st[d] += tmp + st[h];
+						st[h] += tmp + (_rotrr(st[a], seq[9]) ^ _rotrr(st[a], seq[10]) ^ _rotrr(st[a], seq[11])) + ((st[a] & st[b]) ^ (st[a] & st[c]) ^ (st[b] & st[c]));
+					}
+
+				};
+
+				template<class T, size_t Rounds, size_t Blk>
+				constexpr std::array<int, 12> _sha2_compress<T, Rounds, Blk>::seq;
+
+				template<class T, size_t Bits, size_t Rounds, size_t Blk>
+				struct _sha2_base : _sha2_compress<T, Rounds, Blk> {
+
+					typedef std::array<T, 8> state_type;
+
+					using _sha2_compress<T, Rounds, Blk>::compress;
+
+					static constexpr size_t bits     = Bits;
+					static constexpr size_t blk_size = Blk;
+
+					static state_type init() {
+						return init_hash<T, Bits>();
+					}
+
+					static sha_t<Bits> hash(const uint8_t* msg, size_t len) {
+
+						state_type hash = init();
+
+						size_t off = len - len % Blk;
+						compress(hash, msg, len / Blk);
+
+						return finalize(hash, &msg[off], len - off, len);
+					}
+					static sha_t<Bits> finalize(state_type& hash, const uint8_t* tail, size_t lst, uint64_t len) {
+
+						std::array<uint8_t, Blk * 2> blocks;
+						compress(hash, blocks.data(), pad(blocks.data(), tail, lst, len));
+
+						return return_hash<Bits>(hash, gen_seq<Bits / 32>());
+					}
+					// blocks taken by a tail of lst bytes once padded, the bit length takes the last 2 words of the block (64 bits for
+					// sha224/256, 128 bits for sha384/512)
+					static constexpr size_t tail_blocks(size_t lst) {
+						return lst >= Blk - 2 * sizeof(T) ? 2 : 1;
+					}
+					// writes the last 1 or 2 blocks (message tail + padding + bit length) into out, returns the block count
+					static size_t pad(uint8_t* out, const uint8_t* tail, size_t lst, uint64_t len) {
+
+						size_t count = tail_blocks(lst);
+						uint8_t* last = &out[(count - 1) * Blk];
+
+						std::fill(out, out + count * Blk, 0);
+						std::copy(tail, tail + lst, out);
+						out[lst] = 0x80;
+
+						_store_be<uint64_t>(&last[Blk - 8], len << 3);
+						if(sizeof(T) == 8)
+							_store_be<uint64_t>(&last[Blk - 16], len >> 61);
+
+						return count;
+					}
+					// the last Lst bytes of a fixed length message (see _hash_fixed()), padded on the stack with constant offsets
+					template<size_t Lst>
+					__NEO_SHA_INLINE static void compress_tail(state_type& state, const uint8_t* tail, uint64_t len) {
+
+						static constexpr size_t count = tail_blocks(Lst);
+
+						uint8_t blocks[count * Blk];
+						pad(blocks, tail, Lst, len);
+						_sha2_base::template compress_padded<count>(state, blocks);
+					}
+
+					static sha_t<Bits> output(state_type& hash) {
+						return return_hash<Bits>(hash, gen_seq<Bits / 32>());
+					}
+
+					// batch plumbing for _hash_many()
+					typedef T word_type;
+					typedef typename _sha2_compress<T, Rounds, Blk>::lanes_fn lanes_fn;
+
+					static constexpr size_t state_words = 8;
+					static constexpr size_t max_lanes   = _sha2_compress<T, Rounds, Blk>::max_lanes;
+
+					static T& word(state_type& state, size_t i) {
+						return state[i];
+					}
+					static void run_lanes(lanes_fn fn, T* state, const uint8_t* const* blocks) {
+						__NEO_SHA_COUNT(_sha2_base::stats_id(), _sha2_base::batch_lanes(_sha2_base::batch_kernel().id));
+						fn(state, blocks);
+					}
+
+					// the active batch kernel (null for backend::scalar) and its lane count
+					static lanes_fn batch(size_t& lanes) {
+						typedef _sha2_compress<T, Rounds, Blk> family;
+						const _kernel<lanes_fn> k = family::batch_kernel();
+						lanes = family::batch_lanes(k.id);
+						return k.fn;
+					}
+
+					// hashes count independent messages, interleaved across the lanes of the batch kernel
+					static void hash_many(const buffer* msgs, size_t count, sha_t<Bits>* out) {
+						size_t lanes;
+						lanes_fn fn = batch(lanes);
+						_hash_many<_sha2_base>(msgs, count, out, output, fn, lanes);
+					}
+				};
+
+				// sha256(sha256(header)) over an 80 byte header ending in a little endian nonce (the bitcoin layout), for nonce scans:
+				// the first block is compressed once, the second starts 3 rounds in with the nonce added at round 3, its constant schedule
+				// words are precomputed and the padding words of both last blocks are folded at compile time; R holds one nonce per lane
+				class _sha256d_scan {
+
+					typedef _sha2_compress<uint32_t, 64, 64> family;
+					typedef std::array<uint32_t, 8> state_type;
+
+					public:
+
+						explicit _sha256d_scan(const uint8_t* header) {
+
+							static constexpr std::array<uint32_t, 64> k = get_round_table<uint32_t, 64>();
+
+							mid = init_hash<uint32_t, 256>();
+							family::compress(mid, header);
+							std::memcpy(tail, &header[64], 12);
+
+							uint32_t w[3];
+							for(size_t i = 0; i < 3; i++)
+								w[i] = _load_be<uint32_t>(&header[64 + i * 4]);
+
+							// rounds 0..2 only see header words
+							uint32_t s[8];
+							std::copy(mid.begin(), mid.end(), s);
+							for(size_t i = 0; i < 3; i++)
+								step(s, w[i] + k[i]);
+							std::copy(s, s + 8, mid3);
+
+							// round 3 without its nonce word: e = d + t1 + w3, a = t1 + t2 + w3
+							t1_3 = s[7] + (_rotrr(s[4], 6) ^ _rotrr(s[4], 11) ^ _rotrr(s[4], 25)) + ((s[4] & s[5]) ^ (~s[4] & s[6])) + k[3];
+							t2_3 = (_rotrr(s[0], 2) ^ _rotrr(s[0], 13) ^ _rotrr(s[0], 22)) + ((s[0] & s[1]) ^ (s[0] & s[2]) ^ (s[1] & s[2]));
+
+							// w16 and w17 are constant, w18 and w19 only miss their nonce terms
+							w16 = sigma0(w[1]) + w[0];
+							w17 = sigma1(fixed(2, 15)) + sigma0(w[2]) + w[1];
+							c18 = sigma1(w16) + w[2];
+							c19 = sigma1(w17) + sigma0(fixed(2, 4));
+						}
+
+						// digest words of each lane's nonce, nonce_be is the nonce as the big endian word it reads as
+						template<class R>
+						__NEO_SHA_INLINE void hash(const R& nonce_be, R (&out)[8]) const {
+
+							static constexpr std::array<uint32_t, 8> iv = init_hash<uint32_t, 256>();
+
+							R s[8], x[16];
+
+							// second block of the header, from round 3
+							for(size_t i = 0; i < 8; i++)
+								s[i] = R() + mid3[i];
+							R t1 = nonce_be + t1_3;
+							s[7] = s[6]; s[6] = s[5]; s[5] = s[4]; s[4] = s[3] + t1;
+							s[3] = s[2]; s[2] = s[1]; s[1] = s[0]; s[0] = t1 + t2_3;
+							x[3] = nonce_be;
+							rounds<2, 4>(s, x, gen_seq<60>());
+							for(size_t i = 0; i < 8; i++)
+								x[i] = s[i] + mid[i];
+
+							// the digest as one padded block
+							for(size_t i = 0; i < 8; i++)
+								s[i] = R() + iv[i];
+							rounds<3, 0>(s, x, gen_seq<64>());
+							for(size_t i = 0; i < 8; i++)
+								out[i] = s[i] + iv[i];
+						}
+
+						// full digest of one nonce, through the single buffer backend
+						sha_t<256> digest(uint32_t nonce) const {
+							uint8_t blk[64] = {};
+							std::memcpy(blk, tail, 12);
+							for(size_t i = 0; i < 4; i++)
+								blk[12 + i] = static_cast<uint8_t>(nonce >> (i * 8));
+							blk[16] = 0x80;
+							_store_be<uint64_t>(&blk[56], 640);
+							state_type st = mid;
+							family::compress(st, blk);
+							std::fill(blk, blk + 64, 0);
+							for(size_t i = 0; i < 8; i++)
+								_store_be<uint32_t>(&blk[i * 4], st[i]);
+							blk[32] = 0x80;
+							_store_be<uint64_t>(&blk[56], 256);
+							st = init_hash<uint32_t, 256>();
+							family::compress(st, blk);
+							return return_hash<256>(st, gen_seq<8>());
+						}
+
+						// nonces first .. first + count - 1 (wrapping, count capped at 2^32 so no nonce is seen twice) whose digest is below
+						// target, the max_matches (0: all) lowest offsets; chunks of nonces run on the shared pool, one chunk past the
+						// max_matches-th match so far is not started
+						static std::vector<nonce_match> scan(const uint8_t* header, uint32_t first, uint64_t count, const sha_t<256>& target, size_t max_matches) {
+
+							typedef void (*sweep_fn)(const _sha256d_scan&, uint32_t, size_t, uint32_t, std::vector<uint32_t>&);
+
+							const _sha256d_scan sc(header);
+							const auto bk = family::batch_kernel();
+							const backend batch = bk.fn ? bk.id : backend::scalar;
+							sweep_fn fn = sweep_scalar;
+							#ifdef __NEO_SHA_VECTORS
+							if(batch == backend::avx512)
+								fn = sweep_avx512;
+							else if(batch == backend::avx2)
+								fn = sweep_avx2;
+							#endif
+							if(batch == backend::scalar && family::kernel().id == backend::sha_ni)
+								fn = sweep_single;
+
+							const uint32_t t0 = _load_be<uint32_t>(target.data());
+							const auto by_offset = [first](const nonce_match& x, const nonce_match& y) {
+								return uint32_t(x.nonce - first) < uint32_t(y.nonce - first);
+							};
+							std::vector<nonce_match> found;
+							std::mutex mtx;
+							std::atomic<uint64_t> cutoff(~uint64_t(0));
+
+							count = std::min<uint64_t>(count, uint64_t(1) << 32);
+							const size_t grain = size_t(1) << 14;
+
+							const auto chunk = [&](size_t b, size_t e) {
+								if(b > cutoff.load(std::memory_order_relaxed))
+									return;
+								std::vector<uint32_t> hits;
+								{
+									// the second header block and the outer hash of every nonce
+									__NEO_SHA_COUNT(stats_algorithm::sha2_256, (e - b) * 2);
+									fn(sc, static_cast<uint32_t>(first + b), e - b, t0, hits);
+								}
+								std::vector<nonce_match> mine;
+								for(uint32_t n : hits) {
+									sha_t<256> d = sc.digest(n);
+									if(d < target)
+										mine.push_back({n, d});
+								}
+								if(mine.empty())
+									return;
+								std::sort(mine.begin(), mine.end(), by_offset);
+								std::lock_guard<std::mutex> lock(mtx);
+								size_t had = found.size();
+								found.insert(found.end(), mine.begin(), mine.end());
+								// with a limit found stays sorted and at most max_matches long, merged a chunk at a time; without one it's
+								// sorted once at the end
+								if(max_matches) {
+									std::inplace_merge(found.begin(), found.begin() + had, found.end(), by_offset);
+									if(found.size() >= max_matches) {
+										found.resize(max_matches);
+										cutoff = uint32_t(found.back().nonce - first);
+									}
+								}
+							};
+
+							// a range given whole (no workers, or called from one) still goes a grain at a time so the cutoff applies
+							_thread_pool::global().parallel_for(static_cast<size_t>(count), grain, [&](size_t b, size_t e) {
+								for(; b < e; b += grain)
+									chunk(b, std::min(b + grain, e));
+							});
+
+							if(!max_matches)
+								std::sort(found.begin(), found.end(), by_offset);
+							return found;
+						}
+
+					private:
+
+						// appends to hits the nonces whose first digest word is <= t0 (candidates, checked in full by scan())
+						template<class R>
+						__NEO_SHA_INLINE static void sweep(const _sha256d_scan& sc, uint32_t first, size_t n, uint32_t t0, std::vector<uint32_t>& hits) {
+							static constexpr size_t lanes = sizeof(R) / 4;
+							for(size_t b = 0; b < n; b += lanes) {
+								uint32_t words[lanes];
+								for(size_t l = 0; l < lanes; l++)
+									words[l] = _bswap(static_cast<uint32_t>(first + b + l));
+								R nonce, out[8];
+								std::memcpy(&nonce, words, sizeof(R));
+								sc.hash(nonce, out);
+								std::memcpy(words, &out[0], sizeof(R));
+								for(size_t l = 0; l < lanes && b + l < n; l++)
+									if(words[l] <= t0)
+										hits.push_back(static_cast<uint32_t>(first + b + l));
+							}
+						}
+						static void sweep_scalar(const _sha256d_scan& sc, uint32_t first, size_t n, uint32_t t0, std::vector<uint32_t>& hits) {
+							sweep<uint32_t>(sc, first, n, t0, hits);
+						}
+						// sha_ni outruns the folded scalar rounds with plain compresses
+						static void sweep_single(const _sha256d_scan& sc, uint32_t first, size_t n, uint32_t t0, std::vector<uint32_t>& hits) {
+							for(size_t i = 0; i < n; i++)
+								if(_load_be<uint32_t>(sc.digest(static_cast<uint32_t>(first + i)).data()) <= t0)
+									hits.push_back(static_cast<uint32_t>(first + i));
+						}
+						#ifdef __NEO_SHA_VECTORS
+						__NEO_SHA_TARGET("avx2")
+						static void sweep_avx2(const _sha256d_scan& sc, uint32_t first, size_t n, uint32_t t0, std::vector<uint32_t>& hits) {
+							sweep<_u32x8>(sc, first, n, t0, hits);
+						}
+						__NEO_SHA_TARGET("avx512f")
+						static void sweep_avx512(const _sha256d_scan& sc, uint32_t first, size_t n, uint32_t t0, std::vector<uint32_t>& hits) {
+							sweep<_u32x16>(sc, first, n, t0, hits);
+						}
+						#endif
+
+						static uint32_t sigma0(uint32_t x) {
+							return _rotrr(x, 7) ^ _rotrr(x, 18) ^ (x >> 3);
+						}
+						static uint32_t sigma1(uint32_t x) {
+							return _rotrr(x, 17) ^ _rotrr(x, 19) ^ (x >> 10);
+						}
+
+						template<class R>
+						__NEO_SHA_INLINE static void rotr(R& out, const R& x, int sh) {
+							out = (x >> sh) | (x << (32 - sh));
+						}
+						template<class R>
+						__NEO_SHA_INLINE static void step(R (&s)[8], const R& wk) {
+							R r0, r1, r2;
+							rotr(r0, s[4], 6); rotr(r1, s[4], 11); rotr(r2, s[4], 25);
+							R t1 = s[7] + (r0 ^ r1 ^ r2) + ((s[4] & s[5]) ^ (~s[4] & s[6])) + wk;
+							rotr(r0, s[0], 2); rotr(r1, s[0], 13); rotr(r2, s[0], 22);
+							R t2 = (r0 ^ r1 ^ r2) + ((s[0] & s[1]) ^ (s[0] & s[2]) ^ (s[1] & s[2]));
+							s[7] = s[6]; s[6] = s[5]; s[5] = s[4]; s[4] = s[3] + t1;
+							s[3] = s[2]; s[2] = s[1]; s[1] = s[0]; s[0] = t1 + t2;
+						}
+
+						// the message words known at compile time: the header tail block (Blk 2: 0..2 header, 3 nonce, 4 0x80000000,
+						// 5..14 zero, 15 640) and the digest block (Blk 3: 0..7 digest, 8 0x80000000, 9..14 zero, 15 256), the rest is in x
+						static constexpr bool in_x(int blk, int i) {
+							return i >= 16 || (blk == 2 ? i <= 3 : i <= 7);
+						}
+						static constexpr uint32_t fixed(int blk, int i) {
+							return blk == 2 ? (i == 4 ? 0x80000000 : i == 15 ? 640 : 0) : (i == 8 ? 0x80000000 : i == 15 ? 256 : 0);
+						}
+
+						// acc += word I, sigma0(word I) (S = 0) or sigma1(word I) (S = 1), folded for compile time words
+						template<int Blk, int I, int S, class R>
+						__NEO_SHA_INLINE static void add(R& acc, const R (&x)[16]) {
+							if(!in_x(Blk, I)) {
+								acc += S == 0 ? sigma0(fixed(Blk, I)) : S == 1 ? sigma1(fixed(Blk, I)) : fixed(Blk, I);
+								return;
+							}
+							const R& v = x[I % 16];
+							R r0, r1;
+							if(S == 0) {
+								rotr(r0, v, 7); rotr(r1, v, 18);
+								acc += r0 ^ r1 ^ (v >> 3);
+							}
+							else if(S == 1) {
+								rotr(r0, v, 17); rotr(r1, v, 19);
+								acc += r0 ^ r1 ^ (v >> 10);
+							}
+							else
+								acc += v;
+						}
+
+						template<int Blk, int I, class R>
+						__NEO_SHA_INLINE void round(R (&s)[8], R (&x)[16]) const {
+
+							static constexpr std::array<uint32_t, 64> k = get_round_table<uint32_t, 64>();
+
+							if(I < 16 && !in_x(Blk, I)) {
+								step(s, R() + (fixed(Blk, I) + k[I]));
+								return;
+							}
+
+							if(I >= 16) {
+								R& w = x[I % 16];
+								R acc = R();
+								if(Blk == 2 && I == 16)
+									acc += w16;
+								else if(Blk == 2 && I == 17)
+									acc += w17;
+								else if(Blk == 2 && I == 18) {
+									add<2, 3, 0>(acc, x);
+									acc += c18;
+								}
+								else if(Blk == 2 && I == 19) {
+									add<2, 3, 2>(acc, x);
+									acc += c19;
+								}
+								else {
+									// w[i] = sigma1(w[i - 2]) + w[i - 7] + sigma0(w[i - 15]) + w[i - 16]
+									add<Blk, (I >= 16 ? I - 2 : 0), 1>(acc, x);
+									add<Blk, (I >= 16 ? I - 7 : 0), 2>(acc, x);
+									add<Blk, (I >= 16 ? I - 15 : 0), 0>(acc, x);
+									add<Blk, (I >= 16 ? I - 16 : 0), 2>(acc, x);
+								}
+								w = acc;
+							}
+
+							step(s, x[I % 16] + k[I]);
+						}
+
+						template<int Blk, int First, class R, size_t... Is>
+						__NEO_SHA_INLINE void rounds(R (&s)[8], R (&x)[16], index<Is...>) const {
+							int expand[] = {(round<Blk, First + int(Is)>(s, x), 0)...};
+							(void)expand;
+						}
+
+						state_type mid;
+						uint32_t mid3[8];
+						uint32_t t1_3, t2_3, w16, w17, c18, c19;
+						uint8_t tail[12];
+
+				};
+
+				#ifdef __NEO_SHA_CONSTEXPR
+				// plain sha2 for constant evaluation, the runtime goes through _sha2_base
+				template<class T, size_t Bits, size_t Rounds, size_t Blk>
+				struct _sha2_const {
+
+					static constexpr T rotr(T x, int sh) {
+						return (x >> sh) | (x << (sizeof(T) * 8 - sh));
+					}
+
+					static constexpr sha_t<Bits> hash(const char* msg, size_t len) {
+
+						constexpr std::array<T, 8> init     = init_hash<T, Bits>();
+						constexpr std::array<T, Rounds> k   = get_round_table<T, Rounds>();
+						constexpr std::array<int, 12> seq   = unique_vals<T>();
+
+						T h[8] = {};
+						for(size_t i = 0; i < 8; i++)
+							h[i] = init[i];
+
+						// the padding needs 0x80 and the 2 word bit length after the message
+						size_t total = (len + 2 * sizeof(T)) / Blk * Blk + Blk;
+
+						for(size_t blk = 0; blk < total; blk += Blk) {
+
+							T w[Rounds] = {};
+							for(size_t i = 0; i < 16; i++)
+								for(size_t j = 0; j < sizeof(T); j++)
+									w[i] = (w[i] << 8) | _md_padded(msg, len, total, blk + i * sizeof(T) + j);
+							for(size_t i = 16; i < Rounds; i++)
+								w[i] = w[i - 16] + w[i - 7]
+									+ (rotr(w[i - 15], seq[0]) ^ rotr(w[i - 15], seq[1]) ^ (w[i - 15] >> seq[2]))
+									+ (rotr(w[i - 2], seq[3]) ^ rotr(w[i - 2], seq[4]) ^ (w[i - 2] >> seq[5]));
+
+							T s[8] = {h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7]};
+							for(size_t i = 0; i < Rounds; i++) {
+								T t1 = s[7] + (rotr(s[4], seq[6]) ^ rotr(s[4], seq[7]) ^ rotr(s[4], seq[8])) + ((s[4] & s[5]) ^ (~s[4] & s[6])) + k[i] + w[i];
+								T t2 = (rotr(s[0], seq[9]) ^ rotr(s[0], seq[10]) ^ rotr(s[0], seq[11])) + ((s[0] & s[1]) ^ (s[0] & s[2]) ^ (s[1] & s[2]));
+								for(size_t j = 7; j > 0; j--)
+									s[j] = s[j - 1];
+								s[4] += t1;
+								s[0] = t1 + t2;
+							}
+
+							for(size_t i = 0; i < 8; i++)
+								h[i] += s[i];
+						}
+
+						_cbytes<Bits / 8> out = {};
+						for(size_t i = 0; i < Bits / 8; i++)
+							out.v[i] = static_cast<uint8_t>(h[i / sizeof(T)] >> ((sizeof(T) - 1 - i % sizeof(T)) * 8));
+
+						return sha_t<Bits>(out, gen_seq<Bits / 8>());
+					}
+
+				};
+				#endif
+
+			}
+			namespace __sha3 {
+
+				using namespace neo::hash::__sha_details::__shared;
+
+				// keccak-f[1600] on 25 lanes held in locals, L is uint64_t or a vector with one independent state per element
+				struct _keccak {
+
+					typedef void (*lanes_fn)(uint64_t* state, const uint8_t* const* blocks, size_t words);
+
+					template<size_t Rounds>
+					static void permute(uint64_t* state) {
+						uint64_t s[25];
+						std::memcpy(s, state, sizeof(s));
+						permute_lanes<Rounds>(s);
+						std::memcpy(state, s, sizeof(s));
+					}
+
+					// the last Rounds rounds of keccak-f (24 for sha3 / shake, 12 for kangarootwelve)
+					template<size_t Rounds, class L>
+					__NEO_SHA_INLINE static void permute_lanes(L (&s)[25]) {
+
+						static constexpr std::array<uint64_t, 24> round_consts = {
+							0x0000000000000001, 0x0000000000008082, 0x800000000000808A, 0x8000000080008000,
+							0x000000000000808B, 0x0000000080000001, 0x8000000080008081, 0x8000000000008009,
+							0x000000000000008A, 0x0000000000000088, 0x0000000080008009, 0x000000008000000A,
+							0x000000008000808B, 0x800000000000008B, 0x8000000000008089, 0x8000000000008003,
+							0x8000000000008002, 0x8000000000000080, 0x000000000000800A, 0x800000008000000A,
+							0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008
+						};
+						// lane complementing: these lanes stay inverted through the rounds, so chi needs a single not per row
+						static constexpr std::array<bool, 25> inverted = {{
+							0, 1, 1, 0, 0,
+							0, 0, 0, 1, 0,
+							0, 0, 1, 0, 0,
+							0, 0, 1, 0, 0,
+							1, 0, 0, 0, 0
+						}};
+
+						L a[25], e[25];
+						for(size_t i = 0; i < 25; i++)
+							a[i] = inverted[i] ? ~s[i] : s[i];
+
+						for(size_t rd = 24 - Rounds; rd < 24; rd += 2) {
+							round_fn(a, e, round_consts[rd]);
+							round_fn(e, a, round_consts[rd + 1]);
+						}
+
+						for(size_t i = 0; i < 25; i++)
+							s[i] = inverted[i] ? ~a[i] : a[i];
+					}
+
+					// a (lane x + 5 * y) -> e, theta / rho / pi / chi / iota fused per output row
+					template<class L>
+					__NEO_SHA_INLINE static void round_fn(const L (&a)[25], L (&e)[25], uint64_t rc) {
+
+						L c[5], d[5], b[5], t;
+
+						// theta
+						c[0] = a[0] ^ a[5] ^ a[10] ^ a[15] ^ a[20];
+						c[1] = a[1] ^ a[6] ^ a[11] ^ a[16] ^ a[21];
+						c[2] = a[2] ^ a[7] ^ a[12] ^ a[17] ^ a[22];
+						c[3] = a[3] ^ a[8] ^ a[13] ^ a[18] ^ a[23];
+						c[4] = a[4] ^ a[9] ^ a[14] ^ a[19] ^ a[24];
+						rol(t, c[1], 1);
+						d[0] = c[4] ^ t;
+						rol(t, c[2], 1);
+						d[1] = c[0] ^ t;
+						rol(t, c[3], 1);
+						d[2] = c[1] ^ t;
+						rol(t, c[4], 1);
+						d[3] = c[2] ^ t;
+						rol(t, c[0], 1);
+						d[4] = c[3] ^ t;
+
+						// rho, pi, chi (and iota) of row 0
+						b[0] = a[0] ^ d[0];
+						rol(b[1], a[6] ^ d[1], 44);
+						rol(b[2], a[12] ^ d[2], 43);
+						rol(b[3], a[18] ^ d[3], 21);
+						rol(b[4], a[24] ^ d[4], 14);
+						e[0] = b[0] ^ (b[1] | b[2]) ^ rc;
+						e[1] = b[1] ^ (~b[2] | b[3]);
+						e[2] = b[2] ^ (b[3] & b[4]);
+						e[3] = b[3] ^ (b[4] | b[0]);
+						e[4] = b[4] ^ (b[0] & b[1]);
+
+						// row 1
+						rol(b[0], a[3] ^ d[3], 28);
+						rol(b[1], a[9] ^ d[4], 20);
+						rol(b[2], a[10] ^ d[0], 3);
+						rol(b[3], a[16] ^ d[1], 45);
+						rol(b[4], a[22] ^ d[2], 61);
+						e[5] = b[0] ^ (b[1] | b[2]);
+						e[6] = b[1] ^ (b[2] & b[3]);
+						e[7] = b[2] ^ (b[3] | ~b[4]);
+						e[8] = b[3] ^ (b[4] | b[0]);
+						e[9] = b[4] ^ (b[0] & b[1]);
+
+						// row 2
+						rol(b[0], a[1] ^ d[1], 1);
+						rol(b[1], a[7] ^ d[2], 6);
+						rol(b[2], a[13] ^ d[3], 25);
+						rol(b[3], a[19] ^ d[4], 8);
+						rol(b[4], a[20] ^ d[0], 18);
+						e[10] = b[0] ^ (b[1] | b[2]);
+						e[11] = b[1] ^ (b[2] & b[3]);
+						e[12] = b[2] ^ (~b[3] & b[4]);
+						e[13] = ~b[3] ^ (b[4] | b[0]);
+						e[14] = b[4] ^ (b[0] & b[1]);
+
+						// row 3
+						rol(b[0], a[4] ^ d[4], 27);
+						rol(b[1], a[5] ^ d[0], 36);
+						rol(b[2], a[11] ^ d[1], 10);
+						rol(b[3], a[17] ^ d[2], 15);
+						rol(b[4], a[23] ^ d[3], 56);
+						e[15] = b[0] ^ (b[1] & b[2]);
+						e[16] = b[1] ^ (b[2] | b[3]);
+						e[17] = b[2] ^ (~b[3] | b[4]);
+						e[18] = ~b[3] ^ (b[4] & b[0]);
+						e[19] = b[4] ^ (b[0] | b[1]);
+
+						// row 4
+						rol(b[0], a[2] ^ d[2], 62);
+						rol(b[1], a[8] ^ d[3], 55);
+						rol(b[2], a[14] ^ d[4], 39);
+						rol(b[3], a[15] ^ d[0], 41);
+						rol(b[4], a[21] ^ d[1], 2);
+						e[20] = b[0] ^ (~b[1] & b[2]);
+						e[21] = ~b[1] ^ (b[2] | b[3]);
+						e[22] = b[2] ^ (b[3] & b[4]);
+						e[23] = b[3] ^ (b[4] | b[0]);
+						e[24] = b[4] ^ (b[0] & b[1]);
+					}
+
+					__NEO_SHA_INLINE static void rol(uint64_t& out, uint64_t x, int sh) {
+						out = _rotrl(x, sh);
+					}
+
+					#ifdef __NEO_SHA_VECTORS
+					template<class R>
+					__NEO_SHA_INLINE static void rol(R& out, const R& x, int sh) {
+						_vrotl(out, x, sh);
+					}
+
+					template<size_t Rounds>
+					__NEO_SHA_TARGET("avx2")
+					static void absorb_lanes_avx2(uint64_t* state, const uint8_t* const* blocks, size_t words) {
+						absorb_lanes<_u64x4, Rounds>(state, blocks, words);
+					}
+					template<size_t Rounds>
+					__NEO_SHA_TARGET("avx512f")
+					static void absorb_lanes_avx512(uint64_t* state, const uint8_t* const* blocks, size_t words) {
+						absorb_lanes<_u64x8, Rounds>(state, blocks, words);
+					}
+
+					// state is 25 words x lanes (word major): xors the first words of every lane's block (none when blocks is null), then permutes all lanes
+					template<class R, size_t Rounds>
+					__NEO_SHA_INLINE static void absorb_lanes(uint64_t* state, const uint8_t* const* blocks, size_t words) {
+
+						static constexpr size_t lanes = sizeof(R) / 8;
+
+						uint64_t in[25][lanes];
+						std::memcpy(in, state, sizeof(in));
+
+						if(blocks)
+							for(size_t l = 0; l < lanes; l++)
+								for(size_t i = 0; i < words; i++) {
+									uint64_t w;
+									std::memcpy(&w, &blocks[l][i * 8], 8);
+									in[i][l] ^= w;
+								}
+
+						R s[25];
+						std::memcpy(s, in, sizeof(s));
+						permute_lanes<Rounds>(s);
+						std::memcpy(state, s, sizeof(s));
+					}
+					#endif
+
+					static constexpr size_t max_lanes = 8;
+
+					// atomic so a set_batch_backend() during hashing is seen whole, see batch()
+					static std::atomic<backend>& batch_backend() {
+						static std::atomic<backend> b(select_batch(backend::automatic));
+						return b;
+					}
+					// backend::automatic flags an unsupported pick, backend::scalar runs one state at a time
+					static backend select_batch(backend b) {
+						#ifdef __NEO_SHA_VECTORS
+						if((b == backend::automatic || b == backend::avx512) && cpu().avx512f)
+							return backend::avx512;
+						if((b == backend::automatic || b == backend::avx2) && cpu().avx2)
+							return backend::avx2;
+						#endif
+						return b == backend::automatic || b == backend::scalar ? backend::scalar : backend::automatic;
+					}
+					static bool set_batch_backend(backend b) {
+						backend k = select_batch(b);
+						if(k == backend::automatic)
+							return false;
+						batch_backend().store(k);
+						return true;
+					}
+					// the batch kernel (null for backend::scalar) and its lane count, from one read of the backend
+					template<size_t Rounds>
+					static lanes_fn batch(size_t& lanes) {
+						const backend b = batch_backend().load();
+						lanes = batch_lanes(b);
+						#ifdef __NEO_SHA_VECTORS
+						if(b == backend::avx512)
+							return absorb_lanes_avx512<Rounds>;
+						if(b == backend::avx2)
+							return absorb_lanes_avx2<Rounds>;
+						#endif
+						return nullptr;
+					}
+					static size_t batch_lanes(backend b) {
+						return b == backend::avx512 ? 8 : b == backend::avx2 ? 4 : 1;
+					}
+					static size_t batch_lanes() {
+						return batch_lanes(batch_backend().load());
+					}
+
+				};
+
+				template<size_t Bits, size_t Bitrate, size_t Capacity, uint8_t Delimiter, size_t Rounds = 24>
+				struct _sha3_base {
+
+					static constexpr size_t bits     = Bits;
+					static constexpr size_t blk_size = Bitrate / 8;
+
+					typedef union {
+						std::array<std::array<uint64_t, 5>, 5> a_u64;
+						std::array<uint64_t, 25> u64;
+						std::array<uint8_t, 200> u8;
+					} state_t;
+
+					static sha_t<Bits> hash(const uint8_t* msg, size_t len) {
+
+						state_t state;
+						sponge(state, msg, len);
+
+						return digest(state);
+					}
+					static sha_t<Bits> hash_shake(const uint8_t* msg, size_t len) {
+
+						state_t state;
+						sponge(state, msg, len);
+
+						return squeeze(state);
+					}
+
+					static sha_t<Bits> digest(state_t& state) {
+						return return_hash<Bits>(state.u8, gen_seq<Bits / 8>());
+					}
+					static sha_t<Bits> squeeze(state_t& state) {
+
+						std::array<uint8_t, Bits / 8> out;
+						size_t pos = 0;
+						squeeze(state, pos, out.data(), out.size());
+
+						return return_hash<Bits>(out, gen_seq<Bits / 8>());
+					}
+					// reads n bytes of output, pos is how much of the current rate block was already read
+					static void squeeze(state_t& state, size_t& pos, uint8_t* out, size_t n) {
+
+						while(n) {
+
+							if(pos == blk_size) {
+								permute(state);
+								pos = 0;
+							}
+
+							size_t take = blk_size - pos;
+							if(take > n)
+								take = n;
+							std::memcpy(out, &state.u8[pos], take);
+							pos += take;
+							out += take;
+							n   -= take;
+						}
+					}
+
+					static void sponge(state_t& state, const uint8_t* msg, size_t len) {
+						
+						state.u64.fill(0);
+
+						size_t pos = 0;
+						absorb(state, pos, msg, len);
+						pad(state, pos);
+					}
+					// xors msg into the rate starting at byte pos, permuting on every filled block
+					static void absorb(state_t& state, size_t& pos, const uint8_t* msg, size_t len) {
+
+						while(len) {
+
+							if(pos == 0 && len >= blk_size) {
+								for(size_t i = 0; i < blk_size / 8; i++) {
+									uint64_t lane;
+									std::memcpy(&lane, &msg[i * 8], 8);
+									state.u64[i] ^= lane;
+								}
+								permute(state);
+								msg += blk_size;
+								len -= blk_size;
+								continue;
+							}
+
+							size_t take = blk_size - pos;
+							if(take > len)
+								take = len;
+							for(size_t i = 0; i < take; i++)
+								state.u8[pos + i] ^= msg[i];
+							pos += take;
+							msg += take;
+							len -= take;
+
+							if(pos == blk_size) {
+								permute(state);
+								pos = 0;
+							}
+						}
+					}
+					static void pad(state_t& state, size_t pos) {
+						state.u8[pos] ^= Delimiter;
+						state.u8[blk_size - 1] ^= 0x80;
+						permute(state);
+					}
+					static void permute(state_t& state) {
+						__NEO_SHA_COUNT(stats_id(), 1);
+						_keccak::permute<Rounds>(state.u64.data());
+					}
+
+					// batch plumbing for _hash_many() and _hash_fixed(), a block here is absorbed and permuted
+					typedef state_t state_type;
+					typedef uint64_t word_type;
+					typedef _keccak::lanes_fn lanes_fn;
+
+					static constexpr size_t state_words = 25;
+					static constexpr size_t max_lanes   = _keccak::max_lanes;
+
+					static state_t init() {
+						state_t state;
+						state.u64.fill(0);
+						return state;
+					}
+					static uint64_t& word(state_t& state, size_t i) {
+						return state.u64[i];
+					}
+					static void compress(state_t& state, const uint8_t* blocks, size_t count) {
+						size_t pos = 0;
+						absorb(state, pos, blocks, count * blk_size);
+					}
+					// the last Lst bytes of a fixed length message (see _hash_fixed()), xored in as whole lanes with the padding at
+					// constant offsets
+					template<size_t Lst>
+					__NEO_SHA_INLINE static void compress_tail(state_t& state, const uint8_t* tail, uint64_t) {
+						for(size_t i = 0; i < Lst / 8; i++) {
+							uint64_t lane;
+							std::memcpy(&lane, &tail[i * 8], 8);
+							state.u64[i] ^= lane;
+						}
+						for(size_t i = Lst / 8 * 8; i < Lst; i++)
+							state.u8[i] ^= tail[i];
+						pad(state, Lst);
+					}
+					static size_t pad(uint8_t* out, const uint8_t* tail, size_t lst, uint64_t) {
+						std::fill(out, out + blk_size, 0);
+						std::copy(tail, tail + lst, out);
+						out[lst] ^= Delimiter;
+						out[blk_size - 1] ^= 0x80;
+						return 1;
+					}
+					static void run_lanes(lanes_fn fn, uint64_t* state, const uint8_t* const* blocks) {
+						__NEO_SHA_COUNT(stats_id(), _keccak::batch_lanes());
+						fn(state, blocks, blk_size / 8);
+					}
+
+					// sha3 by capacity, the shake family (shake, cshake, parallelhash, kangarootwelve) by rate and rounds
+					static constexpr stats_algorithm stats_id() {
+						return Rounds != 24 ? (Bitrate == 1344 ? stats_algorithm::kt128 : stats_algorithm::kt256)
+							: Delimiter != 0x06 ? (Bitrate == 1344 ? stats_algorithm::shake_128 : stats_algorithm::shake_256)
+							: Capacity == 448 ? stats_algorithm::sha3_224 : Capacity == 512 ? stats_algorithm::sha3_256 : Capacity == 768 ? stats_algorithm::sha3_384 : stats_algorithm::sha3_512;
+					}
+
+					template<bool Xof>
+					static void hash_many(const buffer* msgs, size_t count, sha_t<Bits>* out) {
+						typedef sha_t<Bits> (*output_fn)(state_t&);
+						size_t lanes;
+						_keccak::lanes_fn fn = _keccak::batch<Rounds>(lanes);
+						_hash_many<_sha3_base>(msgs, count, out, Xof ? static_cast<output_fn>(squeeze) : digest, fn, lanes);
+					}
+
+				};
+
+				// incremental front-end for the sponge, Xof selects the shake (squeeze) output over the plain digest
+				template<class Base, bool Xof>
+				class _sha3_hasher {
+
+					public:
+
+						typedef Base base_type;
+						typedef typename Base::state_t state_type;
+
+						static constexpr size_t bits     = Base::bits;
+						static constexpr size_t blk_size = Base::blk_size;
+
+						// trivially copyable snapshot: the sponge (partial block already xored in) and the position in the rate
+						struct midstate {
+							state_type state;
+							uint64_t pos;
+						};
+
+						_sha3_hasher() {
+							reset();
+						}
+						explicit _sha3_hasher(const midstate& m) {
+							restore(m);
+						}
+
+						void reset() {
+							state.u64.fill(0);
+							pos = 0;
+						}
+
+						// hash a shared prefix once, save() it and restore() (or construct from it) to continue with each suffix
+						midstate save() const {
+							midstate m;
+							m.state = state;
+							m.pos   = pos;
+							return m;
+						}
+						void restore(const midstate& m) {
+							state = m.state;
+							pos   = static_cast<size_t>(m.pos);
+						}
+
+						template<class T>
+						_sha3_hasher& update(const T* msg, size_t byte_len) {
+							Base::absorb(state, pos, reinterpret_cast<const uint8_t*>(msg), byte_len);
+							return *this;
+						}
+
+						sha_t<bits> finalize() const {
+							state_type st = state;
+							Base::pad(st, pos);
+							return Xof ? Base::squeeze(st) : Base::digest(st);
+						}
+
+						static void hash_many(const buffer* msgs, size_t count, sha_t<bits>* out) {
+							Base::template hash_many<Xof>(msgs, count, out);
+						}
+
+					private:
+
+						state_type state;
+						size_t pos;
+
+				};
+
+				// extendable output reader: absorb() the whole message, then squeeze() any amount of output over as many calls as needed
+				template<class Base>
+				class _sha3_xof {
+
+					public:
+
+						typedef typename Base::state_t state_type;
+
+						static constexpr size_t blk_size = Base::blk_size;
+
+						_sha3_xof() {
+							reset();
+						}
+
+						void reset() {
+							state.u64.fill(0);
+							pos       = 0;
+							squeezing = false;
+						}
+
+						// throws std::logic_error once squeezing started (reset() first)
+						template<class T>
+						_sha3_xof& absorb(const T* msg, size_t byte_len) {
+							if(squeezing)
+								throw std::logic_error("xof: absorb() after squeeze()");
+							Base::absorb(state, pos, reinterpret_cast<const uint8_t*>(msg), byte_len);
+							return *this;
+						}
+
+						template<class T>
+						_sha3_xof& squeeze(T* out, size_t byte_len) {
+							if(!squeezing) {
+								Base::pad(state, pos);
+								pos       = 0;
+								squeezing = true;
+							}
+							Base::squeeze(state, pos, reinterpret_cast<uint8_t*>(out), byte_len);
+							return *this;
+						}
+
+					private:
+
+						state_type state;
+						size_t pos;
+						bool squeezing;
+
+				};
+
+				// k indices in [0, m) per key read straight from the shake output: every 64 bit word of the stream (little endian) is
+				// scaled by m with lemire's multiply-shift, the words whose low product falls under 2^64 mod m are skipped so every
+				// index is exactly uniform; a rate block holds 21 (shake128) or 17 (shake256) words before the next permutation
+				template<size_t Bitrate, size_t Capacity>
+				struct _sha3_indices {
+
+					typedef _sha3_base<64, Bitrate, Capacity, 0x1f> base;
+					typedef typename base::state_t state_t;
+
+					static void derive(const uint8_t* key, size_t len, size_t k, uint64_t m, uint64_t* out) {
+						check(m);
+						state_t state;
+						base::sponge(state, key, len);
+						squeeze(state, k, m, out);
+					}
+
+					// the keys are absorbed a window at a time on the multi-lane kernel, the padded sponges are then squeezed one by one
+					static void derive_many(const buffer* keys, size_t count, size_t k, uint64_t m, uint64_t* out) {
+
+						check(m);
+						static constexpr size_t window = _keccak::max_lanes * 4;
+						state_t states[window];
+
+						for(size_t b = 0; b < count; b += window) {
+							size_t n = std::min(window, count - b);
+							size_t lanes;
+							_keccak::lanes_fn fn = _keccak::batch<24>(lanes);
+							_hash_many<base>(&keys[b], n, states, sponge_state, fn, lanes);
+							for(size_t i = 0; i < n; i++)
+								squeeze(states[i], k, m, &out[(b + i) * k]);
+						}
+					}
+
+					static void squeeze(state_t& state, size_t k, uint64_t m, uint64_t* out) {
+
+						const uint64_t reject = (0 - m) % m; // 2^64 mod m
+						size_t word = 0;
+
+						for(size_t i = 0; i < k; ) {
+							if(word == base::blk_size / 8) {
+								base::permute(state);
+								word = 0;
+							}
+							uint64_t hi, lo = _mul128(state.u64[word++], m, hi);
+							if(lo >= reject)
+								out[i++] = hi;
+						}
+					}
+
+					static state_t sponge_state(state_t& state) {
+						return state;
+					}
+
+					// [0, 0) has no index to give, and squeeze() divides by m
+					static void check(uint64_t m) {
+						if(!m)
+							throw std::invalid_argument("indices: m must be > 0");
+					}
+
+				};
+
+				// sp 800-185 integer encodings, out needs room for 9 bytes
+				inline size_t _left_encode(uint8_t* out, uint64_t x) {
+					size_t n = 1;
+					while(n < 8 && (x >> (n * 8)))
+						n++;
+					out[0] = static_cast<uint8_t>(n);
+					for(size_t i = 0; i < n; i++)
+						out[1 + i] = static_cast<uint8_t>(x >> ((n - 1 - i) * 8));
+					return n + 1;
+				}
+				inline size_t _right_encode(uint8_t* out, uint64_t x) {
+					size_t n = _left_encode(out, x) - 1;
+					std::memmove(out, out + 1, n);
+					out[n] = static_cast<uint8_t>(n);
+					return n + 1;
+				}
+				// kangarootwelve length_encode: like right_encode but without leading zero bytes (so 0 is a lone 0x00)
+				inline size_t _length_encode(uint8_t* out, uint64_t x) {
+					size_t n = 0;
+					while(n < 8 && (x >> (n * 8)))
+						n++;
+					for(size_t i = 0; i < n; i++)
+						out[i] = static_cast<uint8_t>(x >> ((n - 1 - i) * 8));
+					out[n] = static_cast<uint8_t>(n);
+					return n + 1;
+				}
+
+				// bytepad(encode_string(s0) || encode_string(s1) ..., rate), the cshake prefix (name, custom) and the kmac key block
+				template<class Hasher>
+				inline void _absorb_bytepad(Hasher& h, std::initializer_list<buffer> strings) {
+
+					static const uint8_t zeros[200] = {};
+					uint8_t enc[9];
+					size_t len, total = 0;
+
+					len = _left_encode(enc, Hasher::blk_size);
+					h.update(enc, len);
+					total += len;
+					for(const buffer& str : strings) {
+						len = _left_encode(enc, static_cast<uint64_t>(str.size) * 8);
+						h.update(enc, len).update(static_cast<const uint8_t*>(str.data), str.size);
+						total += len + str.size;
+					}
+
+					if(total % Hasher::blk_size)
+						h.update(zeros, Hasher::blk_size - total % Hasher::blk_size);
+				}
+				template<class Hasher>
+				inline void _absorb_cshake_prefix(Hasher& h, const std::string& name, const std::string& custom) {
+					_absorb_bytepad(h, {buffer{name.data(), name.size()}, buffer{custom.data(), custom.size()}});
+				}
+
+				// hashes count equal sized leaves (leaf_at(i) -> buffer) with Leaf::hash_many<true> on the shared pool, a window at a time,
+				// handing every window's chaining values to sink(cvs, n) in leaf order
+				template<class Leaf, class LeafAt, class Sink>
+				inline void _hash_leaves(size_t count, LeafAt leaf_at, Sink sink) {
+
+					if(!count)
+						return;
+
+					_thread_pool& pool = _thread_pool::global();
+
+					// a task fills the simd lanes a few times over, a window keeps every thread busy a few tasks deep
+					const size_t grain  = _keccak::batch_lanes() * 4;
+					const size_t window = std::min(count, grain * pool.size() * 4);
+
+					std::vector<buffer> leaves(window);
+					std::vector<sha_t<Leaf::bits>> cvs(window);
+
+					for(size_t first = 0; first < count; first += window) {
+
+						size_t n = std::min(window, count - first);
+						for(size_t i = 0; i < n; i++)
+							leaves[i] = leaf_at(first + i);
+
+						pool.parallel_for(n, grain, [&](size_t b, size_t e) {
+							Leaf::template hash_many<true>(&leaves[b], e - b, &cvs[b]);
+						});
+
+						sink(cvs.data(), n);
+					}
+				}
+
+				// sp 800-185 parallelhash over cshake128 (Bitrate 1344, Capacity 256) or cshake256 (1088, 512)
+				template<size_t Bits, size_t Bitrate, size_t Capacity>
+				struct _parallel_hash {
+
+					typedef _sha3_base<Capacity, Bitrate, Capacity, 0x1f> leaf;	// cshake with empty name and customization is shake
+					typedef _sha3_hasher<_sha3_base<Bits, Bitrate, Capacity, 0x04>, true> node;
+
+					static sha_t<Bits> hash(const uint8_t* msg, size_t len, size_t block, const std::string& custom) {
+
+						if(!block)
+							throw std::invalid_argument("parallelhash: block_size must be > 0");
+
+						uint8_t enc[9];
+						node h;
+
+						_absorb_cshake_prefix(h, "ParallelHash", custom);
+						h.update(enc, _left_encode(enc, block));
+
+						size_t count = (len + block - 1) / block;
+						_hash_leaves<leaf>(count, [&](size_t i) {
+							return buffer{&msg[i * block], std::min(block, len - i * block)};
+						}, [&](const sha_t<Capacity>* cvs, size_t n) {
+							for(size_t i = 0; i < n; i++)
+								h.update(cvs[i].data(), cvs[i].size());
+						});
+
+						h.update(enc, _right_encode(enc, count));
+						h.update(enc, _right_encode(enc, Bits));
+
+						return h.finalize();
+					}
+
+				};
+
+				// sp 800-185 cshake128 (Bitrate 1344, Capacity 256) / cshake256 (1088, 512), plain shake when name and custom are both empty
+				template<size_t Bits, size_t Bitrate, size_t Capacity>
+				struct _cshake {
+
+					typedef _sha3_hasher<_sha3_base<Bits, Bitrate, Capacity, 0x04>, true> hasher;
+
+					static sha_t<Bits> hash(const uint8_t* msg, size_t len, const std::string& name, const std::string& custom) {
+						if(name.empty() && custom.empty())
+							return _sha3_base<Bits, Bitrate, Capacity, 0x1f>::hash_shake(msg, len);
+						hasher h;
+						_absorb_cshake_prefix(h, name, custom);
+						return h.update(msg, len).finalize();
+					}
+
+				};
+
+				// sp 800-185 kmac128 (Bitrate 1344, Capacity 256) / kmac256 (1088, 512), or kmacxof with Xof: cshake named "KMAC" over
+				// bytepad(encode_string(key), rate) || msg || right_encode(Xof ? 0 : Bits); the prefix and key blocks are absorbed once
+				// here and every message starts from a copy of that state, so a const object can be shared between threads
+				template<size_t Bits, size_t Bitrate, size_t Capacity, bool Xof>
+				class _kmac {
+
+					typedef _sha3_hasher<_sha3_base<Bits, Bitrate, Capacity, 0x04>, true> hasher;
+
+					public:
+
+						static constexpr size_t bits     = Bits;
+						static constexpr size_t blk_size = Bitrate / 8;
+
+						template<class T>
+						_kmac(const T* key, size_t key_len, const std::string& custom = "") {
+							_absorb_cshake_prefix(keyed, "KMAC", custom);
+							_absorb_bytepad(keyed, {buffer{key, key_len}});
+							reset();
+						}
+
+						// one shot mac of msg, leaves the incremental state alone
+						template<class T>
+						sha_t<Bits> hash(const T* msg, size_t byte_len) const {
+							hasher h = keyed;
+							h.update(msg, byte_len);
+							return finish(h);
+						}
+
+						// incremental mac under the same key
+						void reset() {
+							running = keyed;
+						}
+						template<class T>
+						_kmac& update(const T* msg, size_t byte_len) {
+							running.update(msg, byte_len);
+							return *this;
+						}
+						sha_t<Bits> finalize() const {
+							return finish(running);
+						}
+
+					private:
+
+						static sha_t<Bits> finish(hasher h) {
+							uint8_t enc[9];
+							h.update(enc, _right_encode(enc, Xof ? 0 : Bits));
+							return h.finalize();
+						}
+
+						hasher keyed, running;
+
+				};
+
+				// kangarootwelve / kt128 (Bitrate 1344, Capacity 256) and kt256 (1088, 512): turboshake (12 rounds) over 8 KiB chunks
+				template<size_t Bits, size_t Bitrate, size_t Capacity>
+				struct _kangaroo_twelve {
+
+					static constexpr size_t chunk = 8192;
+
+					typedef _sha3_base<Capacity, Bitrate, Capacity, 0x0B, 12> leaf;
+					typedef _sha3_hasher<_sha3_base<Bits, Bitrate, Capacity, 0x07, 12>, true> single_node;
+					typedef _sha3_hasher<_sha3_base<Bits, Bitrate, Capacity, 0x06, 12>, true> final_node;
+
+					static sha_t<Bits> hash(const uint8_t* msg, size_t len, const std::string& custom) {
+
+						uint8_t enc[9];
+						size_t enc_len = _length_encode(enc, custom.size());
+						size_t total   = len + custom.size() + enc_len;
+
+						if(total <= chunk) {
+							single_node h;
+							h.update(msg, len).update(custom.data(), custom.size()).update(enc, enc_len);
+							return h.finalize();
+						}
+
+						// s = msg || custom || length_encode(|custom|), chunks entirely inside msg are read in place, the rest from a copy
+						size_t direct = len / chunk;
+						std::string tail(reinterpret_cast<const char*>(&msg[direct * chunk]), len - direct * chunk);
+						tail.append(custom).append(reinterpret_cast<const char*>(enc), enc_len);
+
+						auto chunk_at = [&](size_t i) -> buffer {
+							if(i < direct)
+								return buffer{&msg[i * chunk], chunk};
+							size_t off = (i - direct) * chunk;
+							return buffer{&tail[off], std::min(chunk, tail.size() - off)};
+						};
+
+						static const uint8_t marker[8] = {0x03};
+						static const uint8_t end[2]    = {0xFF, 0xFF};
+						size_t count = (total + chunk - 1) / chunk;
+						final_node h;
+
+						buffer first = chunk_at(0);
+						h.update(static_cast<const uint8_t*>(first.data), first.size).update(marker, sizeof(marker));
+
+						_hash_leaves<leaf>(count - 1, [&](size_t i) {
+							return chunk_at(i + 1);
+						}, [&](const sha_t<Capacity>* cvs, size_t n) {
+							for(size_t i = 0; i < n; i++)
+								h.update(cvs[i].data(), cvs[i].size());
+						});
+
+						h.update(enc, _length_encode(enc, count - 1)).update(end, sizeof(end));
+
+						return h.finalize();
+					}
+
+				};
+
+				template<size_t Bits, size_t Bitrate, size_t Capacity>
+				constexpr size_t _kangaroo_twelve<Bits, Bitrate, Capacity>::chunk;
+
+				#ifdef __NEO_SHA_CONSTEXPR
+				// plain keccak sponge for constant evaluation, the runtime goes through _sha3_base
+				template<size_t Bits, size_t Bitrate, uint8_t Delimiter>
+				struct _sha3_const {
+
+					static constexpr size_t blk_size = Bitrate / 8;
+
+					static constexpr uint64_t rotl(uint64_t x, int sh) {
+						return sh ? (x << sh) | (x >> (64 - sh)) : x;
+					}
+
+					// keccak-f[1600], lane x + 5 * y
+					static constexpr void permute(uint64_t (&s)[25]) {
+
+						constexpr uint64_t rc[24] = {
+							0x0000000000000001, 0x0000000000008082, 0x800000000000808A, 0x8000000080008000, 0x000000000000808B, 0x0000000080000001,
+							0x8000000080008081, 0x8000000000008009, 0x000000000000008A, 0x0000000000000088, 0x0000000080008009, 0x000000008000000A,
+							0x000000008000808B, 0x800000000000008B, 0x8000000000008089, 0x8000000000008003, 0x8000000000008002, 0x8000000000000080,
+							0x000000000000800A, 0x800000008000000A, 0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008
+						};
+						constexpr int rho[25] = {
+							0,  1,  62, 28, 27,
+							36, 44, 6,  55, 20,
+							3,  10, 43, 25, 39,
+							41, 45, 15, 21, 8,
+							18, 2,  61, 56, 14
+						};
+
+						for(size_t r = 0; r < 24; r++) {
+
+							uint64_t c[5] = {};
+							for(size_t x = 0; x < 5; x++)
+								c[x] = s[x] ^ s[x + 5] ^ s[x + 10] ^ s[x + 15] ^ s[x + 20];
+							for(size_t x = 0; x < 5; x++)
+								for(size_t y = 0; y < 25; y += 5)
+									s[x + y] ^= c[(x + 4) % 5] ^ rotl(c[(x + 1) % 5], 1);
+
+							uint64_t b[25] = {};
+							for(size_t x = 0; x < 5; x++)
+								for(size_t y = 0; y < 5; y++)
+									b[y + 5 * ((2 * x + 3 * y) % 5)] = rotl(s[x + 5 * y], rho[x + 5 * y]);
+
+							for(size_t x = 0; x < 5; x++)
+								for(size_t y = 0; y < 25; y += 5)
+									s[x + y] = b[x + y] ^ (~b[(x + 1) % 5 + y] & b[(x + 2) % 5 + y]);
+
+							s[0] ^= rc[r];
+						}
+					}
+
+					static constexpr sha_t<Bits> hash(const char* msg, size_t len) {
+
+						uint64_t s[25] = {};
+						size_t total = len / blk_size * blk_size + blk_size;
+
+						for(size_t blk = 0; blk < total; blk += blk_size) {
+							for(size_t i = 0; i < blk_size; i++) {
+								size_t p = blk + i;
+								uint8_t byte = p < len ? static_cast<uint8_t>(msg[p]) : 0;
+								if(p == len)
+									byte ^= Delimiter;
+								if(p == total - 1)
+									byte ^= 0x80;
+								s[i / 8] ^= static_cast<uint64_t>(byte) << ((i % 8) * 8);
+							}
+							permute(s);
+						}
+
+						_cbytes<sha_t<Bits>::bytes> out = {};
+						for(size_t i = 0; i < Bits / 8; i++) {
+							if(i && i % blk_size == 0)
+								permute(s);
+							out.v[i] = static_cast<uint8_t>(s[(i % blk_size) / 8] >> ((i % 8) * 8));
+						}
+
+						return sha_t<Bits>(out, gen_seq<sha_t<Bits>::bytes>());
+					}
+
+				};
+				#endif
+
+			}
+
+		}
+
+
+		class sha1 {
+
+			public:
+
+				typedef __sha_details::__shared::_md_hasher<__sha_details::__sha1::_sha1_base> hasher;
+
+				// forces a compress backend (backend::automatic restores the cpuid pick), false if the cpu lacks it
+				inline static bool set_backend(backend b) {
+					return __sha_details::__sha1::_sha1_base::set_backend(b);
+				}
+				inline static backend active_backend() {
+					return __sha_details::__sha1::_sha1_base::kernel().id;
+				}
+
+				template<class T> inline static sha_t<160> hash(const T* msg, size_t byte_len) {
+					return __sha_details::__sha1::_sha1_base::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
+				}
+
+				// messages of a length known at compile time: the padding and the length words are constants and a message that fits in
+				// one block is a single straight-line compression on the scalar backend
+				template<size_t Len> inline static sha_t<160> hash(const uint8_t (&msg)[Len]) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha1::_sha1_base, Len>(msg, __sha_details::__sha1::_sha1_base::output);
+				}
+				template<size_t Len> inline static sha_t<160> hash(const std::array<uint8_t, Len>& msg) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha1::_sha1_base, Len>(msg.data(), __sha_details::__sha1::_sha1_base::output);
+				}
+
+				// one message split over count fragments, hashed in place without joining them
+				inline static sha_t<160> hash_gather(const buffer* parts, size_t count) {
+					return __sha_details::__shared::_hash_gather<hasher>(parts, count);
+				}
+
+				#ifdef __NEO_SHA_CONSTEXPR
+				// char data in a constant expression is hashed at compile time (e.g. tables keyed by hashed literals), at runtime these
+				// forward to the kernels above
+				inline static constexpr sha_t<160> hash(const char* msg, size_t byte_len) {
+					return __NEO_SHA_CONSTANT_EVALUATED() ? __sha_details::__sha1::_sha1_const::hash(msg, byte_len) : hash<char>(msg, byte_len);
+				}
+				#endif
+
+		};
+		class sha2 {
+
+			public:
+
+				typedef __sha_details::__shared::_md_hasher<__sha_details::__sha2::_sha2_base<uint32_t, 224, 64, 64>>  hasher_224;
+				typedef __sha_details::__shared::_md_hasher<__sha_details::__sha2::_sha2_base<uint32_t, 256, 64, 64>>  hasher_256;
+				typedef __sha_details::__shared::_md_hasher<__sha_details::__sha2::_sha2_base<uint64_t, 384, 80, 128>> hasher_384;
+				typedef __sha_details::__shared::_md_hasher<__sha_details::__sha2::_sha2_base<uint64_t, 512, 80, 128>> hasher_512;
+				typedef __sha_details::__shared::_md_hasher<__sha_details::__sha2::_sha2_base<uint64_t, 224, 80, 128>> hasher_512_224;
+				typedef __sha_details::__shared::_md_hasher<__sha_details::__sha2::_sha2_base<uint64_t, 256, 80, 128>> hasher_512_256;
+
+				// backends are shared per word size: *_256 drives sha224/256, *_512 drives sha384/512/512_224/512_256
+				inline static bool set_backend_256(backend b) {
+					return __sha_details::__sha2::_sha2_compress<uint32_t, 64, 64>::set_backend(b);
+				}
+				inline static bool set_backend_512(backend b) {
+					return __sha_details::__sha2::_sha2_compress<uint64_t, 80, 128>::set_backend(b);
+				}
+				inline static backend active_backend_256() {
+					return __sha_details::__sha2::_sha2_compress<uint32_t, 64, 64>::kernel().id;
+				}
+				inline static backend active_backend_512() {
+					return __sha_details::__sha2::_sha2_compress<uint64_t, 80, 128>::kernel().id;
+				}
+
+				// batches of independent messages, out[i] receives the digest of msgs[i]
+				inline static void hash_224_many(const buffer* msgs, size_t count, sha_t<224>* out) {
+					__sha_details::__sha2::_sha2_base<uint32_t, 224, 64, 64>::hash_many(msgs, count, out);
+				}
+				inline static void hash_256_many(const buffer* msgs, size_t count, sha_t<256>* out) {
+					__sha_details::__sha2::_sha2_base<uint32_t, 256, 64, 64>::hash_many(msgs, count, out);
+				}
+				inline static void hash_384_many(const buffer* msgs, size_t count, sha_t<384>* out) {
+					__sha_details::__sha2::_sha2_base<uint64_t, 384, 80, 128>::hash_many(msgs, count, out);
+				}
+				inline static void hash_512_many(const buffer* msgs, size_t count, sha_t<512>* out) {
+					__sha_details::__sha2::_sha2_base<uint64_t, 512, 80, 128>::hash_many(msgs, count, out);
+				}
+				inline static void hash_512_224_many(const buffer* msgs, size_t count, sha_t<224>* out) {
+					__sha_details::__sha2::_sha2_base<uint64_t, 224, 80, 128>::hash_many(msgs, count, out);
+				}
+				inline static void hash_512_256_many(const buffer* msgs, size_t count, sha_t<256>* out) {
+					__sha_details::__sha2::_sha2_base<uint64_t, 256, 80, 128>::hash_many(msgs, count, out);
+				}
+
+				// batch kernels: backend::avx2 / avx512 lanes, or backend::scalar for one message at a time through the single buffer backend
+				inline static bool set_batch_backend_256(backend b) {
+					return __sha_details::__sha2::_sha2_compress<uint32_t, 64, 64>::set_batch_backend(b);
+				}
+				inline static bool set_batch_backend_512(backend b) {
+					return __sha_details::__sha2::_sha2_compress<uint64_t, 80, 128>::set_batch_backend(b);
+				}
+				inline static backend active_batch_backend_256() {
+					return __sha_details::__sha2::_sha2_compress<uint32_t, 64, 64>::active_batch_backend();
+				}
+				inline static backend active_batch_backend_512() {
+					return __sha_details::__sha2::_sha2_compress<uint64_t, 80, 128>::active_batch_backend();
+				}
+
+				template<class T> inline static sha_t<224> hash_224(const T* msg, size_t byte_len) {
+					return __sha_details::__sha2::_sha2_base<uint32_t, 224, 64, 64>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
+				}
+				template<class T> inline static sha_t<256> hash_256(const T* msg, size_t byte_len) {
+					return __sha_details::__sha2::_sha2_base<uint32_t, 256, 64, 64>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
+				}
+				template<class T> inline static sha_t<384> hash_384(const T* msg, size_t byte_len) {
+					return __sha_details::__sha2::_sha2_base<uint64_t, 384, 80, 128>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
+				}
+				template<class T> inline static sha_t<512> hash_512(const T* msg, size_t byte_len) {
+					return __sha_details::__sha2::_sha2_base<uint64_t, 512, 80, 128>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
+				}
+				template<class T> inline static sha_t<224> hash_512_224(const T* msg, size_t byte_len) {
+					return __sha_details::__sha2::_sha2_base<uint64_t, 224, 80, 128>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
+				}
+				template<class T> inline static sha_t<256> hash_512_256(const T* msg, size_t byte_len) {
+					return __sha_details::__sha2::_sha2_base<uint64_t, 256, 80, 128>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
+				}
+
+				// messages of a length known at compile time: the padding and the length words are constants and a message that fits in
+				// one block is a single straight-line compression on the scalar backend
+				template<size_t Len> inline static sha_t<224> hash_224(const uint8_t (&msg)[Len]) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha2::_sha2_base<uint32_t, 224, 64, 64>, Len>(msg, __sha_details::__sha2::_sha2_base<uint32_t, 224, 64, 64>::output);
+				}
+				template<size_t Len> inline static sha_t<224> hash_224(const std::array<uint8_t, Len>& msg) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha2::_sha2_base<uint32_t, 224, 64, 64>, Len>(msg.data(), __sha_details::__sha2::_sha2_base<uint32_t, 224, 64, 64>::output);
+				}
+				template<size_t Len> inline static sha_t<256> hash_256(const uint8_t (&msg)[Len]) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha2::_sha2_base<uint32_t, 256, 64, 64>, Len>(msg, __sha_details::__sha2::_sha2_base<uint32_t, 256, 64, 64>::output);
+				}
+				template<size_t Len> inline static sha_t<256> hash_256(const std::array<uint8_t, Len>& msg) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha2::_sha2_base<uint32_t, 256, 64, 64>, Len>(msg.data(), __sha_details::__sha2::_sha2_base<uint32_t, 256, 64, 64>::output);
+				}
+				template<size_t Len> inline static sha_t<384> hash_384(const uint8_t (&msg)[Len]) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha2::_sha2_base<uint64_t, 384, 80, 128>, Len>(msg, __sha_details::__sha2::_sha2_base<uint64_t, 384, 80, 128>::output);
+				}
+				template<size_t Len> inline static sha_t<384> hash_384(const std::array<uint8_t, Len>& msg) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha2::_sha2_base<uint64_t, 384, 80, 128>, Len>(msg.data(), __sha_details::__sha2::_sha2_base<uint64_t, 384, 80, 128>::output);
+				}
+				template<size_t Len> inline static sha_t<512> hash_512(const uint8_t (&msg)[Len]) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha2::_sha2_base<uint64_t, 512, 80, 128>, Len>(msg, __sha_details::__sha2::_sha2_base<uint64_t, 512, 80, 128>::output);
+				}
+				template<size_t Len> inline static sha_t<512> hash_512(const std::array<uint8_t, Len>& msg) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha2::_sha2_base<uint64_t, 512, 80, 128>, Len>(msg.data(), __sha_details::__sha2::_sha2_base<uint64_t, 512, 80, 128>::output);
+				}
+				template<size_t Len> inline static sha_t<224> hash_512_224(const uint8_t (&msg)[Len]) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha2::_sha2_base<uint64_t, 224, 80, 128>, Len>(msg, __sha_details::__sha2::_sha2_base<uint64_t, 224, 80, 128>::output);
+				}
+				template<size_t Len> inline static sha_t<224> hash_512_224(const std::array<uint8_t, Len>& msg) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha2::_sha2_base<uint64_t, 224, 80, 128>, Len>(msg.data(), __sha_details::__sha2::_sha2_base<uint64_t, 224, 80, 128>::output);
+				}
+				template<size_t Len> inline static sha_t<256> hash_512_256(const uint8_t (&msg)[Len]) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha2::_sha2_base<uint64_t, 256, 80, 128>, Len>(msg, __sha_details::__sha2::_sha2_base<uint64_t, 256, 80, 128>::output);
+				}
+				template<size_t Len> inline static sha_t<256> hash_512_256(const std::array<uint8_t, Len>& msg) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha2::_sha2_base<uint64_t, 256, 80, 128>, Len>(msg.data(), __sha_details::__sha2::_sha2_base<uint64_t, 256, 80, 128>::output);
+				}
+
+				// sha256(sha256(msg))
+				template<class T> inline static sha_t<256> hash_256d(const T* msg, size_t byte_len) {
+					sha_t<256> d = hash_256(msg, byte_len);
+					return hash_256(d.data(), d.size());
+				}
+				// proof of work scan over an 80 byte header ending in a little endian 32 bit nonce (bitcoin layout): the nonces first_nonce,
+				// first_nonce + 1 ... (count of them, wrapping at 2^32, at most 2^32) whose sha256d is below target, both read as big endian numbers,
+				// in nonce order; max_matches > 0 stops at the first max_matches of them; runs across simd lanes and threads
+				inline static std::vector<nonce_match> scan_256d(const void* header, uint32_t first_nonce, uint64_t count, const sha_t<256>& target, size_t max_matches = 0) {
+					return __sha_details::__sha2::_sha256d_scan::scan(static_cast<const uint8_t*>(header), first_nonce, count, target, max_matches);
+				}
+
+				// one message split over count fragments, hashed in place without joining them
+				inline static sha_t<224> hash_224_gather(const buffer* parts, size_t count) {
+					return __sha_details::__shared::_hash_gather<hasher_224>(parts, count);
+				}
+				inline static sha_t<256> hash_256_gather(const buffer* parts, size_t count) {
+					return __sha_details::__shared::_hash_gather<hasher_256>(parts, count);
+				}
+				inline static sha_t<384> hash_384_gather(const buffer* parts, size_t count) {
+					return __sha_details::__shared::_hash_gather<hasher_384>(parts, count);
+				}
+				inline static sha_t<512> hash_512_gather(const buffer* parts, size_t count) {
+					return __sha_details::__shared::_hash_gather<hasher_512>(parts, count);
+				}
+				inline static sha_t<224> hash_512_224_gather(const buffer* parts, size_t count) {
+					return __sha_details::__shared::_hash_gather<hasher_512_224>(parts, count);
+				}
+				inline static sha_t<256> hash_512_256_gather(const buffer* parts, size_t count) {
+					return __sha_details::__shared::_hash_gather<hasher_512_256>(parts, count);
+				}
+
+				#ifdef __NEO_SHA_CONSTEXPR
+				// char data in a constant expression is hashed at compile time (e.g. tables keyed by hashed literals), at runtime these
+				// forward to the kernels above
+				inline static constexpr sha_t<224> hash_224(const char* msg, size_t byte_len) {
+					return __NEO_SHA_CONSTANT_EVALUATED() ? __sha_details::__sha2::_sha2_const<uint32_t, 224, 64, 64>::hash(msg, byte_len) : hash_224<char>(msg, byte_len);
+				}
+				inline static constexpr sha_t<256> hash_256(const char* msg, size_t byte_len) {
+					return __NEO_SHA_CONSTANT_EVALUATED() ? __sha_details::__sha2::_sha2_const<uint32_t, 256, 64, 64>::hash(msg, byte_len) : hash_256<char>(msg, byte_len);
+				}
+				inline static constexpr sha_t<384> hash_384(const char* msg, size_t byte_len) {
+					return __NEO_SHA_CONSTANT_EVALUATED() ? __sha_details::__sha2::_sha2_const<uint64_t, 384, 80, 128>::hash(msg, byte_len) : hash_384<char>(msg, byte_len);
+				}
+				inline static constexpr sha_t<512> hash_512(const char* msg, size_t byte_len) {
+					return __NEO_SHA_CONSTANT_EVALUATED() ? __sha_details::__sha2::_sha2_const<uint64_t, 512, 80, 128>::hash(msg, byte_len) : hash_512<char>(msg, byte_len);
+				}
+				inline static constexpr sha_t<224> hash_512_224(const char* msg, size_t byte_len) {
+					return __NEO_SHA_CONSTANT_EVALUATED() ? __sha_details::__sha2::_sha2_const<uint64_t, 224, 80, 128>::hash(msg, byte_len) : hash_512_224<char>(msg, byte_len);
+				}
+				inline static constexpr sha_t<256> hash_512_256(const char* msg, size_t byte_len) {
+					return __NEO_SHA_CONSTANT_EVALUATED() ? __sha_details::__sha2::_sha2_const<uint64_t, 256, 80, 128>::hash(msg, byte_len) : hash_512_256<char>(msg, byte_len);
+				}
+				#endif
+
+		};
+		class sha3 {
+		
+			public:
+
+				typedef __sha_details::__sha3::_sha3_hasher<__sha_details::__sha3::_sha3_base<224, 1152, 448, 0x06>, false> hasher_224;
+				typedef __sha_details::__sha3::_sha3_hasher<__sha_details::__sha3::_sha3_base<256, 1088, 512, 0x06>, false> hasher_256;
+				typedef __sha_details::__sha3::_sha3_hasher<__sha_details::__sha3::_sha3_base<384, 832, 768, 0x06>, false>  hasher_384;
+				typedef __sha_details::__sha3::_sha3_hasher<__sha_details::__sha3::_sha3_base<512, 576, 1024, 0x06>, false> hasher_512;
+
+				template<size_t Bits>
+				using hasher_shake_128 = __sha_details::__sha3::_sha3_hasher<__sha_details::__sha3::_sha3_base<Bits, 1344, 256, 0x1f>, true>;
+				template<size_t Bits>
+				using hasher_shake_256 = __sha_details::__sha3::_sha3_hasher<__sha_details::__sha3::_sha3_base<Bits, 1088, 512, 0x1f>, true>;
+
+				// sp 800-185 kmac128 / kmac256 (Xof: kmacxof128 / kmacxof256) of Bits output bits, keyed once at construction:
+				// kmac_128<256> mac(key, key_len, custom); mac.hash(msg, len) / mac.update(msg, len).finalize()
+				template<size_t Bits>
+				using kmac_128 = __sha_details::__sha3::_kmac<Bits, 1344, 256, false>;
+				template<size_t Bits>
+				using kmac_256 = __sha_details::__sha3::_kmac<Bits, 1088, 512, false>;
+				template<size_t Bits>
+				using kmac_xof_128 = __sha_details::__sha3::_kmac<Bits, 1344, 256, true>;
+				template<size_t Bits>
+				using kmac_xof_256 = __sha_details::__sha3::_kmac<Bits, 1088, 512, true>;
+
+				// shake128 / shake256 with the output length chosen at runtime
+				typedef __sha_details::__sha3::_sha3_xof<__sha_details::__sha3::_sha3_base<256, 1344, 256, 0x1f>> xof_128;
+				typedef __sha_details::__sha3::_sha3_xof<__sha_details::__sha3::_sha3_base<512, 1088, 512, 0x1f>> xof_256;
+
+				template<class T> inline static sha_t<224> hash_224(const T* msg, size_t byte_len) {
+					return __sha_details::__sha3::_sha3_base<224, 1152, 448, 0x06>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
+				}
+				template<class T> inline static sha_t<256> hash_256(const T* msg, size_t byte_len) {
+					return __sha_details::__sha3::_sha3_base<256, 1088, 512, 0x06>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
+				}
+				template<class T> inline static sha_t<384> hash_384(const T* msg, size_t byte_len) {
+					return __sha_details::__sha3::_sha3_base<384, 832, 768, 0x06>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
+				}
+				template<class T> inline static sha_t<512> hash_512(const T* msg, size_t byte_len) {
+					return __sha_details::__sha3::_sha3_base<512, 576, 1024, 0x06>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len);
+				}
+
+				template<size_t Bits, class T>
+				inline static sha_t<Bits> hash_shake_128(const T* msg, size_t byte_len) {
+					return __sha_details::__sha3::_sha3_base<Bits, 1344, 256, 0x1f>::hash_shake(reinterpret_cast<const uint8_t*>(msg), byte_len);
+				}
+				template<size_t Bits, class T>
+				inline static sha_t<Bits> hash_shake_256(const T* msg, size_t byte_len) {
+					return __sha_details::__sha3::_sha3_base<Bits, 1088, 512, 0x1f>::hash_shake(reinterpret_cast<const uint8_t*>(msg), byte_len);
+				}
+
+				// messages of a length known at compile time: the padding is a constant and the last block is absorbed without
+				// the byte loop
+				template<size_t Len> inline static sha_t<224> hash_224(const uint8_t (&msg)[Len]) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha3::_sha3_base<224, 1152, 448, 0x06>, Len>(msg, __sha_details::__sha3::_sha3_base<224, 1152, 448, 0x06>::digest);
+				}
+				template<size_t Len> inline static sha_t<224> hash_224(const std::array<uint8_t, Len>& msg) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha3::_sha3_base<224, 1152, 448, 0x06>, Len>(msg.data(), __sha_details::__sha3::_sha3_base<224, 1152, 448, 0x06>::digest);
+				}
+				template<size_t Len> inline static sha_t<256> hash_256(const uint8_t (&msg)[Len]) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha3::_sha3_base<256, 1088, 512, 0x06>, Len>(msg, __sha_details::__sha3::_sha3_base<256, 1088, 512, 0x06>::digest);
+				}
+				template<size_t Len> inline static sha_t<256> hash_256(const std::array<uint8_t, Len>& msg) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha3::_sha3_base<256, 1088, 512, 0x06>, Len>(msg.data(), __sha_details::__sha3::_sha3_base<256, 1088, 512, 0x06>::digest);
+				}
+				template<size_t Len> inline static sha_t<384> hash_384(const uint8_t (&msg)[Len]) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha3::_sha3_base<384, 832, 768, 0x06>, Len>(msg, __sha_details::__sha3::_sha3_base<384, 832, 768, 0x06>::digest);
+				}
+				template<size_t Len> inline static sha_t<384> hash_384(const std::array<uint8_t, Len>& msg) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha3::_sha3_base<384, 832, 768, 0x06>, Len>(msg.data(), __sha_details::__sha3::_sha3_base<384, 832, 768, 0x06>::digest);
+				}
+				template<size_t Len> inline static sha_t<512> hash_512(const uint8_t (&msg)[Len]) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha3::_sha3_base<512, 576, 1024, 0x06>, Len>(msg, __sha_details::__sha3::_sha3_base<512, 576, 1024, 0x06>::digest);
+				}
+				template<size_t Len> inline static sha_t<512> hash_512(const std::array<uint8_t, Len>& msg) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha3::_sha3_base<512, 576, 1024, 0x06>, Len>(msg.data(), __sha_details::__sha3::_sha3_base<512, 576, 1024, 0x06>::digest);
+				}
+				template<size_t Bits, size_t Len> inline static sha_t<Bits> hash_shake_128(const uint8_t (&msg)[Len]) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha3::_sha3_base<Bits, 1344, 256, 0x1f>, Len>(msg, __sha_details::__sha3::_sha3_base<Bits, 1344, 256, 0x1f>::squeeze);
+				}
+				template<size_t Bits, size_t Len> inline static sha_t<Bits> hash_shake_128(const std::array<uint8_t, Len>& msg) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha3::_sha3_base<Bits, 1344, 256, 0x1f>, Len>(msg.data(), __sha_details::__sha3::_sha3_base<Bits, 1344, 256, 0x1f>::squeeze);
+				}
+				template<size_t Bits, size_t Len> inline static sha_t<Bits> hash_shake_256(const uint8_t (&msg)[Len]) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha3::_sha3_base<Bits, 1088, 512, 0x1f>, Len>(msg, __sha_details::__sha3::_sha3_base<Bits, 1088, 512, 0x1f>::squeeze);
+				}
+				template<size_t Bits, size_t Len> inline static sha_t<Bits> hash_shake_256(const std::array<uint8_t, Len>& msg) {
+					return __sha_details::__shared::_hash_fixed<__sha_details::__sha3::_sha3_base<Bits, 1088, 512, 0x1f>, Len>(msg.data(), __sha_details::__sha3::_sha3_base<Bits, 1088, 512, 0x1f>::squeeze);
+				}
+
+				// one message split over count fragments, absorbed in place without joining them
+				inline static sha_t<224> hash_224_gather(const buffer* parts, size_t count) {
+					return __sha_details::__shared::_hash_gather<hasher_224>(parts, count);
+				}
+				inline static sha_t<256> hash_256_gather(const buffer* parts, size_t count) {
+					return __sha_details::__shared::_hash_gather<hasher_256>(parts, count);
+				}
+				inline static sha_t<384> hash_384_gather(const buffer* parts, size_t count) {
+					return __sha_details::__shared::_hash_gather<hasher_384>(parts, count);
+				}
+				inline static sha_t<512> hash_512_gather(const buffer* parts, size_t count) {
+					return __sha_details::__shared::_hash_gather<hasher_512>(parts, count);
+				}
+				template<size_t Bits>
+				inline static sha_t<Bits> hash_shake_128_gather(const buffer* parts, size_t count) {
+					return __sha_details::__shared::_hash_gather<hasher_shake_128<Bits>>(parts, count);
+				}
+				template<size_t Bits>
+				inline static sha_t<Bits> hash_shake_256_gather(const buffer* parts, size_t count) {
+					return __sha_details::__shared::_hash_gather<hasher_shake_256<Bits>>(parts, count);
+				}
+
+				#ifdef __NEO_SHA_CONSTEXPR
+				// char data in a constant expression is hashed at compile time (e.g. tables keyed by hashed literals), at runtime these
+				// forward to the kernels above
+				inline static constexpr sha_t<224> hash_224(const char* msg, size_t byte_len) {
+					return __NEO_SHA_CONSTANT_EVALUATED() ? __sha_details::__sha3::_sha3_const<224, 1152, 0x06>::hash(msg, byte_len) : hash_224<char>(msg, byte_len);
+				}
+				inline static constexpr sha_t<256> hash_256(const char* msg, size_t byte_len) {
+					return __NEO_SHA_CONSTANT_EVALUATED() ? __sha_details::__sha3::_sha3_const<256, 1088, 0x06>::hash(msg, byte_len) : hash_256<char>(msg, byte_len);
+				}
+				inline static constexpr sha_t<384> hash_384(const char* msg, size_t byte_len) {
+					return __NEO_SHA_CONSTANT_EVALUATED() ? __sha_details::__sha3::_sha3_const<384, 832, 0x06>::hash(msg, byte_len) : hash_384<char>(msg, byte_len);
+				}
+				inline static constexpr sha_t<512> hash_512(const char* msg, size_t byte_len) {
+					return __NEO_SHA_CONSTANT_EVALUATED() ? __sha_details::__sha3::_sha3_const<512, 576, 0x06>::hash(msg, byte_len) : hash_512<char>(msg, byte_len);
+				}
+				template<size_t Bits>
+				inline static constexpr sha_t<Bits> hash_shake_128(const char* msg, size_t byte_len) {
+					return __NEO_SHA_CONSTANT_EVALUATED() ? __sha_details::__sha3::_sha3_const<Bits, 1344, 0x1f>::hash(msg, byte_len) : hash_shake_128<Bits, char>(msg, byte_len);
+				}
+				template<size_t Bits>
+				inline static constexpr sha_t<Bits> hash_shake_256(const char* msg, size_t byte_len) {
+					return __NEO_SHA_CONSTANT_EVALUATED() ? __sha_details::__sha3::_sha3_const<Bits, 1088, 0x1f>::hash(msg, byte_len) : hash_shake_256<Bits, char>(msg, byte_len);
+				}
+				#endif
+
+				// batches of independent messages, out[i] receives the digest of msgs[i]
+				inline static void hash_224_many(const buffer* msgs, size_t count, sha_t<224>* out) {
+					__sha_details::__sha3::_sha3_base<224, 1152, 448, 0x06>::hash_many<false>(msgs, count, out);
+				}
+				inline static void hash_256_many(const buffer* msgs, size_t count, sha_t<256>* out) {
+					__sha_details::__sha3::_sha3_base<256, 1088, 512, 0x06>::hash_many<false>(msgs, count, out);
+				}
+				inline static void hash_384_many(const buffer* msgs, size_t count, sha_t<384>* out) {
+					__sha_details::__sha3::_sha3_base<384, 832, 768, 0x06>::hash_many<false>(msgs, count, out);
+				}
+				inline static void hash_512_many(const buffer* msgs, size_t count, sha_t<512>* out) {
+					__sha_details::__sha3::_sha3_base<512, 576, 1024, 0x06>::hash_many<false>(msgs, count, out);
+				}
+				template<size_t Bits>
+				inline static void hash_shake_128_many(const buffer* msgs, size_t count, sha_t<Bits>* out) {
+					__sha_details::__sha3::_sha3_base<Bits, 1344, 256, 0x1f>::template hash_many<true>(msgs, count, out);
+				}
+				template<size_t Bits>
+				inline static void hash_shake_256_many(const buffer* msgs, size_t count, sha_t<Bits>* out) {
+					__sha_details::__sha3::_sha3_base<Bits, 1088, 512, 0x1f>::template hash_many<true>(msgs, count, out);
+				}
+
+				// k uniform indices in [0, m) (m > 0, std::invalid_argument otherwise) from one absorb of key, e.g. the k probes of a bloom
+				// filter, read straight from the shake output (one permutation for up to 21 / 17 indices); the _many forms absorb the keys
+				// across simd lanes and write the indices of keys[i] to out[i * k]
+				template<class T>
+				inline static void indices_128(const T* key, size_t byte_len, size_t k, uint64_t m, uint64_t* out) {
+					__sha_details::__sha3::_sha3_indices<1344, 256>::derive(reinterpret_cast<const uint8_t*>(key), byte_len, k, m, out);
+				}
+				template<class T>
+				inline static void indices_256(const T* key, size_t byte_len, size_t k, uint64_t m, uint64_t* out) {
+					__sha_details::__sha3::_sha3_indices<1088, 512>::derive(reinterpret_cast<const uint8_t*>(key), byte_len, k, m, out);
+				}
+				inline static void indices_128_many(const buffer* keys, size_t count, size_t k, uint64_t m, uint64_t* out) {
+					__sha_details::__sha3::_sha3_indices<1344, 256>::derive_many(keys, count, k, m, out);
+				}
+				inline static void indices_256_many(const buffer* keys, size_t count, size_t k, uint64_t m, uint64_t* out) {
+					__sha_details::__sha3::_sha3_indices<1088, 512>::derive_many(keys, count, k, m, out);
+				}
+
+				// sp 800-185 cshake, name is the function name string N (reserved for nist defined functions, usually empty) and custom
+				// the customization string S; with both empty it is shake
+				template<size_t Bits, class T>
+				inline static sha_t<Bits> hash_cshake_128(const T* msg, size_t byte_len, const std::string& name, const std::string& custom) {
+					return __sha_details::__sha3::_cshake<Bits, 1344, 256>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len, name, custom);
+				}
+				template<size_t Bits, class T>
+				inline static sha_t<Bits> hash_cshake_256(const T* msg, size_t byte_len, const std::string& name, const std::string& custom) {
+					return __sha_details::__sha3::_cshake<Bits, 1088, 512>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len, name, custom);
+				}
+
+				// sp 800-185 parallelhash, msg is cut in block_size byte leaves hashed across threads and simd lanes, custom is the
+				// customization string S; throws std::invalid_argument for a block_size of 0
+				template<size_t Bits, class T>
+				inline static sha_t<Bits> hash_parallel_128(const T* msg, size_t byte_len, size_t block_size = 8192, const std::string& custom = "") {
+					return __sha_details::__sha3::_parallel_hash<Bits, 1344, 256>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len, block_size, custom);
+				}
+				template<size_t Bits, class T>
+				inline static sha_t<Bits> hash_parallel_256(const T* msg, size_t byte_len, size_t block_size = 8192, const std::string& custom = "") {
+					return __sha_details::__sha3::_parallel_hash<Bits, 1088, 512>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len, block_size, custom);
+				}
+
+				// kangarootwelve (kt128) and kt256 from rfc 9861, 8 KiB chunks hashed across threads and simd lanes,
+				// custom is the customization string C
+				template<size_t Bits, class T>
+				inline static sha_t<Bits> hash_kt128(const T* msg, size_t byte_len, const std::string& custom = "") {
+					return __sha_details::__sha3::_kangaroo_twelve<Bits, 1344, 256>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len, custom);
+				}
+				template<size_t Bits, class T>
+				inline static sha_t<Bits> hash_kt256(const T* msg, size_t byte_len, const std::string& custom = "") {
+					return __sha_details::__sha3::_kangaroo_twelve<Bits, 1088, 512>::hash(reinterpret_cast<const uint8_t*>(msg), byte_len, custom);
+				}
+
+				// batch keccak: backend::avx2 (4 states) / avx512 (8 states) per permutation, or backend::scalar for one at a time
+				inline static bool set_batch_backend(backend b) {
+					return __sha_details::__sha3::_keccak::set_batch_backend(b);
+				}
+				inline static backend active_batch_backend() {
+					return __sha_details::__sha3::_keccak::batch_backend().load();
+				}
+
+		};
+
+		// kernel counters per algorithm, kept when sha.hpp is included with NEO_SHA_STATS defined (NEO_SHA_STATS_TSC adds rdtsc
+		// timings) and all zeros otherwise, and the backends every algorithm currently runs on
+		class hash_stats {
+
+			public:
+
+				typedef stats_algorithm algorithm;
+
+				static constexpr bool enabled() {
+					#ifdef NEO_SHA_STATS
+					return true;
+					#else
+					return false;
+					#endif
+				}
+				static constexpr bool timed() {
+					#ifdef NEO_SHA_STATS_TSC
+					return true;
+					#else
+					return false;
+					#endif
+				}
+
+				// the calling thread's counters
+				inline static hash_counters thread(stats_algorithm a) {
+					return read(a, false);
+				}
+				// every thread's, those already exited included
+				inline static hash_counters total(stats_algorithm a) {
+					return read(a, true);
+				}
+
+				// backend of single messages, sha3 and shake have no accelerated single state permutation
+				inline static backend active_backend(stats_algorithm a) {
+					switch(a) {
+						case stats_algorithm::sha1:     return sha1::active_backend();
+						case stats_algorithm::sha2_256: return sha2::active_backend_256();
+						case stats_algorithm::sha2_512: return sha2::active_backend_512();
+						default:                  return backend::scalar;
+					}
+				}
+				// backend of batches, tree modes and multi-lane helpers (the single message one where those run a message at a time)
+				inline static backend active_batch_backend(stats_algorithm a) {
+					switch(a) {
+						case stats_algorithm::sha1:     return sha1::active_backend();
+						case stats_algorithm::sha2_256: return sha2::active_batch_backend_256();
+						case stats_algorithm::sha2_512: return sha2::active_batch_backend_512();
+						default:                  return sha3::active_batch_backend();
+					}
+				}
+
+				inline static size_t block_size(stats_algorithm a) {
+					static const size_t sizes[] = {64, 64, 128, 144, 136, 104, 72, 168, 136, 168, 136};
+					return sizes[static_cast<int>(a)];
+				}
+				inline static const char* name(stats_algorithm a) {
+					static const char* const names[] = {"sha1", "sha2-256", "sha2-512", "sha3-224", "sha3-256", "sha3-384", "sha3-512", "shake128", "shake256", "kt128", "kt256"};
+					return names[static_cast<int>(a)];
+				}
+				inline static const char* name(backend b) {
+					static const char* const names[] = {"automatic", "scalar", "sha_ni", "avx2", "avx512"};
+					return names[static_cast<int>(b)];
+				}
+
+			private:
+
+				static hash_counters read(stats_algorithm a, bool all) {
+					hash_counters c = {};
+					#ifdef NEO_SHA_STATS
+					typedef __sha_details::__shared::_stats stats;
+					uint64_t v[stats::fields];
+					stats::read(a, all, v);
+					c.calls  = v[stats::calls];
+					c.blocks = v[stats::blocks];
+					c.cycles = v[stats::cycles];
+					std::copy(&v[stats::histogram], &v[stats::fields], c.histogram);
+					#else
+					(void)a;
+					(void)all;
+					#endif
+					c.bytes = c.blocks * block_size(a);
+					return c;
+				}
+
+		};
+
+		// keyed hmac (rfc 2104) over any hasher (sha1::hasher, sha2::hasher_*, sha3::hasher_*), the key pads are compressed once here
+		// and every message starts from copies of those inner / outer midstates
+		template<class Hasher>
+		class hmac {
+
+			public:
+
+				static constexpr size_t bits     = Hasher::bits;
+				static constexpr size_t blk_size = Hasher::blk_size;
+
+				template<class T>
+				hmac(const T* key, size_t key_len) {
+
+					std::array<uint8_t, blk_size> block = {};
+					const uint8_t* k = reinterpret_cast<const uint8_t*>(key);
+
+					if(key_len > blk_size) {
+						sha_t<bits> d = Hasher().update(k, key_len).finalize();
+						std::copy(d.begin(), d.end(), block.begin());
+					}
+					else
+						std::copy(k, k + key_len, block.begin());
+
+					for(uint8_t& b : block)
+						b ^= 0x36;
+					inner.update(block.data(), blk_size);
+					for(uint8_t& b : block)
+						b ^= 0x36 ^ 0x5c;
+					outer.update(block.data(), blk_size);
+
+					reset();
+				}
+
+				// one shot mac of msg, leaves the incremental state alone
+				template<class T>
+				sha_t<bits> hash(const T* msg, size_t byte_len) const {
+					Hasher h = inner;
+					h.update(msg, byte_len);
+					return finish(h);
+				}
+
+				// incremental mac under the same key
+				void reset() {
+					running = inner;
+				}
+				template<class T>
+				hmac& update(const T* msg, size_t byte_len) {
+					running.update(msg, byte_len);
+					return *this;
+				}
+				sha_t<bits> finalize() const {
+					return finish(running);
+				}
+
+			private:
+
+				sha_t<bits> finish(const Hasher& h) const {
+					sha_t<bits> d = h.finalize();
+					Hasher o = outer;
+					o.update(d.data(), d.size());
+					return o.finalize();
+				}
+
+				Hasher inner, outer, running;
+
+		};
+
+		// pbkdf2-hmac (rfc 8018) for sha1::hasher and sha2::hasher_*, fills out_len bytes of out; throws std::invalid_argument for 0
+		// iterations
+		template<class Hasher>
+		inline void pbkdf2(const void* password, size_t password_len, const void* salt, size_t salt_len, size_t iterations, void* out, size_t out_len) {
+			__sha_details::__shared::_pbkdf2<typename Hasher::base_type>::derive(static_cast<const uint8_t*>(password), password_len,
+				static_cast<const uint8_t*>(salt), salt_len, iterations, static_cast<uint8_t*>(out), out_len);
+		}
+
+		// worker threads for parallel_hash(), size() counts the calling thread too; thread_pool::global() is the one the library
+		// shares (tree modes, merkle levels), with one worker less than the hardware threads
+		typedef __sha_details::__shared::_thread_pool thread_pool;
+
+		// hashes the independent messages [first, last) with any hasher (sha1::hasher, sha2::hasher_*, sha3::hasher_*) into out,
+		// spread over the threads of executor (a thread_pool or anything with size() and parallel_for(count, grain, fn) like it) and
+		// the simd lanes; work is split by byte volume and balanced by stealing, so a few huge messages don't hold up the rest;
+		// the messages are buffers or contiguous containers (std::string, std::vector<uint8_t>...), both iterators random access
+		template<class Hasher, class InputIt, class OutputIt, class Executor>
+		inline void parallel_hash(InputIt first, InputIt last, OutputIt out, Executor& executor) {
+			__sha_details::__shared::_parallel_hash<Hasher>(first, static_cast<size_t>(last - first), out, executor);
+		}
+		template<class Hasher, class InputIt, class OutputIt>
+		inline void parallel_hash(InputIt first, InputIt last, OutputIt out) {
+			parallel_hash<Hasher>(first, last, out, thread_pool::global());
+		}
+
+		// binary merkle tree over sha2::hasher_256 / sha2::hasher_512 digests with rfc 6962 hashes: a leaf is H(0x00 || digest), a node
+		// H(0x01 || left || right), an unpaired last node moves up a level unchanged (the same tree as rfc 6962's split at the largest
+		// power of two); levels are hashed across the simd lanes and, when large, on the shared thread pool
+		template<class Hasher>
+		class merkle_tree {
+
+			typedef __sha_details::__shared::_merkle<typename Hasher::base_type> nodes;
+
+			public:
+
+				static constexpr size_t bits = Hasher::bits;
+				typedef sha_t<bits> digest;
+
+				// siblings from the leaf up, levels where the node moves up unchanged add none; the tree size is not part of it, the
+				// verifier brings its own
+				struct proof {
+					size_t index;
+					std::vector<digest> path;
+				};
+
+				merkle_tree() {}
+				merkle_tree(const digest* leaves, size_t count) {
+					build(leaves, count);
+				}
+
+				void build(const digest* leaves, size_t count) {
+					levels.assign(1, std::vector<digest>(count));
+					nodes::leaves(leaves, count, levels[0].data());
+					while(levels.back().size() > 1) {
+						std::vector<digest> next((levels.back().size() + 1) / 2);
+						nodes::level(levels.back().data(), levels.back().size(), next.data());
+						levels.push_back(std::move(next));
+					}
+				}
+
+				size_t size() const {
+					return levels.empty() ? 0 : levels[0].size();
+				}
+				// level 0 holds the leaf hashes, the last one the root
+				size_t height() const {
+					return levels.size();
+				}
+				const std::vector<digest>& level(size_t i) const {
+					return levels[i];
+				}
+				// all zero for an empty tree
+				digest root() const {
+					digest r;
+					r.fill(0);
+					return size() ? levels.back()[0] : r;
+				}
+
+				proof prove(size_t index) const {
+					proof p = {index, {}};
+					for(size_t l = 0; l + 1 < levels.size(); l++, index /= 2)
+						if((index ^ 1) < levels[l].size())
+							p.path.push_back(levels[l][index ^ 1]);
+					return p;
+				}
+
+				// leaf is the digest given to build() and size the leaf count of the tree that root belongs to, as the verifier knows it
+				static bool verify(const digest& root, size_t size, const digest& leaf, const proof& p) {
+					bool ok;
+					return verify_many(root, size, &leaf, &p, 1, &ok) == 1;
+				}
+				// checks count proofs against one root of a size leaves tree, proofs of the same level are hashed together across the
+				// lanes; writes each outcome to ok (when not null) and returns how many passed
+				static size_t verify_many(const digest& root, size_t size, const digest* leaves, const proof* proofs, size_t count, bool* ok = nullptr) {
+
+					struct walk_t {
+						digest node;
+						size_t index, width, used;
+						bool failed;
+					};
+
+					std::vector<walk_t> walk(count);
+					std::vector<std::array<uint8_t, digest::bytes * 2>> blocks;
+					std::vector<size_t> owner;
+					std::vector<digest> hashed;
+
+					hashed.resize(count);
+					nodes::run(1, count, [&](size_t i) {
+						return leaves[i].data();
+					}, hashed.data());
+					for(size_t i = 0; i < count; i++)
+						walk[i] = {hashed[i], proofs[i].index, size, 0, proofs[i].index >= size};
+
+					while(true) {
+
+						blocks.clear();
+						owner.clear();
+
+						for(size_t i = 0; i < count; i++) {
+							walk_t& w = walk[i];
+							const std::vector<digest>& path = proofs[i].path;
+							// unpaired nodes move up without a hash
+							while(!w.failed && w.width > 1 && (w.index ^ 1) >= w.width) {
+								w.index /= 2;
+								w.width  = (w.width + 1) / 2;
+							}
+							if(w.failed || w.width <= 1)
+								continue;
+							if(w.used == path.size()) {
+								w.failed = true;
+								continue;
+							}
+							const digest& sibling = path[w.used++];
+							blocks.emplace_back();
+							std::copy(w.index & 1 ? sibling.begin() : w.node.begin(), w.index & 1 ? sibling.end() : w.node.end(), blocks.back().begin());
+							std::copy(w.index & 1 ? w.node.begin() : sibling.begin(), w.index & 1 ? w.node.end() : sibling.end(), blocks.back().begin() + digest::bytes);
+							owner.push_back(i);
+						}
+
+						if(blocks.empty())
+							break;
+
+						hashed.resize(blocks.size());
+						nodes::run(2, blocks.size(), [&](size_t j) {
+							return blocks[j].data();
+						}, hashed.data());
+
+						for(size_t j = 0; j < owner.size(); j++) {
+							walk_t& w = walk[owner[j]];
+							w.node   = hashed[j];
+							w.index /= 2;
+							w.width  = (w.width + 1) / 2;
+						}
+					}
+
+					size_t passed = 0;
+					for(size_t i = 0; i < count; i++) {
+						bool good = !walk[i].failed && walk[i].used == proofs[i].path.size() && walk[i].node == root;
+						if(ok)
+							ok[i] = good;
+						passed += good;
+					}
+					return passed;
+				}
+
+			private:
+
+				std::vector<std::vector<digest>> levels;
+
+		};
+
+		// content defined chunking (fastcdc) of a stream with a digest per chunk (sha2::hasher_*), for deduplication: chunks found in
+		// one update() are hashed there, a few at a time across the simd lanes while still in cache, a chunk spanning several update()
+		// calls is hashed as it comes in, so the data is never buffered
+		template<class Hasher>
+		class cdc_chunker {
+
+			typedef typename Hasher::base_type base;
+
+			public:
+
+				static constexpr size_t bits = Hasher::bits;
+
+				struct chunk {
+					uint64_t offset;	// from the start of the stream
+					size_t size;
+					sha_t<bits> digest;
+				};
+
+				explicit cdc_chunker(size_t min_size = 2048, size_t avg_size = 8192, size_t max_size = 65536) : cuts(min_size, avg_size, max_size), offset(0) {}
+
+				// sink(const chunk&) gets every chunk ending in msg, in stream order
+				template<class T, class Sink>
+				cdc_chunker& update(const T* msg, size_t byte_len, Sink sink) {
+
+					const uint8_t* data = reinterpret_cast<const uint8_t*>(msg);
+					size_t lanes;
+					base::batch(lanes);
+
+					for(size_t begin = 0, used; begin < byte_len; begin += used) {
+
+						size_t carried = cuts.pending();
+						if(!cuts.next(&data[begin], byte_len - begin, used)) {
+							open.update(&data[begin], used);
+							break;
+						}
+
+						if(carried) {
+							open.update(&data[begin], used);
+							chunk c = {offset, carried + used, open.finalize()};
+							open.reset();
+							sink(static_cast<const chunk&>(c));
+						}
+						else {
+							queued.push_back({offset, used, sha_t<bits>()});
+							parts.push_back({&data[begin], used});
+							if(parts.size() >= lanes * 2)
+								flush(sink);
+						}
+						offset += carried + used;
+					}
+
+					flush(sink);
+					return *this;
+				}
+
+				// ends the stream: the open chunk (if any) goes to sink, then the chunker is ready for a new stream
+				template<class Sink>
+				void finish(Sink sink) {
+					if(cuts.pending()) {
+						chunk c = {offset, cuts.pending(), open.finalize()};
+						sink(static_cast<const chunk&>(c));
+					}
+					cuts.reset();
+					open.reset();
+					offset = 0;
+				}
+
+				// every chunk of an in-memory buffer
+				template<class T>
+				static std::vector<chunk> split(const T* msg, size_t byte_len, size_t min_size = 2048, size_t avg_size = 8192, size_t max_size = 65536) {
+					std::vector<chunk> out;
+					auto sink = [&](const chunk& c) {
+						out.push_back(c);
+					};
+					cdc_chunker(min_size, avg_size, max_size).update(msg, byte_len, sink).finish(sink);
+					return out;
+				}
+
+			private:
+
+				template<class Sink>
+				void flush(Sink& sink) {
+					if(parts.empty())
+						return;
+					digests.resize(parts.size());
+					base::hash_many(parts.data(), parts.size(), digests.data());
+					for(size_t i = 0; i < queued.size(); i++) {
+						queued[i].digest = digests[i];
+						sink(static_cast<const chunk&>(queued[i]));
+					}
+					queued.clear();
+					parts.clear();
+				}
+
+				__sha_details::__shared::_gear_chunker cuts;
+				Hasher open;
+				uint64_t offset;
+				std::vector<chunk> queued;
+				std::vector<buffer> parts;
+				std::vector<sha_t<bits>> digests;
+
 		};
 
 	}
@@ -0,0 +1,236 @@
+#pragma once
+
+#ifndef __NEO_SHA_ASYNC_HPP__
+#define __NEO_SHA_ASYNC_HPP__
+
+
+/*
+*	Notes:
+*		- Asynchronous stream hashing over sha.hpp, callback based from c++11, co_await-able from c++20 (with <coroutine>)
+*		- A source is any object with async_read(uint8_t* buf, size_t cap, Fn done) that calls done(size_t n, std::error_code ec)
+*		  exactly once, from any thread (or before returning), with n == 0 at the end of the stream
+*/
+
+
+#include "sha.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define __NEO_SHA_COROUTINES
+#endif
+#endif
+
+
+
+namespace neo {
+
+	namespace hash {
+
+		// fixed size chunks kept for reuse once released, so thousands of streams in flight don't go through the allocator on every
+		// update(); thread safe
+		class chunk_pool {
+
+			public:
+
+				explicit chunk_pool(size_t chunk_size = size_t(64) << 10, size_t max_free = 1024)
+					: size(std::max<size_t>(chunk_size - chunk_size % 128, 128)), keep(max_free) {}
+				~chunk_pool() {
+					for(uint8_t* c : free_list)
+						::operator delete(c);
+				}
+
+				chunk_pool(const chunk_pool&) = delete;
+				chunk_pool& operator=(const chunk_pool&) = delete;
+
+				// a multiple of every block size (128 bytes)
+				size_t chunk_size() const {
+					return size;
+				}
+
+				uint8_t* acquire() {
+					{
+						std::lock_guard<std::mutex> lock(mtx);
+						if(!free_list.empty()) {
+							uint8_t* c = free_list.back();
+							free_list.pop_back();
+							return c;
+						}
+					}
+					return static_cast<uint8_t*>(::operator new(size));
+				}
+				void release(uint8_t* c) {
+					{
+						std::lock_guard<std::mutex> lock(mtx);
+						if(free_list.size() < keep) {
+							free_list.push_back(c);
+							return;
+						}
+					}
+					::operator delete(c);
+				}
+
+				// shared by every async_hasher not given a pool of its own
+				static chunk_pool& global() {
+					static chunk_pool pool;
+					return pool;
+				}
+
+			private:
+
+				const size_t size, keep;
+				std::vector<uint8_t*> free_list;
+				std::mutex mtx;
+
+		};
+
+		// feeds a Hasher from an asynchronous source with two pooled chunks: while one chunk is compressed the next read is already in
+		// flight on the other, the compression runs on whichever thread delivered the read (so the i/o pool is the hashing pool);
+		// one update() at a time, the object must outlive its completion
+		template<class Hasher>
+		class async_hasher {
+
+			public:
+
+				static constexpr size_t bits = Hasher::bits;
+
+				typedef std::function<void(std::error_code)> done_fn;
+				typedef std::function<void(size_t, std::error_code)> read_fn;
+
+				explicit async_hasher(chunk_pool& chunks = chunk_pool::global()) : pool(&chunks), pending(0) {}
+
+				async_hasher(const async_hasher&) = delete;
+				async_hasher& operator=(const async_hasher&) = delete;
+
+				// reads src to its end into the hash, then calls done(ec) (ec set by the failed read, the data before it stays hashed)
+				template<class Source>
+				void update(Source& src, done_fn done) {
+
+					on_done  = std::move(done);
+					chunk[0] = pool->acquire();
+					chunk[1] = pool->acquire();
+					cur = 0;
+
+					src.async_read(chunk[0], pool->chunk_size(), read_fn([this, &src](size_t n, std::error_code ec) { step(src, n, ec); }));
+				}
+
+				#ifdef __NEO_SHA_COROUTINES
+				template<class Source>
+				class update_awaiter {
+
+					public:
+
+						update_awaiter(async_hasher& h, Source& s) : hasher(h), src(s), arrived(false) {}
+
+						bool await_ready() const {
+							return false;
+						}
+						// a source completing before update() returns skips the suspension, otherwise the completion resumes the caller
+						bool await_suspend(std::coroutine_handle<> caller) {
+							handle = caller;
+							hasher.update(src, [this](std::error_code e) {
+								ec = e;
+								if(arrived.exchange(true, std::memory_order_acq_rel))
+									handle.resume();
+							});
+							return !arrived.exchange(true, std::memory_order_acq_rel);
+						}
+						std::error_code await_resume() const {
+							return ec;
+						}
+
+					private:
+
+						async_hasher& hasher;
+						Source& src;
+						std::coroutine_handle<> handle;
+						std::error_code ec;
+						std::atomic<bool> arrived;
+
+				};
+
+				// co_await h.update(src) reads src to its end into the hash and yields the error of the failed read, if any
+				template<class Source>
+				update_awaiter<Source> update(Source& src) {
+					return update_awaiter<Source>(*this, src);
+				}
+				#endif
+
+				sha_t<bits> finalize() const {
+					return hasher.finalize();
+				}
+				void reset() {
+					hasher.reset();
+				}
+
+			private:
+
+				// chunk[cur] holds n bytes: the next read goes to the other chunk while this one is compressed, the last of the two
+				// to finish carries on, in this loop when the read was first so synchronous sources don't grow the stack
+				template<class Source>
+				void step(Source& src, size_t n, std::error_code ec) {
+
+					while(true) {
+
+						if(ec || !n)
+							return finish(ec);
+
+						const uint8_t* full = chunk[cur];
+						cur ^= 1;
+						pending.store(2, std::memory_order_relaxed);
+
+						src.async_read(chunk[cur], pool->chunk_size(), read_fn([this, &src](size_t r, std::error_code e) {
+							next_n  = r;
+							next_ec = e;
+							if(arrive())
+								step(src, next_n, next_ec);
+						}));
+
+						hasher.update(full, n);
+						if(!arrive())
+							return;
+
+						n  = next_n;
+						ec = next_ec;
+					}
+				}
+				bool arrive() {
+					return pending.fetch_sub(1, std::memory_order_acq_rel) == 1;
+				}
+				// done may destroy this object, nothing is touched after it
+				void finish(std::error_code ec) {
+					pool->release(chunk[0]);
+					pool->release(chunk[1]);
+					done_fn done = std::move(on_done);
+					done(ec);
+				}
+
+				Hasher hasher;
+				chunk_pool* pool;
+				uint8_t* chunk[2];
+				size_t cur;
+				done_fn on_done;
+				std::atomic<int> pending;
+				size_t next_n;
+				std::error_code next_ec;
+
+		};
+
+	}
+
+}
+
+
+
+#endif
@@ -0,0 +1,458 @@
+#pragma once
+
+#ifndef __NEO_SHA_CACHE_HPP__
+#define __NEO_SHA_CACHE_HPP__
+
+
+/*
+*	Notes:
+*		- Persistent file digest cache over sha.hpp, POSIX only (open / fstat / mmap / flock)
+*		- The index file is append-only and shared by any number of processes, records are kept per platform (no byte swapping)
+*/
+
+
+#include "sha.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+
+namespace neo {
+
+	namespace hash {
+
+		namespace __sha_details {
+
+			namespace __cache {
+
+				// index layout: a 64 byte header, then fixed size records, a later record overrides an earlier one with the same key
+				struct header {
+					char magic[8];
+					uint32_t version;
+					uint32_t record_size;
+					uint8_t reserved[48];
+				};
+
+				struct key {
+					uint64_t dev, ino, size;
+					int64_t mtime_ns, ctime_ns;
+					uint64_t algorithm;	// first 8 bytes of the algorithm's digest of "", with bits below it tells the algorithms apart
+					uint32_t bits;
+					uint32_t reserved;
+
+					bool operator==(const key& o) const {
+						return std::memcmp(this, &o, sizeof(key)) == 0;
+					}
+				};
+
+				struct record {
+					key k;
+					uint8_t digest[64];
+					uint64_t check;		// fnv-1a of the bytes above, torn or foreign records fail it
+				};
+
+				static_assert(sizeof(header) == 64 && sizeof(key) == 56 && sizeof(record) == 128, "unexpected index record layout");
+
+				inline uint64_t _fnv1a(const void* p, size_t n) {
+					const uint8_t* b = static_cast<const uint8_t*>(p);
+					uint64_t h = 0xCBF29CE484222325ULL;
+					for(size_t i = 0; i < n; i++)
+						h = (h ^ b[i]) * 0x100000001B3ULL;
+					return h;
+				}
+
+				struct key_hash {
+					size_t operator()(const key& k) const {
+						return static_cast<size_t>(_fnv1a(&k, sizeof(key)));
+					}
+				};
+
+				inline int64_t _ns(const struct timespec& ts) {
+					return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+				}
+				inline int64_t _mtime_ns(const struct stat& st) {
+					#ifdef __APPLE__
+					return _ns(st.st_mtimespec);
+					#else
+					return _ns(st.st_mtim);
+					#endif
+				}
+				inline int64_t _ctime_ns(const struct stat& st) {
+					#ifdef __APPLE__
+					return _ns(st.st_ctimespec);
+					#else
+					return _ns(st.st_ctim);
+					#endif
+				}
+
+				inline std::system_error _error(const std::string& what) {
+					return std::system_error(errno, std::generic_category(), what);
+				}
+
+			}
+
+		}
+
+		// on-disk (dev, inode, size, mtime, ctime, algorithm) -> digest index: a file whose stat() still matches its record is not read
+		// again, any change to it changes the key so stale records just stop matching (compact() drops them); safe for any number
+		// of readers and writers across threads and processes, writers append whole records under flock()
+		class digest_cache {
+
+			typedef __sha_details::__cache::key key;
+			typedef __sha_details::__cache::record record;
+			typedef __sha_details::__cache::header header;
+
+			public:
+
+				explicit digest_cache(const std::string& index_path) : path(index_path), fd(-1), loaded(sizeof(header)) {
+					open_index();
+				}
+				~digest_cache() {
+					if(fd >= 0)
+						::close(fd);
+				}
+
+				digest_cache(const digest_cache&) = delete;
+				digest_cache& operator=(const digest_cache&) = delete;
+
+				// digest of the file at file_path: one stat() when the index has it, otherwise the file is hashed and recorded;
+				// throws std::system_error when the file can't be read
+				template<class Hasher>
+				sha_t<Hasher::bits> hash_file(const std::string& file_path) {
+
+					sha_t<Hasher::bits> d;
+					struct stat st;
+					if(::stat(file_path.c_str(), &st) == 0 && lookup<Hasher>(st, d))
+						return d;
+
+					int f = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+					if(f < 0)
+						throw __sha_details::__cache::_error(file_path);
+
+					struct stat before, after;
+					bool ok = ::fstat(f, &before) == 0 && read_all<Hasher>(f, d) && ::fstat(f, &after) == 0;
+					int err = errno;
+					::close(f);
+					if(!ok) {
+						errno = err;
+						throw __sha_details::__cache::_error(file_path);
+					}
+
+					// not recorded when the file changed while it was read, or when a write in the same timestamp tick could still go unseen
+					key k = make_key<Hasher>(before);
+					struct timespec now;
+					::clock_gettime(CLOCK_REALTIME, &now);
+					if(k == make_key<Hasher>(after) && __sha_details::__cache::_ns(now) - k.mtime_ns >= 1000000000)
+						insert(k, d);
+
+					return d;
+				}
+
+				// the indexed digest of a file with this stat(), false when there's none; a miss only loads the records appended since
+				// (one fstat() when there are none), an index compacted by someone else is picked up by refresh() or the next insert
+				template<class Hasher>
+				bool lookup(const struct stat& st, sha_t<Hasher::bits>& out) {
+					key k = make_key<Hasher>(st);
+					std::lock_guard<std::mutex> lock(mtx);
+					auto it = entries.find(k);
+					if(it == entries.end()) {
+						load_appended();
+						it = entries.find(k);
+						if(it == entries.end())
+							return false;
+					}
+					std::copy(it->second.begin(), it->second.begin() + sha_t<Hasher::bits>::bytes, out.begin());
+					return true;
+				}
+
+				// loads the records appended by other processes (or the new index left by their compact()) since the last call
+				void refresh() {
+					std::lock_guard<std::mutex> lock(mtx);
+					refresh_locked();
+				}
+
+				// rewrites the index with one record per (file, algorithm), the newest; readers keep their old mapping until they
+				// refresh, returns the records kept
+				size_t compact() {
+
+					struct file_key {
+						uint64_t dev, ino, algorithm;
+						uint32_t bits;
+						bool operator==(const file_key& o) const {
+							return dev == o.dev && ino == o.ino && algorithm == o.algorithm && bits == o.bits;
+						}
+					};
+					struct file_hash {
+						size_t operator()(const file_key& k) const {
+							return static_cast<size_t>(k.dev * 31 + k.ino * 0x9E3779B97F4A7C15ULL + k.algorithm + k.bits);
+						}
+					};
+
+					std::lock_guard<std::mutex> lock(mtx);
+					lock_current();
+
+					std::vector<record> keep;
+					std::unordered_map<file_key, size_t, file_hash> slot;
+					size_t end = sizeof(header);
+					scan(end, [&](const record& r) {
+						file_key fk = {r.k.dev, r.k.ino, r.k.algorithm, r.k.bits};
+						auto it = slot.find(fk);
+						if(it == slot.end()) {
+							slot[fk] = keep.size();
+							keep.push_back(r);
+						}
+						else
+							keep[it->second] = r;
+					});
+
+					std::string tmp = path + ".tmp." + std::to_string(::getpid());
+					int t = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+					bool ok = t >= 0;
+					if(ok) {
+						header h = make_header();
+						ok = write_all(t, &h, sizeof(h)) && (keep.empty() || write_all(t, keep.data(), keep.size() * sizeof(record))) && ::fsync(t) == 0;
+						ok = ::close(t) == 0 && ok && ::rename(tmp.c_str(), path.c_str()) == 0;
+					}
+					if(!ok) {
+						int err = errno;
+						::unlink(tmp.c_str());
+						unlock_file();
+						errno = err;
+						throw __sha_details::__cache::_error(path);
+					}
+
+					// the old file is gone from the path, writers waiting on its lock see that and reopen
+					unlock_file();
+					::close(fd);
+					fd = -1;
+					open_index();
+					return keep.size();
+				}
+
+				// records currently known (newest per key)
+				size_t size() const {
+					std::lock_guard<std::mutex> lock(mtx);
+					return entries.size();
+				}
+
+			private:
+
+				static header make_header() {
+					header h = {};
+					std::memcpy(h.magic, "NEOSHAC", 8);
+					h.version     = 1;
+					h.record_size = sizeof(record);
+					return h;
+				}
+
+				template<class Hasher>
+				static uint64_t algorithm_id() {
+					static const uint64_t id = [] {
+						sha_t<Hasher::bits> e = Hasher().finalize();
+						uint64_t v = 0;
+						std::memcpy(&v, e.data(), std::min<size_t>(8, e.size()));
+						return v;
+					}();
+					return id;
+				}
+
+				template<class Hasher>
+				static key make_key(const struct stat& st) {
+					static_assert(Hasher::bits <= 512, "digests above 512 bits can't be cached");
+					key k = {};
+					k.dev       = static_cast<uint64_t>(st.st_dev);
+					k.ino       = static_cast<uint64_t>(st.st_ino);
+					k.size      = static_cast<uint64_t>(st.st_size);
+					k.mtime_ns  = __sha_details::__cache::_mtime_ns(st);
+					k.ctime_ns  = __sha_details::__cache::_ctime_ns(st);
+					k.algorithm = algorithm_id<Hasher>();
+					k.bits      = static_cast<uint32_t>(Hasher::bits);
+					return k;
+				}
+
+				template<class Hasher>
+				static bool read_all(int f, sha_t<Hasher::bits>& out) {
+					static thread_local std::vector<uint8_t> buf(size_t(1) << 20);
+					Hasher h;
+					#ifdef POSIX_FADV_SEQUENTIAL
+					::posix_fadvise(f, 0, 0, POSIX_FADV_SEQUENTIAL);
+					#endif
+					while(true) {
+						ssize_t n = ::read(f, buf.data(), buf.size());
+						if(n < 0 && errno == EINTR)
+							continue;
+						if(n < 0)
+							return false;
+						if(n == 0)
+							break;
+						h.update(buf.data(), static_cast<size_t>(n));
+					}
+					out = h.finalize();
+					return true;
+				}
+
+				static bool write_all(int f, const void* p, size_t n) {
+					const char* c = static_cast<const char*>(p);
+					while(n) {
+						ssize_t w = ::write(f, c, n);
+						if(w < 0 && errno == EINTR)
+							continue;
+						if(w <= 0)
+							return false;
+						c += w;
+						n -= static_cast<size_t>(w);
+					}
+					return true;
+				}
+
+				void open_index() {
+
+					fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+					if(fd < 0)
+						throw __sha_details::__cache::_error(path);
+
+					// the first opener writes the header
+					lock_file();
+					struct stat st;
+					if(::fstat(fd, &st) == 0 && st.st_size == 0) {
+						header h = make_header();
+						write_all(fd, &h, sizeof(h));
+					}
+					unlock_file();
+
+					header h;
+					header want = make_header();
+					if(::pread(fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h)) || std::memcmp(&h, &want, sizeof(h)) != 0) {
+						::close(fd);
+						fd = -1;
+						throw std::runtime_error("digest_cache: " + path + " is not a digest index of this version / platform");
+					}
+
+					struct stat id;
+					::fstat(fd, &id);
+					file_dev = id.st_dev;
+					file_ino = id.st_ino;
+
+					entries.clear();
+					loaded = sizeof(header);
+					refresh_locked();
+				}
+
+				// true when the path now names another file (compacted by someone), then the index is reopened and reloaded
+				bool replaced() {
+					struct stat st;
+					if(::stat(path.c_str(), &st) != 0 || (st.st_dev == file_dev && st.st_ino == file_ino))
+						return false;
+					::close(fd);
+					fd = -1;
+					open_index();
+					return true;
+				}
+
+				void refresh_locked() {
+					if(!replaced())
+						load_appended();
+				}
+				void load_appended() {
+					scan(loaded, [this](const record& r) {
+						std::copy(r.digest, r.digest + 64, entries[r.k].begin());
+					});
+				}
+
+				// fn(record) for every intact record from offset from on, from ends past the last whole record
+				template<class Fn>
+				bool scan(size_t& from, Fn fn) {
+
+					struct stat st;
+					if(::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(header))
+						return false;
+					size_t end = sizeof(header) + (static_cast<size_t>(st.st_size) - sizeof(header)) / sizeof(record) * sizeof(record);
+					if(end <= from)
+						return true;
+
+					void* map = ::mmap(nullptr, end, PROT_READ, MAP_SHARED, fd, 0);
+					if(map == MAP_FAILED)
+						return false;
+
+					const uint8_t* base = static_cast<const uint8_t*>(map);
+					for(; from < end; from += sizeof(record)) {
+						record r;
+						std::memcpy(&r, &base[from], sizeof(record));
+						if(r.check == __sha_details::__cache::_fnv1a(&r, offsetof(record, check)))
+							fn(r);
+					}
+					::munmap(map, end);
+					return true;
+				}
+
+				template<size_t Bits>
+				void insert(const key& k, const sha_t<Bits>& d) {
+
+					record r;
+					std::memset(&r, 0, sizeof(r));
+					r.k = k;
+					std::copy(d.begin(), d.end(), r.digest);
+					r.check = __sha_details::__cache::_fnv1a(&r, offsetof(record, check));
+
+					std::lock_guard<std::mutex> lock(mtx);
+
+					// writers append whole records one at a time, after cutting off the tail of one that died halfway
+					lock_current();
+					struct stat st;
+					if(::fstat(fd, &st) == 0 && (static_cast<size_t>(st.st_size) - sizeof(header)) % sizeof(record))
+						if(::ftruncate(fd, sizeof(header) + (static_cast<size_t>(st.st_size) - sizeof(header)) / sizeof(record) * sizeof(record)) != 0)
+							return unlock_file();
+					write_all(fd, &r, sizeof(r));
+					unlock_file();
+
+					refresh_locked();
+				}
+
+				void lock_file() {
+					while(::flock(fd, LOCK_EX) != 0 && errno == EINTR) {}
+				}
+				void unlock_file() {
+					::flock(fd, LOCK_UN);
+				}
+				// locks the file the path names right now
+				void lock_current() {
+					lock_file();
+					while(replaced())
+						lock_file();
+				}
+
+				std::string path;
+				int fd;
+				dev_t file_dev;
+				ino_t file_ino;
+				size_t loaded;	// bytes of the index already read into entries
+				std::unordered_map<key, std::array<uint8_t, 64>, __sha_details::__cache::key_hash> entries;
+				mutable std::mutex mtx;
+
+		};
+
+	}
+
+}
+
+
+
+#endif
@@ -0,0 +1,248 @@
+/*
+*	async_tests: async_hasher over synchronous and threaded sources, short reads, failed reads and many streams at once, co_await under c++20
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I. tests/async_tests.cpp -o async_tests -lpthread
+*		g++ -std=c++20 -O2 -I. tests/async_tests.cpp -o async_tests -lpthread		(co_await too)
+*
+*	Usage:
+*		async_tests [--quick]
+*/
+
+
+#include "sha_test.hpp"
+#include "sha_async.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using namespace neo::hash;
+using namespace sha_test;
+
+
+
+// the completion threads of an i/o library
+class io_pool {
+
+	public:
+
+		explicit io_pool(size_t threads) : stop(false) {
+			for(size_t i = 0; i < threads; i++)
+				workers.emplace_back([this] {
+					while(true) {
+						std::function<void()> job;
+						{
+							std::unique_lock<std::mutex> lock(mtx);
+							wake.wait(lock, [this] { return stop || !jobs.empty(); });
+							if(jobs.empty())
+								return;
+							job = std::move(jobs.front());
+							jobs.pop_front();
+						}
+						job();
+					}
+				});
+		}
+		~io_pool() {
+			{
+				std::lock_guard<std::mutex> lock(mtx);
+				stop = true;
+			}
+			wake.notify_all();
+			for(std::thread& t : workers)
+				t.join();
+		}
+
+		void post(std::function<void()> job) {
+			{
+				std::lock_guard<std::mutex> lock(mtx);
+				jobs.push_back(std::move(job));
+			}
+			wake.notify_one();
+		}
+
+	private:
+
+		std::vector<std::thread> workers;
+		std::deque<std::function<void()>> jobs;
+		std::mutex mtx;
+		std::condition_variable wake;
+		bool stop;
+
+};
+
+// reads data in pieces of at most max_read bytes (0: as much as asked), fails with an error at fail_at; completes before returning,
+// or on an io_pool thread when given one
+struct source {
+
+	const std::vector<uint8_t>* data;
+	size_t pos, max_read, fail_at;
+	io_pool* io;
+
+	template<class Fn>
+	void async_read(uint8_t* buf, size_t cap, Fn done) {
+		size_t n = std::min(cap, data->size() - pos);
+		if(max_read)
+			n = std::min(n, 1 + (pos * 7919) % max_read);
+		std::error_code ec;
+		if(pos + n > fail_at) {
+			n = 0;
+			ec = std::make_error_code(std::errc::io_error);
+		}
+		std::memcpy(buf, data->data() + pos, n);
+		pos += n;
+		if(io)
+			io->post([done, n, ec] { done(n, ec); });
+		else
+			done(n, ec);
+	}
+
+};
+
+// waits for count callbacks
+class latch {
+
+	public:
+
+		explicit latch(size_t count) : left(count) {}
+
+		void arrive() {
+			std::lock_guard<std::mutex> lock(mtx);
+			if(!--left)
+				all.notify_all();
+		}
+		void wait() {
+			std::unique_lock<std::mutex> lock(mtx);
+			all.wait(lock, [this] { return !left; });
+		}
+
+	private:
+
+		size_t left;
+		std::mutex mtx;
+		std::condition_variable all;
+
+};
+
+static void streams(io_pool* io, const char* what) {
+
+	chunk_pool pool(1000, 16);
+	const size_t streams = 64;
+
+	for(size_t size : {size_t(0), size_t(1), size_t(127), size_t(128), size_t(895), size_t(896), size_t(897), size_t(65537), size_t(quick ? 300000 : 3000000)}) {
+		for(size_t max_read : {size_t(0), size_t(1000), size_t(37)}) {
+
+			if(max_read == 37 && size > 100000)
+				continue;
+			const std::string at = std::string(what) + ", " + std::to_string(size) + " bytes read by up to " + std::to_string(max_read);
+			const std::vector<uint8_t> data = noise(size, size);
+
+			// streams at once, the failing ones (every 4th, when there's data) stop at a third of the data
+			std::vector<source> src(streams);
+			std::vector<std::unique_ptr<async_hasher<sha2::hasher_256>>> h(streams);
+			std::vector<std::error_code> ec(streams);
+			latch done(streams);
+			for(size_t i = 0; i < streams; i++) {
+				src[i] = source{&data, 0, max_read, i % 4 == 3 && size ? size / 3 : ~size_t(0), io};
+				h[i].reset(new async_hasher<sha2::hasher_256>(pool));
+			}
+			for(size_t i = 0; i < streams; i++)
+				h[i]->update(src[i], [&, i](std::error_code e) {
+					ec[i] = e;
+					done.arrive();
+				});
+			done.wait();
+
+			bool ok = true, failed = true;
+			const sha_t<256> whole = sha2::hash_256(data.data(), data.size());
+			for(size_t i = 0; i < streams; i++) {
+				if(src[i].fail_at == ~size_t(0))
+					ok &= !ec[i] && h[i]->finalize() == whole;
+				else
+					failed &= ec[i] == std::errc::io_error && h[i]->finalize() == sha2::hash_256(data.data(), src[i].pos);
+			}
+			check(ok, at);
+			check(failed, at + ", failed reads");
+
+			// once more on the same object after reset()
+			h[0]->reset();
+			src[0] = source{&data, 0, max_read, ~size_t(0), io};
+			latch again(1);
+			h[0]->update(src[0], [&](std::error_code e) {
+				ec[0] = e;
+				again.arrive();
+			});
+			again.wait();
+			check(!ec[0] && h[0]->finalize() == whole, at + ", after reset()");
+		}
+	}
+
+	check(pool.chunk_size() == 896 && chunk_pool(10).chunk_size() == 128, "chunk sizes are whole 128 byte blocks");
+	uint8_t* c = pool.acquire();
+	pool.release(c);
+	check(pool.acquire() == c, "released chunk not reused");
+	pool.release(c);
+}
+
+
+
+#ifdef __NEO_SHA_COROUTINES
+// a coroutine that starts at once and signals a latch at its end
+struct detached {
+	struct promise_type {
+		detached get_return_object() {
+			return {};
+		}
+		std::suspend_never initial_suspend() noexcept {
+			return {};
+		}
+		std::suspend_never final_suspend() noexcept {
+			return {};
+		}
+		void return_void() {}
+		void unhandled_exception() {
+			std::terminate();
+		}
+	};
+};
+
+static detached hash_with_co_await(async_hasher<sha2::hasher_256>& h, source& src, std::error_code& ec, latch& done) {
+	ec = co_await h.update(src);
+	done.arrive();
+}
+
+static void coroutines(io_pool* io, const char* what) {
+	const std::vector<uint8_t> data = noise(200000, 5);
+	for(size_t fail_at : {~size_t(0), size_t(100000)}) {
+		const std::string at = std::string(what) + (fail_at == ~size_t(0) ? ", co_await" : ", co_await with a failed read");
+		source src{&data, 0, 5000, fail_at, io};
+		async_hasher<sha2::hasher_256> h;
+		std::error_code ec;
+		latch done(1);
+		hash_with_co_await(h, src, ec, done);
+		done.wait();
+		check(ec == (fail_at == ~size_t(0) ? std::error_code() : std::make_error_code(std::errc::io_error)) && h.finalize() == sha2::hash_256(data.data(), src.pos), at);
+	}
+}
+#endif
+
+
+
+int main(int argc, char* argv[]) {
+	init(argc, argv);
+	io_pool io(4);
+	streams(nullptr, "synchronous");
+	streams(&io, "on 4 threads");
+	#ifdef __NEO_SHA_COROUTINES
+	coroutines(nullptr, "synchronous");
+	coroutines(&io, "on 4 threads");
+	#endif
+	return done();
+}
@@ -0,0 +1,150 @@
+/*
+*	batch_tests: *_many batches against one message at a time, under every backend and while another thread switches backends
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I. tests/batch_tests.cpp -o batch_tests -lpthread
+*
+*	Usage:
+*		batch_tests [--quick]
+*/
+
+
+#include "sha_test.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using namespace neo::hash;
+using namespace sha_test;
+
+
+
+// every count up to a few times the widest lane count, so full, partial and single-message batches all run, with unequal
+// lengths finishing at different steps; then equal lengths, which run in lockstep to the end
+template<size_t Bits, class OneShot, class Many>
+static void batch(const char* name, OneShot one_shot, Many many, std::vector<sha_t<Bits>>& reference) {
+
+	const std::vector<size_t> lens = lengths();
+	std::vector<std::vector<uint8_t>> msgs;
+	std::vector<buffer> bufs;
+	std::vector<sha_t<Bits>> want;
+	for(size_t i = 0; i < lens.size(); i++)
+		msgs.push_back(noise(lens[i], static_cast<uint32_t>(i)));
+	for(const std::vector<uint8_t>& m : msgs) {
+		bufs.push_back({m.data(), m.size()});
+		want.push_back(one_shot(m.data(), m.size()));
+	}
+
+	for(size_t count = 1; count <= 40; count++) {
+		size_t first = (count * 37) % (bufs.size() - count);
+		std::vector<sha_t<Bits>> out(count);
+		many(&bufs[first], count, out.data());
+		for(size_t i = 0; i < count; i++)
+			check(out[i] == want[first + i], std::string(name) + " _many count " + std::to_string(count) + " item " + std::to_string(i));
+	}
+
+	std::vector<sha_t<Bits>> all(bufs.size());
+	many(bufs.data(), bufs.size(), all.data());
+	check(all == want, std::string(name) + " _many of every length");
+	check_same(reference, all, std::string(name) + " _many");
+
+	for(size_t len : {size_t(0), size_t(55), size_t(64), size_t(111), size_t(128), size_t(135), size_t(168), size_t(1000)}) {
+		const std::vector<uint8_t> m = noise(len * 33, static_cast<uint32_t>(len));
+		std::vector<buffer> same;
+		for(size_t i = 0; i < 33; i++)
+			same.push_back({m.data() + i * len, len});
+		std::vector<sha_t<Bits>> out(same.size());
+		many(same.data(), same.size(), out.data());
+		for(size_t i = 0; i < same.size(); i++)
+			check(out[i] == one_shot(m.data() + i * len, len), std::string(name) + " _many of equal length " + std::to_string(len));
+	}
+
+	sha_t<Bits> untouched;
+	untouched.fill(0xa5);
+	many(bufs.data(), 0, &untouched);
+	check(untouched[0] == 0xa5, std::string(name) + " _many of 0 messages wrote");
+}
+
+struct references {
+	std::vector<sha_t<224>> sha224, sha512_224, sha3_224;
+	std::vector<sha_t<256>> sha256, sha512_256, sha3_256, shake128;
+	std::vector<sha_t<384>> sha384, sha3_384;
+	std::vector<sha_t<512>> sha512, sha3_512, shake256;
+};
+
+// with sha_ni the automatic sha256 batches run one message at a time on it rather than on the avx2 / avx-512 lanes
+static void automatic_pick() {
+	if(!sha2::set_backend_256(backend::sha_ni))
+		return;
+	force(backend::automatic);
+	check(sha2::active_batch_backend_256() == backend::sha_ni, std::string("automatic sha256 batches on ") + name(sha2::active_batch_backend_256()) + " with sha_ni");
+}
+
+// a thread cycling every backend while this one hashes single messages and batches: each digest must still be right (a switch
+// must never pair a kernel with the lane count or id of another one), run it under -fsanitize=thread too
+static void switching() {
+
+	const std::vector<uint8_t> msg = noise(3000, 9);
+	std::vector<buffer> bufs;
+	for(size_t len : {0, 1, 55, 64, 200, 1000, 3000, 129, 136, 2000, 7, 168, 500, 999, 64, 63, 1})
+		bufs.push_back(buffer{msg.data(), len});
+	std::vector<sha_t<256>> want256, want_sha3;
+	std::vector<sha_t<512>> want512;
+	for(const buffer& b : bufs) {
+		want256.push_back(sha2::hash_256(msg.data(), b.size));
+		want512.push_back(sha2::hash_512(msg.data(), b.size));
+		want_sha3.push_back(sha3::hash_256(msg.data(), b.size));
+	}
+	const sha_t<160> want1 = sha1::hash(msg.data(), msg.size());
+
+	std::atomic<bool> stop(false);
+	std::thread switcher([&] {
+		while(!stop.load())
+			for(backend b : {backend::scalar, backend::sha_ni, backend::avx2, backend::avx512, backend::automatic})
+				force(b);
+	});
+
+	bool ok = true;
+	std::vector<sha_t<256>> got256(bufs.size()), got_sha3(bufs.size());
+	std::vector<sha_t<512>> got512(bufs.size());
+	for(int round = 0; round < (quick ? 300 : 3000); round++) {
+		sha2::hash_256_many(bufs.data(), bufs.size(), got256.data());
+		sha2::hash_512_many(bufs.data(), bufs.size(), got512.data());
+		sha3::hash_256_many(bufs.data(), bufs.size(), got_sha3.data());
+		ok &= got256 == want256 && got512 == want512 && got_sha3 == want_sha3;
+		ok &= sha1::hash(msg.data(), msg.size()) == want1 && sha2::hash_256(msg.data(), 1000) == want256[5] && sha2::hash_512(msg.data(), 3000) == want512[6];
+	}
+	stop = true;
+	switcher.join();
+	force(backend::automatic);
+	check(ok, "hashing while another thread switches backends");
+}
+
+
+
+int main(int argc, char* argv[]) {
+	init(argc, argv);
+	automatic_pick();
+	references r;
+	for_each_backend([&] {
+		std::printf("%-9s sha256 %s, sha512 %s, keccak %s\n", context, name(sha2::active_batch_backend_256()),
+			name(sha2::active_batch_backend_512()), name(sha3::active_batch_backend()));
+		batch<224>("sha224", sha2::hash_224<uint8_t>, sha2::hash_224_many, r.sha224);
+		batch<256>("sha256", sha2::hash_256<uint8_t>, sha2::hash_256_many, r.sha256);
+		batch<384>("sha384", sha2::hash_384<uint8_t>, sha2::hash_384_many, r.sha384);
+		batch<512>("sha512", sha2::hash_512<uint8_t>, sha2::hash_512_many, r.sha512);
+		batch<224>("sha512/224", sha2::hash_512_224<uint8_t>, sha2::hash_512_224_many, r.sha512_224);
+		batch<256>("sha512/256", sha2::hash_512_256<uint8_t>, sha2::hash_512_256_many, r.sha512_256);
+		batch<224>("sha3-224", sha3::hash_224<uint8_t>, sha3::hash_224_many, r.sha3_224);
+		batch<256>("sha3-256", sha3::hash_256<uint8_t>, sha3::hash_256_many, r.sha3_256);
+		batch<384>("sha3-384", sha3::hash_384<uint8_t>, sha3::hash_384_many, r.sha3_384);
+		batch<512>("sha3-512", sha3::hash_512<uint8_t>, sha3::hash_512_many, r.sha3_512);
+		batch<256>("shake128", sha3::hash_shake_128<256, uint8_t>, sha3::hash_shake_128_many<256>, r.shake128);
+		batch<512>("shake256", sha3::hash_shake_256<512, uint8_t>, sha3::hash_shake_256_many<512>, r.shake256);
+	});
+	switching();
+	return done();
+}
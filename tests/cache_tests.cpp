@@ -0,0 +1,141 @@
+/*
+*	cache_tests: digest_cache hits, misses and invalidation on a scratch directory, shared by two instances, compacted and torn
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I. tests/cache_tests.cpp -o cache_tests -lpthread
+*
+*	Usage:
+*		cache_tests
+*/
+
+
+#include "sha_test.hpp"
+#include "sha_cache.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <sys/time.h>
+#include <unistd.h>
+
+
+using namespace neo::hash;
+using namespace sha_test;
+
+
+
+static std::string dir;
+
+static std::string write_file(const std::string& name, const std::vector<uint8_t>& data, bool aged = true) {
+	std::string p = dir + "/" + name;
+	FILE* f = std::fopen(p.c_str(), "wb");
+	std::fwrite(data.data(), 1, data.size(), f);
+	std::fclose(f);
+	if(aged) {
+		// a minute old, otherwise it's too fresh to be recorded
+		struct timeval tv[2];
+		::gettimeofday(&tv[0], nullptr);
+		tv[0].tv_sec -= 60;
+		tv[1] = tv[0];
+		::utimes(p.c_str(), tv);
+	}
+	return p;
+}
+
+template<class Hasher>
+static sha_t<Hasher::bits> direct(const std::vector<uint8_t>& data) {
+	return Hasher().update(data.data(), data.size()).finalize();
+}
+
+static void hits_and_misses() {
+
+	const std::string index = dir + "/index";
+	const std::vector<uint8_t> a = noise(5000, 1), b = noise(3 << 20, 2), empty;
+	const std::string pa = write_file("a", a), pb = write_file("b", b), pe = write_file("empty", empty);
+
+	digest_cache cache(index);
+	check(cache.size() == 0, "new index isn't empty");
+	check(cache.hash_file<sha2::hasher_256>(pa) == direct<sha2::hasher_256>(a), "sha256 of a");
+	check(cache.hash_file<sha2::hasher_256>(pb) == direct<sha2::hasher_256>(b), "sha256 of b");
+	check(cache.hash_file<sha2::hasher_256>(pe) == direct<sha2::hasher_256>(empty), "sha256 of an empty file");
+	check(cache.size() == 3, "3 records after 3 misses");
+	check(cache.hash_file<sha2::hasher_256>(pa) == direct<sha2::hasher_256>(a) && cache.size() == 3, "a hit adds no record");
+
+	// the algorithm is part of the key
+	check(cache.hash_file<sha2::hasher_512>(pa) == direct<sha2::hasher_512>(a), "sha512 of a");
+	check(cache.hash_file<sha2::hasher_224>(pa) == direct<sha2::hasher_224>(a), "sha224 of a");
+	check(cache.hash_file<sha1::hasher>(pa) == direct<sha1::hasher>(a), "sha1 of a");
+	check(cache.hash_file<sha3::hasher_256>(pa) == direct<sha3::hasher_256>(a), "sha3-256 of a");
+	check(cache.size() == 7, "a record per algorithm");
+
+	// the records are on disk: a second instance answers from them, and sees what the first appends later
+	digest_cache other(index);
+	check(other.size() == 7, "second instance loads the index");
+	sha_t<256> d;
+	struct stat st;
+	::stat(pb.c_str(), &st);
+	check(other.lookup<sha2::hasher_256>(st, d) && d == direct<sha2::hasher_256>(b), "second instance lookup");
+	const std::vector<uint8_t> c = noise(100, 3);
+	const std::string pc = write_file("c", c);
+	cache.hash_file<sha2::hasher_256>(pc);
+	::stat(pc.c_str(), &st);
+	check(other.lookup<sha2::hasher_256>(st, d) && d == direct<sha2::hasher_256>(c), "second instance sees an appended record");
+
+	// same size and mtime but new contents: ctime moved, so it's a miss
+	const std::vector<uint8_t> a2 = noise(5000, 4);
+	write_file("a", a2);
+	check(cache.hash_file<sha2::hasher_256>(pa) == direct<sha2::hasher_256>(a2), "rewritten file with the old size and mtime");
+	check(other.hash_file<sha2::hasher_256>(pa) == direct<sha2::hasher_256>(a2), "rewritten file, second instance");
+
+	// a fresh file is hashed but not recorded
+	const size_t before = cache.size();
+	const std::string pf = write_file("fresh", c, false);
+	check(cache.hash_file<sha2::hasher_256>(pf) == direct<sha2::hasher_256>(c) && cache.size() == before, "fresh file recorded");
+
+	check_throws<std::system_error>([&] {
+		cache.hash_file<sha2::hasher_256>(dir + "/missing");
+	}, "missing file");
+
+	// compact() keeps the newest record per (file, algorithm): a, b, empty and c for sha256, a for 4 others
+	check(cache.compact() == 8, "compact() count");
+	check(cache.hash_file<sha2::hasher_256>(pa) == direct<sha2::hasher_256>(a2) && cache.size() == 8, "hit after compact()");
+	// until then the second instance answers from what it has, a miss only looks for appended records
+	struct stat sf;
+	::stat(pf.c_str(), &sf);
+	::stat(pa.c_str(), &st);
+	check(!other.lookup<sha2::hasher_256>(sf, d) && other.lookup<sha2::hasher_256>(st, d) && d == direct<sha2::hasher_256>(a2), "second instance before refresh()");
+	other.refresh();
+	check(other.size() == 8, "second instance after refresh()");
+	check(other.hash_file<sha2::hasher_512>(pb) == direct<sha2::hasher_512>(b) && other.size() == 9, "append after compact()");
+	cache.refresh();
+	check(cache.size() == 9, "first instance sees the append to the compacted index");
+
+	// a half-written record at the tail is skipped, and trimmed by the next writer
+	FILE* f = std::fopen(index.c_str(), "ab");
+	std::fwrite(a.data(), 1, 50, f);
+	std::fclose(f);
+	digest_cache torn(index);
+	check(torn.size() == 9, "torn tail");
+	torn.hash_file<sha2::hasher_384>(pb);
+	digest_cache after(index);
+	check(after.size() == 10, "append after a torn tail");
+	check(after.hash_file<sha2::hasher_384>(pb) == direct<sha2::hasher_384>(b) && after.size() == 10, "record appended after a torn tail");
+}
+
+
+
+int main(int argc, char* argv[]) {
+	init(argc, argv);
+	char tmpl[] = "/tmp/cache_tests.XXXXXX";
+	if(!::mkdtemp(tmpl)) {
+		std::perror("mkdtemp");
+		return 2;
+	}
+	dir = tmpl;
+	hits_and_misses();
+	std::system(("rm -rf '" + dir + "'").c_str());
+	return done();
+}
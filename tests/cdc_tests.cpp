@@ -0,0 +1,118 @@
+/*
+*	cdc_tests: cdc_chunker boundaries and digests, the same however the stream is fed, under every backend
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I. tests/cdc_tests.cpp -o cdc_tests -lpthread
+*
+*	Usage:
+*		cdc_tests [--quick]
+*/
+
+
+#include "sha_test.hpp"
+
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+using namespace neo::hash;
+using namespace sha_test;
+
+
+
+template<class Hasher>
+static bool same_chunks(const std::vector<typename cdc_chunker<Hasher>::chunk>& a, const std::vector<typename cdc_chunker<Hasher>::chunk>& b) {
+	if(a.size() != b.size())
+		return false;
+	for(size_t i = 0; i < a.size(); i++)
+		if(a[i].offset != b[i].offset || a[i].size != b[i].size || a[i].digest != b[i].digest)
+			return false;
+	return true;
+}
+
+template<class Hasher>
+static void chunking(const char* name, size_t min_size, size_t avg_size, size_t max_size) {
+
+	typedef cdc_chunker<Hasher> chunker_t;
+	typedef typename chunker_t::chunk chunk;
+	const std::string at = std::string(name) + " " + std::to_string(min_size) + "/" + std::to_string(avg_size) + "/" + std::to_string(max_size);
+
+	// random data with a long run of zeros in the middle, where only max_size cuts
+	std::vector<uint8_t> data = noise(quick ? 1 << 20 : 4 << 20, 11);
+	std::fill(data.begin() + data.size() / 2, data.begin() + data.size() / 2 + std::min(5 * max_size, data.size() / 4), 0);
+	const std::vector<chunk> chunks = chunker_t::split(data.data(), data.size(), min_size, avg_size, max_size);
+
+	// contiguous, within the size limits (but the last), each digest the one of its bytes
+	bool contiguous = true, sized = true, digests = true;
+	uint64_t next = 0;
+	for(size_t i = 0; i < chunks.size(); i++) {
+		const chunk& c = chunks[i];
+		contiguous &= c.offset == next;
+		sized &= c.size <= max_size && (c.size >= min_size || i + 1 == chunks.size());
+		digests &= c.digest == Hasher().update(&data[c.offset], c.size).finalize();
+		next = c.offset + c.size;
+	}
+	check(contiguous && next == data.size(), at + " chunks don't cover the data");
+	check(sized, at + " chunk out of the size limits");
+	check(digests, at + " chunk digest");
+	size_t mean = data.size() / chunks.size();
+	check(mean >= avg_size / 2 && mean <= avg_size * 2, at + " mean chunk size " + std::to_string(mean));
+
+	// fed in pieces of any size, whole chunks come out of a single update() or span several
+	for(size_t piece : {size_t(1), size_t(63), size_t(4096), max_size + 1, size_t(1) << 20}) {
+		if(piece == 1 && quick)
+			continue;
+		std::vector<chunk> got;
+		auto sink = [&](const chunk& c) {
+			got.push_back(c);
+		};
+		chunker_t ch(min_size, avg_size, max_size);
+		for(size_t off = 0; off < data.size(); off += piece)
+			ch.update(&data[off], std::min(piece, data.size() - off), sink);
+		ch.finish(sink);
+		check(same_chunks<Hasher>(got, chunks), at + " fed in pieces of " + std::to_string(piece));
+
+		// finish() leaves it ready for a new stream, an empty one gives no chunk
+		got.clear();
+		ch.finish(sink);
+		check(got.empty(), at + " empty stream");
+		ch.update(data.data(), data.size(), sink).finish(sink);
+		check(same_chunks<Hasher>(got, chunks), at + " second stream");
+	}
+
+	// a byte inserted near the front only moves the cuts around it (unless every chunk is max_size long)
+	if(min_size == max_size)
+		return;
+	std::vector<uint8_t> shifted = data;
+	shifted.insert(shifted.begin() + 1000, 0x42);
+	std::set<sha_t<Hasher::bits>> seen;
+	for(const chunk& c : chunks)
+		seen.insert(c.digest);
+	const std::vector<chunk> after = chunker_t::split(shifted.data(), shifted.size(), min_size, avg_size, max_size);
+	size_t kept = 0;
+	for(const chunk& c : after)
+		kept += seen.count(c.digest);
+	check(kept + 3 >= chunks.size(), at + " an insertion changed " + std::to_string(chunks.size() - kept) + " chunks");
+}
+
+
+
+int main(int argc, char* argv[]) {
+	init(argc, argv);
+	for_each_backend([] {
+		chunking<sha2::hasher_256>("sha256", 2048, 8192, 65536);
+		chunking<sha2::hasher_256>("sha256", 64, 64, 64);
+		chunking<sha2::hasher_256>("sha256", 0, 256, 1024);
+		chunking<sha2::hasher_512>("sha512", 4096, 16384, 131072);
+	});
+	check_throws<std::invalid_argument>([] {
+		cdc_chunker<sha2::hasher_256>(4096, 2048, 8192);
+	}, "cdc_chunker with min_size > avg_size");
+	check_throws<std::invalid_argument>([] {
+		cdc_chunker<sha2::hasher_256>(0, 32, 8192);
+	}, "cdc_chunker with avg_size < 64");
+	return done();
+}
@@ -0,0 +1,95 @@
+/*
+*	constexpr_tests: digests taken in constant expressions against published vectors and the runtime kernels
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I. tests/constexpr_tests.cpp -o constexpr_tests -lpthread
+*
+*	Usage:
+*		constexpr_tests
+*
+*		without C++14 constexpr (or a way to detect constant evaluation) there is nothing to check, it says so and passes
+*/
+
+
+#include "sha_test.hpp"
+
+#include <string>
+
+
+using namespace neo::hash;
+using namespace sha_test;
+
+
+
+#ifdef __NEO_SHA_CONSTEXPR
+
+// crosses the 55 / 64 / 111 / 128 / 135 / 136 / 168 byte padding and block boundaries
+static constexpr char text[] =
+	"The quick brown fox jumps over the lazy dog, then keeps running past the end of the first block and well into the "
+	"second and third ones, so the constant evaluated code has to chain several compressions and permutations on its own.";
+static constexpr size_t cuts[] = {0, 3, 55, 56, 64, 111, 112, 128, 135, 136, 168, sizeof(text) - 1};
+
+// the runtime calls go through the kernels, the constexpr ones through the plain implementations
+#define __CONSTEXPR_TABLE(name, fn) static constexpr decltype(fn(text, 0)) name[] = { \
+	fn(text, cuts[0]), fn(text, cuts[1]), fn(text, cuts[2]), fn(text, cuts[3]), fn(text, cuts[4]), fn(text, cuts[5]), \
+	fn(text, cuts[6]), fn(text, cuts[7]), fn(text, cuts[8]), fn(text, cuts[9]), fn(text, cuts[10]), fn(text, cuts[11])}
+
+__CONSTEXPR_TABLE(t_sha1, sha1::hash);
+__CONSTEXPR_TABLE(t_sha224, sha2::hash_224);
+__CONSTEXPR_TABLE(t_sha256, sha2::hash_256);
+__CONSTEXPR_TABLE(t_sha384, sha2::hash_384);
+__CONSTEXPR_TABLE(t_sha512, sha2::hash_512);
+__CONSTEXPR_TABLE(t_sha3_224, sha3::hash_224);
+__CONSTEXPR_TABLE(t_sha3_256, sha3::hash_256);
+__CONSTEXPR_TABLE(t_sha3_384, sha3::hash_384);
+__CONSTEXPR_TABLE(t_sha3_512, sha3::hash_512);
+__CONSTEXPR_TABLE(t_shake128, sha3::hash_shake_128<256>);
+__CONSTEXPR_TABLE(t_shake256, sha3::hash_shake_256<512>);
+
+#undef __CONSTEXPR_TABLE
+
+// fips vectors, first and last bytes
+static constexpr sha_t<256> abc256 = sha2::hash_256("abc", 3);
+static_assert(abc256[0] == 0xba && abc256[31] == 0xad, "constexpr sha256 of abc");
+static constexpr sha_t<160> abc160 = sha1::hash("abc", 3);
+static_assert(abc160[0] == 0xa9 && abc160[19] == 0x9d, "constexpr sha1 of abc");
+static constexpr sha_t<512> abc512 = sha2::hash_512("abc", 3);
+static_assert(abc512[0] == 0xdd && abc512[63] == 0x9f, "constexpr sha512 of abc");
+static constexpr sha_t<256> abc3 = sha3::hash_256("abc", 3);
+static_assert(abc3[0] == 0x3a && abc3[31] == 0x32, "constexpr sha3-256 of abc");
+
+template<class Digest, class Fn>
+static void same(const char* name, const Digest* table, Fn fn) {
+	for(size_t i = 0; i < sizeof(cuts) / sizeof(cuts[0]); i++) {
+		const char* volatile runtime = text;
+		check(table[i] == fn(runtime, cuts[i]), std::string(name) + " len " + std::to_string(cuts[i]) + " differs from the runtime digest");
+	}
+}
+
+int main(int argc, char* argv[]) {
+	init(argc, argv);
+	check_hex(abc256, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", "constexpr sha256 abc");
+	check_hex(abc512, "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f", "constexpr sha512 abc");
+	same("sha1", t_sha1, sha1::hash<char>);
+	same("sha224", t_sha224, sha2::hash_224<char>);
+	same("sha256", t_sha256, sha2::hash_256<char>);
+	same("sha384", t_sha384, sha2::hash_384<char>);
+	same("sha512", t_sha512, sha2::hash_512<char>);
+	same("sha3-224", t_sha3_224, sha3::hash_224<char>);
+	same("sha3-256", t_sha3_256, sha3::hash_256<char>);
+	same("sha3-384", t_sha3_384, sha3::hash_384<char>);
+	same("sha3-512", t_sha3_512, sha3::hash_512<char>);
+	same("shake128", t_shake128, sha3::hash_shake_128<256, char>);
+	same("shake256", t_shake256, sha3::hash_shake_256<512, char>);
+	return done();
+}
+
+#else
+
+int main(int argc, char* argv[]) {
+	init(argc, argv);
+	std::printf("no constexpr hashing with this compiler or standard, nothing to check\n");
+	return done();
+}
+
+#endif
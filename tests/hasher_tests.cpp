@@ -0,0 +1,182 @@
+/*
+*	hasher_tests: published vectors, one-shot vs incremental vs gather hashing for every algorithm, under every backend
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I. tests/hasher_tests.cpp -o hasher_tests -lpthread
+*
+*	Usage:
+*		hasher_tests [--quick]
+*/
+
+
+#include "sha_test.hpp"
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+
+using namespace neo::hash;
+using namespace sha_test;
+
+
+
+static void known_answers() {
+
+	const char* abc = "abc";
+	const std::string quad = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+
+	check_hex(sha1::hash("", 0), "da39a3ee5e6b4b0d3255bfef95601890afd80709", "sha1 empty");
+	check_hex(sha1::hash(abc, 3), "a9993e364706816aba3e25717850c26c9cd0d89d", "sha1 abc");
+	check_hex(sha1::hash(quad.data(), quad.size()), "84983e441c3bd26ebaae4aa1f95129e5e54670f1", "sha1 448 bits");
+
+	check_hex(sha2::hash_224(abc, 3), "23097d223405d8228642a477bda255b32aadbce4bda0b3f7e36c9da7", "sha224 abc");
+	check_hex(sha2::hash_256("", 0), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855", "sha256 empty");
+	check_hex(sha2::hash_256(abc, 3), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", "sha256 abc");
+	check_hex(sha2::hash_256(quad.data(), quad.size()), "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1", "sha256 448 bits");
+	check_hex(sha2::hash_384(abc, 3), "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed8086072ba1e7cc2358baeca134c825a7", "sha384 abc");
+	check_hex(sha2::hash_512(abc, 3), "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f", "sha512 abc");
+	check_hex(sha2::hash_512_224(abc, 3), "4634270f707b6a54daae7530460842e20e37ed265ceee9a43e8924aa", "sha512/224 abc");
+	check_hex(sha2::hash_512_256(abc, 3), "53048e2681941ef99b2e29b76b4c7dabe4c2d0c634fc6d46e0e2f13107e7af23", "sha512/256 abc");
+
+	check_hex(sha3::hash_224(abc, 3), "e642824c3f8cf24ad09234ee7d3c766fc9a3a5168d0c94ad73b46fdf", "sha3-224 abc");
+	check_hex(sha3::hash_256(abc, 3), "3a985da74fe225b2045c172d6bd390bd855f086e3e9d525b46bfe24511431532", "sha3-256 abc");
+	check_hex(sha3::hash_384(abc, 3), "ec01498288516fc926459f58e2c6ad8df9b473cb0fc08c2596da7cf0e49be4b298d88cea927ac7f539f1edf228376d25", "sha3-384 abc");
+	check_hex(sha3::hash_512(abc, 3), "b751850b1a57168a5693cd924b6b096e08f621827444f70d884f5d0240d2712e10e116e9192af3c91a7ec57647e3934057340b4cf408d5a56592f8274eec53f0", "sha3-512 abc");
+	check_hex(sha3::hash_shake_128<256>("", 0), "7f9c2ba4e88f827d616045507605853ed73b8093f6efbc88eb1a6eacfa66ef26", "shake128 empty");
+	check_hex(sha3::hash_shake_256<512>("", 0), "46b9dd2b0ba88d13233b3feb743eeb243fcd52ea62b81b82b50c27646ed5762fd75dc4ddd8c0f200cb05019d67b592f6fc821c49479ab48640292eacb3b7c4be", "shake256 empty");
+
+	// a million 'a', through the incremental path
+	std::vector<uint8_t> a(1000000, 'a');
+	check_hex(sha1::hasher().update(a.data(), a.size()).finalize(), "34aa973cd4c4daa4f61eeb2bdbad27316534016f", "sha1 million a");
+	check_hex(sha2::hasher_256().update(a.data(), a.size()).finalize(), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0", "sha256 million a");
+	check_hex(sha2::hasher_512().update(a.data(), a.size()).finalize(), "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973ebde0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b", "sha512 million a");
+	check_hex(sha3::hasher_256().update(a.data(), a.size()).finalize(), "5c8875ae474a3634ba4fd55ec85bffd661f32aca75c6d699d0cdcb6c115891c1", "sha3-256 million a");
+}
+
+
+
+// the one-shot digests must match the scalar ones; update() in odd piece sizes and *_gather() over any split must give the same
+// digest, finalize() leaves the state as it was, and reset() starts over
+template<class Hasher, class OneShot, class Gather>
+static void differential(const char* name, OneShot one_shot, Gather gather, std::vector<sha_t<Hasher::bits>>& reference) {
+
+	const std::vector<size_t> lens = lengths();
+	std::vector<sha_t<Hasher::bits>> got;
+	for(size_t i = 0; i < lens.size(); i++) {
+
+		const std::vector<uint8_t> msg = noise(lens[i], static_cast<uint32_t>(i));
+		const std::string at = std::string(name) + " len " + std::to_string(msg.size());
+		const sha_t<Hasher::bits> want = one_shot(msg.data(), msg.size());
+		got.push_back(want);
+
+		for(size_t piece : {size_t(1), size_t(7), size_t(63), size_t(129)}) {
+			if(quick && piece == 1 && msg.size() > 300)
+				continue;
+			Hasher h;
+			for(size_t off = 0; off < msg.size(); off += piece)
+				h.update(&msg[off], std::min(piece, msg.size() - off));
+			check(h.finalize() == want, at + " incremental by " + std::to_string(piece));
+		}
+
+		Hasher h;
+		h.update("junk", 4).reset();
+		h.update(msg.data(), msg.size() / 2);
+		h.finalize();
+		h.update(msg.data() + msg.size() / 2, msg.size() - msg.size() / 2);
+		check(h.finalize() == want, at + " finalize() midway or reset()");
+
+		size_t cut = msg.size() / 3;
+		buffer parts[3] = {{msg.data(), cut}, {msg.data() + cut, 0}, {msg.data() + cut, msg.size() - cut}};
+		check(gather(parts, 3) == want, at + " gather of 3");
+		std::vector<buffer> small;
+		for(size_t off = 0, n = 1; off < msg.size(); off += n, n = n % 7 + 1)
+			small.push_back({msg.data() + off, std::min(n, msg.size() - off)});
+		check(gather(small.data(), small.size()) == want, at + " gather of " + std::to_string(small.size()));
+	}
+	check_same(reference, got, std::string(name) + " one-shot");
+}
+
+struct references {
+	std::vector<sha_t<160>> sha1;
+	std::vector<sha_t<224>> sha224, sha512_224, sha3_224;
+	std::vector<sha_t<256>> sha256, sha512_256, sha3_256, shake128;
+	std::vector<sha_t<384>> sha384, sha3_384;
+	std::vector<sha_t<512>> sha512, sha3_512, shake256;
+};
+
+static void all_differential(references& r) {
+	differential<sha1::hasher>("sha1", sha1::hash<uint8_t>, sha1::hash_gather, r.sha1);
+	differential<sha2::hasher_224>("sha224", sha2::hash_224<uint8_t>, sha2::hash_224_gather, r.sha224);
+	differential<sha2::hasher_256>("sha256", sha2::hash_256<uint8_t>, sha2::hash_256_gather, r.sha256);
+	differential<sha2::hasher_384>("sha384", sha2::hash_384<uint8_t>, sha2::hash_384_gather, r.sha384);
+	differential<sha2::hasher_512>("sha512", sha2::hash_512<uint8_t>, sha2::hash_512_gather, r.sha512);
+	differential<sha2::hasher_512_224>("sha512/224", sha2::hash_512_224<uint8_t>, sha2::hash_512_224_gather, r.sha512_224);
+	differential<sha2::hasher_512_256>("sha512/256", sha2::hash_512_256<uint8_t>, sha2::hash_512_256_gather, r.sha512_256);
+	differential<sha3::hasher_224>("sha3-224", sha3::hash_224<uint8_t>, sha3::hash_224_gather, r.sha3_224);
+	differential<sha3::hasher_256>("sha3-256", sha3::hash_256<uint8_t>, sha3::hash_256_gather, r.sha3_256);
+	differential<sha3::hasher_384>("sha3-384", sha3::hash_384<uint8_t>, sha3::hash_384_gather, r.sha3_384);
+	differential<sha3::hasher_512>("sha3-512", sha3::hash_512<uint8_t>, sha3::hash_512_gather, r.sha3_512);
+	differential<sha3::hasher_shake_128<256>>("shake128", sha3::hash_shake_128<256, uint8_t>, sha3::hash_shake_128_gather<256>, r.shake128);
+	differential<sha3::hasher_shake_256<512>>("shake256", sha3::hash_shake_256<512, uint8_t>, sha3::hash_shake_256_gather<512>, r.shake256);
+}
+
+// the uint8_t[Len] and std::array<uint8_t, Len> overloads against the functions taking a pointer and a length
+template<size_t Len>
+static void fixed_length() {
+
+	const std::vector<uint8_t> msg = noise(Len, Len);
+	uint8_t raw[Len];
+	std::array<uint8_t, Len> arr;
+	std::copy(msg.begin(), msg.end(), raw);
+	std::copy(msg.begin(), msg.end(), arr.begin());
+	const std::string at = " of " + std::to_string(Len) + " fixed bytes";
+
+	check(sha1::hash(raw) == sha1::hash(msg.data(), Len) && sha1::hash(arr) == sha1::hash(msg.data(), Len), "sha1" + at);
+	check(sha2::hash_224(raw) == sha2::hash_224(msg.data(), Len) && sha2::hash_224(arr) == sha2::hash_224(msg.data(), Len), "sha224" + at);
+	check(sha2::hash_256(raw) == sha2::hash_256(msg.data(), Len) && sha2::hash_256(arr) == sha2::hash_256(msg.data(), Len), "sha256" + at);
+	check(sha2::hash_384(raw) == sha2::hash_384(msg.data(), Len) && sha2::hash_384(arr) == sha2::hash_384(msg.data(), Len), "sha384" + at);
+	check(sha2::hash_512(raw) == sha2::hash_512(msg.data(), Len) && sha2::hash_512(arr) == sha2::hash_512(msg.data(), Len), "sha512" + at);
+	check(sha2::hash_512_224(raw) == sha2::hash_512_224(msg.data(), Len) && sha2::hash_512_224(arr) == sha2::hash_512_224(msg.data(), Len), "sha512/224" + at);
+	check(sha2::hash_512_256(raw) == sha2::hash_512_256(msg.data(), Len) && sha2::hash_512_256(arr) == sha2::hash_512_256(msg.data(), Len), "sha512/256" + at);
+	check(sha3::hash_224(raw) == sha3::hash_224(msg.data(), Len) && sha3::hash_224(arr) == sha3::hash_224(msg.data(), Len), "sha3-224" + at);
+	check(sha3::hash_256(raw) == sha3::hash_256(msg.data(), Len) && sha3::hash_256(arr) == sha3::hash_256(msg.data(), Len), "sha3-256" + at);
+	check(sha3::hash_384(raw) == sha3::hash_384(msg.data(), Len) && sha3::hash_384(arr) == sha3::hash_384(msg.data(), Len), "sha3-384" + at);
+	check(sha3::hash_512(raw) == sha3::hash_512(msg.data(), Len) && sha3::hash_512(arr) == sha3::hash_512(msg.data(), Len), "sha3-512" + at);
+	check(sha3::hash_shake_128<256>(raw) == sha3::hash_shake_128<256>(msg.data(), Len) && sha3::hash_shake_128<1600>(arr) == sha3::hash_shake_128<1600>(msg.data(), Len), "shake128" + at);
+	check(sha3::hash_shake_256<512>(raw) == sha3::hash_shake_256<512>(msg.data(), Len) && sha3::hash_shake_256<8>(arr) == sha3::hash_shake_256<8>(msg.data(), Len), "shake256" + at);
+}
+
+// lengths around the block sizes (64, 128) and the sha3 rates (72, 104, 136, 144, 168), where the padding spills into a new block
+template<size_t... Lens>
+static void fixed_lengths() {
+	int expand[] = {(fixed_length<Lens>(), 0)...};
+	(void)expand;
+}
+
+// sha384/512 have a single buffer avx2 / avx-512 kernel wherever the batch one can run, so the loop below covers it
+static void single_512_backends() {
+	for(backend b : {backend::avx2, backend::avx512}) {
+		if(sha2::set_batch_backend_512(b))
+			check(sha2::set_backend_512(b) && sha2::active_backend_512() == b, std::string("set_backend_512(") + name(b) + ")");
+		force(backend::automatic);
+	}
+}
+
+
+
+int main(int argc, char* argv[]) {
+	init(argc, argv);
+	single_512_backends();
+	references refs;
+	for_each_backend([&] {
+		std::printf("%-9s sha1 %s, sha256 %s / %s, sha512 %s / %s, keccak %s\n", context, name(sha1::active_backend()),
+			name(sha2::active_backend_256()), name(sha2::active_batch_backend_256()),
+			name(sha2::active_backend_512()), name(sha2::active_batch_backend_512()), name(sha3::active_batch_backend()));
+		known_answers();
+		all_differential(refs);
+		fixed_lengths<1, 16, 32, 48, 55, 56, 63, 64, 65, 71, 72, 103, 104, 111, 112, 127, 128, 135, 136, 143, 144, 167, 168, 200, 300>();
+	});
+	return done();
+}
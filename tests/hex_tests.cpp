@@ -0,0 +1,107 @@
+/*
+*	hex_tests: the sha_t hex codec against a snprintf loop, every bad char rejected at every position
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I. tests/hex_tests.cpp -o hex_tests -lpthread
+*
+*	Usage:
+*		hex_tests
+*
+*		the codec picks its ssse3 / avx2 kernels from cpuid, the lengths around the 16 / 32 byte vectors cover their tails
+*/
+
+
+#include "sha_test.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+using namespace neo::hash;
+using namespace sha_test;
+
+
+
+static std::string slow_hex(const uint8_t* p, size_t n) {
+	std::string s;
+	for(size_t i = 0; i < n; i++) {
+		char pair[3];
+		std::snprintf(pair, sizeof(pair), "%02x", p[i]);
+		s += pair;
+	}
+	return s;
+}
+
+template<size_t Bits>
+static void round_trips() {
+
+	typedef sha_t<Bits> digest;
+	const size_t hex = digest::bytes * 2;
+	for(size_t n = 0; n < 20; n++) {
+
+		std::vector<digest> d(n + 1);
+		for(size_t i = 0; i < d.size(); i++) {
+			std::vector<uint8_t> v = noise(digest::bytes, static_cast<uint32_t>(n * 100 + i));
+			std::copy(v.begin(), v.end(), d[i].begin());
+		}
+		std::string text(d.size() * hex, '?');
+		check(digest::to_chars_many(d.data(), d.size(), &text[0]) == &text[0] + text.size(), "to_chars_many end");
+		std::string want;
+		for(const digest& x : d)
+			want += slow_hex(x.data(), x.size());
+		check(text == want, "to_chars_many of " + std::to_string(d.size()) + " sha_t<" + std::to_string(Bits) + ">");
+
+		for(size_t i = 0; i < d.size(); i++) {
+			char one[digest::bytes * 2 + 1];
+			one[hex] = '#';
+			check(d[i].to_chars(one) == one + hex && one[hex] == '#' && std::string(one, hex) == text.substr(i * hex, hex), "to_chars");
+			std::string upper = text.substr(i * hex, hex);
+			for(char& c : upper)
+				c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+			digest back;
+			check(back.from_chars(upper.data(), upper.size()) && back == d[i], "from_chars uppercase");
+			check(digest(d[i].to_str()) == d[i], "string round trip");
+		}
+	}
+
+	// a short input fills the leading bytes, an odd one the high nibble of the next
+	digest d;
+	check(d.from_chars("aB3", 3) && d[0] == 0xab && d[1] == 0x30 && d[2] == 0, "from_chars of 3 chars");
+	check(!d.from_chars(std::string(hex + 1, '0').data(), hex + 1), "from_chars of too many chars");
+}
+
+static void bad_chars() {
+
+	sha_t<512> d;
+	d.fill(0x5a);
+	std::string text = d.to_str();
+	for(size_t i = 0; i < text.size(); i++) {
+		for(char bad : {'g', 'G', ' ', '/', ':', '@', '`', '\0', '\x80', '\xff'}) {
+			std::string t = text;
+			t[i] = bad;
+			sha_t<512> x = d;
+			x[0] = 0;
+			check(!x.from_chars(t.data(), t.size()) && x[0] == 0, "from_chars accepted a bad char at " + std::to_string(i));
+		}
+	}
+	check_throws<std::invalid_argument>([] {
+		sha_t<256> x(std::string("zz"));
+	}, "sha_t from bad hex");
+}
+
+
+
+int main(int argc, char* argv[]) {
+	init(argc, argv);
+	round_trips<160>();
+	round_trips<224>();
+	round_trips<256>();
+	round_trips<512>();
+	round_trips<4096>();
+	bad_chars();
+	return done();
+}
@@ -0,0 +1,176 @@
+/*
+*	hmac_tests: hmac and pbkdf2 against published vectors and the textbook construction, under every backend
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I. tests/hmac_tests.cpp -o hmac_tests -lpthread
+*
+*	Usage:
+*		hmac_tests [--quick]
+*/
+
+
+#include "sha_test.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+using namespace neo::hash;
+using namespace sha_test;
+
+
+
+// rfc 4231 #1, #2 and #6, rfc 2202; sha3 from python's hmac module
+static void known_answers() {
+
+	const std::vector<uint8_t> key1(20, 0x0b);
+	check_hex(hmac<sha2::hasher_256>(key1.data(), key1.size()).hash("Hi There", 8), "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7", "hmac-sha256 #1");
+	const std::string jefe = "what do ya want for nothing?";
+	check_hex(hmac<sha1::hasher>("Jefe", 4).hash(jefe.data(), jefe.size()), "effcdf6ae5eb2fa2d27416d5f184df9c259a7c79", "hmac-sha1 #2");
+	check_hex(hmac<sha2::hasher_256>("Jefe", 4).hash(jefe.data(), jefe.size()), "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843", "hmac-sha256 #2");
+	check_hex(hmac<sha2::hasher_512>("Jefe", 4).hash(jefe.data(), jefe.size()), "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea2505549758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737", "hmac-sha512 #2");
+
+	const std::vector<uint8_t> key6(131, 0xaa);
+	const std::string msg6 = "Test Using Larger Than Block-Size Key - Hash Key First";
+	check_hex(hmac<sha1::hasher>(key6.data(), key6.size()).hash(msg6.data(), msg6.size()), "90d0dace1c1bdc957339307803160335bde6df2b", "hmac-sha1 #6");
+	check_hex(hmac<sha2::hasher_224>(key6.data(), key6.size()).hash(msg6.data(), msg6.size()), "95e9a0db962095adaebe9b2d6f0dbce2d499f112f2d2b7273fa6870e", "hmac-sha224 #6");
+	check_hex(hmac<sha2::hasher_256>(key6.data(), key6.size()).hash(msg6.data(), msg6.size()), "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54", "hmac-sha256 #6");
+	check_hex(hmac<sha2::hasher_384>(key6.data(), key6.size()).hash(msg6.data(), msg6.size()), "4ece084485813e9088d2c63a041bc5b44f9ef1012a2b588f3cd11f05033ac4c60c2ef6ab4030fe8296248df163f44952", "hmac-sha384 #6");
+	check_hex(hmac<sha2::hasher_512>(key6.data(), key6.size()).hash(msg6.data(), msg6.size()), "80b24263c7c1a3ebb71493c1dd7be8b49b46d1f41b4aeec1121b013783f8f3526b56d037e05f2598bd0fd2215d6a1e5295e64f73f63f0aec8b915a985d786598", "hmac-sha512 #6");
+	check_hex(hmac<sha3::hasher_256>(key6.data(), key6.size()).hash(msg6.data(), msg6.size()), "ed73a374b96c005235f948032f09674a58c0ce555cfc1f223b02356560312c3b", "hmac-sha3-256 #6");
+	check_hex(hmac<sha3::hasher_512>(key6.data(), key6.size()).hash(msg6.data(), msg6.size()), "00f751a9e50695b090ed6911a4b65524951cdc15a73a5d58bb55215ea2cd839ac79d2b44a39bafab27e83fde9e11f6340b11d991b1b91bf2eee7fc872426c3a4", "hmac-sha3-512 #6");
+}
+
+// H((K ^ opad) || H((K ^ ipad) || m)) spelled out, for keys around the block size; incremental, one-shot and reset() agree
+template<class Hasher>
+static void textbook(const char* name) {
+
+	for(size_t key_len : {size_t(0), size_t(1), Hasher::blk_size - 1, Hasher::blk_size, Hasher::blk_size + 1, size_t(300)}) {
+
+		const std::vector<uint8_t> key = noise(key_len, 1), msg = noise(1000, 2);
+		std::vector<uint8_t> k(Hasher::blk_size, 0), ipad(Hasher::blk_size), opad(Hasher::blk_size);
+		if(key_len > Hasher::blk_size) {
+			sha_t<Hasher::bits> d = Hasher().update(key.data(), key.size()).finalize();
+			std::memcpy(k.data(), d.data(), d.size());
+		}
+		else if(key_len)
+			std::memcpy(k.data(), key.data(), key_len);
+		for(size_t i = 0; i < k.size(); i++) {
+			ipad[i] = k[i] ^ 0x36;
+			opad[i] = k[i] ^ 0x5c;
+		}
+		sha_t<Hasher::bits> in = Hasher().update(ipad.data(), ipad.size()).update(msg.data(), msg.size()).finalize();
+		sha_t<Hasher::bits> want = Hasher().update(opad.data(), opad.size()).update(in.data(), in.size()).finalize();
+
+		const std::string at = std::string(name) + " key of " + std::to_string(key_len);
+		hmac<Hasher> mac(key.data(), key.size());
+		check(mac.hash(msg.data(), msg.size()) == want, at);
+		mac.update(msg.data(), 333).update(msg.data() + 333, msg.size() - 333);
+		check(mac.finalize() == want, at + " incremental");
+		mac.reset();
+		check(mac.finalize() == mac.hash("", 0), at + " reset()");
+	}
+}
+
+template<class Hasher>
+static void derive(const char* pw, const char* salt, size_t iterations, const char* hex, const std::string& what) {
+	std::vector<uint8_t> out(std::strlen(hex) / 2);
+	pbkdf2<Hasher>(pw, std::strlen(pw), salt, std::strlen(salt), iterations, out.data(), out.size());
+	check(out == bytes_of(hex), what + ", " + std::to_string(iterations) + " iterations");
+}
+
+// rfc 6070, then python's hashlib.pbkdf2_hmac
+static void pbkdf2_answers() {
+
+	derive<sha1::hasher>("password", "salt", 1, "0c60c80f961f0e71f3a9b524af6012062fe037a6", "pbkdf2-sha1");
+	derive<sha1::hasher>("password", "salt", 2, "ea6c014dc72d6f8ccd1ed92ace1d41f0d8de8957", "pbkdf2-sha1");
+	derive<sha1::hasher>("password", "salt", 4096, "4b007901b765489abead49d926f721d065a429c1", "pbkdf2-sha1");
+	derive<sha1::hasher>("passwordPASSWORDpassword", "saltSALTsaltSALTsaltSALTsaltSALTsalt", 4096, "3d2eec4fe41c849b80c8d83662c0e44a8b291a964cf2f07038", "pbkdf2-sha1 25 bytes");
+	uint8_t nul[16];
+	pbkdf2<sha1::hasher>("pass\0word", 9, "sa\0lt", 5, 4096, nul, sizeof(nul));
+	check(std::vector<uint8_t>(nul, nul + 16) == bytes_of("56fa6aa75548099dcc37d7f03425e0c3"), "pbkdf2-sha1 with nul bytes");
+
+	derive<sha2::hasher_256>("password", "salt", 1, "120fb6cffcf8b32c43e7225256c4f837a86548c92ccc35480805987cb70be17b", "pbkdf2-sha256");
+	derive<sha2::hasher_256>("password", "salt", 2, "ae4d0c95af6b46d32d0adff928f06dd02a303f8ef3c251dfd6e2d85a95474c43", "pbkdf2-sha256");
+	derive<sha2::hasher_256>("password", "salt", 4096, "c5e478d59288c841aa530db6845c4c8d962893a001ce4e11a4963873aa98134a", "pbkdf2-sha256");
+	derive<sha2::hasher_224>("password", "salt", 1000, "d3bcf320fd918908eafcaa460faf40e201f6508d4e6f3d9c1c0abd30da", "pbkdf2-sha224");
+	derive<sha2::hasher_384>("password", "salt", 1000, "3bd37e2236941d4a77b1b5b714c6f913fabb6b0841a6d7d8656b99d611e900fe06edb93b5b809efaa9678b635ce513e0f7d9ebb0aea1e07f0ab90d1b9cbd94643bef7c43c89577664fe1df1a16a82e7337d78ae44841c7512aa03341babe1086554e2a49", "pbkdf2-sha384 100 bytes");
+	derive<sha2::hasher_512>("password", "salt", 4096, "d197b1b33db0143e018b12f3d1d1479e6cdebdcc97c5c0f87f6902e072f457b5143f30602641b3d55cd335988cb36b84376060ecd532e039b742a239434af2d5", "pbkdf2-sha512");
+}
+
+// several output blocks run side by side on the lanes: each block on its own must match the hmac chain done by hand
+template<class Hasher>
+static void pbkdf2_blocks(const char* name) {
+
+	const size_t len = Hasher::bits / 8, blocks = 19;
+	std::vector<uint8_t> derived(len * blocks - 5);
+	pbkdf2<Hasher>("pw", 2, "salt", 4, 3, derived.data(), derived.size());
+	hmac<Hasher> prf("pw", 2);
+	for(uint32_t blk = 1; blk <= blocks; blk++) {
+		uint8_t salt[8] = {'s', 'a', 'l', 't', uint8_t(blk >> 24), uint8_t(blk >> 16), uint8_t(blk >> 8), uint8_t(blk)};
+		sha_t<Hasher::bits> u = prf.hash(salt, 8), t = u;
+		for(int i = 1; i < 3; i++) {
+			u = prf.hash(u.data(), u.size());
+			for(size_t j = 0; j < t.size(); j++)
+				t[j] ^= u[j];
+		}
+		size_t n = std::min(len, derived.size() - (blk - 1) * len);
+		check(std::memcmp(t.data(), &derived[(blk - 1) * len], n) == 0, std::string(name) + " block " + std::to_string(blk));
+	}
+}
+
+// salts of 0 to 300 bytes, across the block boundaries of the salt tail, against the hmac chain done by hand; 0 iterations throws
+template<class Hasher>
+static void pbkdf2_salts(const char* name) {
+
+	const size_t len = Hasher::bits / 8;
+	hmac<Hasher> prf("password", 8);
+	for(size_t salt_len = 0; salt_len <= 300; salt_len += quick ? 7 : 1) {
+		std::vector<uint8_t> salt = noise(salt_len, salt_len), derived(len + 3);
+		pbkdf2<Hasher>("password", 8, salt.data(), salt.size(), 2, derived.data(), derived.size());
+		bool ok = true;
+		for(uint32_t blk = 1; blk <= 2; blk++) {
+			std::vector<uint8_t> msg(salt);
+			msg.insert(msg.end(), {uint8_t(blk >> 24), uint8_t(blk >> 16), uint8_t(blk >> 8), uint8_t(blk)});
+			sha_t<Hasher::bits> u = prf.hash(msg.data(), msg.size()), t = u;
+			u = prf.hash(u.data(), u.size());
+			for(size_t j = 0; j < t.size(); j++)
+				t[j] ^= u[j];
+			ok &= std::memcmp(t.data(), &derived[(blk - 1) * len], blk == 1 ? len : 3) == 0;
+		}
+		check(ok, std::string(name) + " salt of " + std::to_string(salt_len));
+	}
+
+	uint8_t out[4];
+	check_throws<std::invalid_argument>([&] {
+		pbkdf2<Hasher>("password", 8, "salt", 4, 0, out, sizeof(out));
+	}, std::string(name) + " with 0 iterations");
+}
+
+
+
+int main(int argc, char* argv[]) {
+	init(argc, argv);
+	for_each_backend([] {
+		known_answers();
+		textbook<sha1::hasher>("hmac-sha1");
+		textbook<sha2::hasher_224>("hmac-sha224");
+		textbook<sha2::hasher_256>("hmac-sha256");
+		textbook<sha2::hasher_384>("hmac-sha384");
+		textbook<sha2::hasher_512>("hmac-sha512");
+		textbook<sha3::hasher_256>("hmac-sha3-256");
+		textbook<sha3::hasher_512>("hmac-sha3-512");
+		pbkdf2_answers();
+		pbkdf2_blocks<sha1::hasher>("pbkdf2-sha1");
+		pbkdf2_blocks<sha2::hasher_256>("pbkdf2-sha256");
+		pbkdf2_blocks<sha2::hasher_512>("pbkdf2-sha512");
+		pbkdf2_blocks<sha2::hasher_512_224>("pbkdf2-sha512/224");
+		pbkdf2_salts<sha1::hasher>("pbkdf2-sha1");
+		pbkdf2_salts<sha2::hasher_256>("pbkdf2-sha256");
+		pbkdf2_salts<sha2::hasher_512>("pbkdf2-sha512");
+	});
+	return done();
+}
@@ -0,0 +1,102 @@
+/*
+*	indices_tests: indices_128 / indices_256 against the shake stream read through xof_128 / xof_256, one key at a time and in batches, under every backend
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I. tests/indices_tests.cpp -o indices_tests -lpthread
+*
+*	Usage:
+*		indices_tests [--quick]
+*/
+
+
+#include "sha_test.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+using namespace neo::hash;
+using namespace sha_test;
+
+
+
+// the definition: 64 bit little endian words of the shake output, w * m >> 64 unless the low half of w * m is under 2^64 mod m
+template<class Xof>
+static std::vector<uint64_t> reference(const std::vector<uint8_t>& key, size_t k, uint64_t m) {
+	Xof x;
+	x.absorb(key.data(), key.size());
+	const uint64_t reject = (0 - m) % m;
+	std::vector<uint64_t> out;
+	while(out.size() < k) {
+		uint8_t b[8];
+		x.squeeze(b, 8);
+		uint64_t w = 0;
+		for(int i = 7; i >= 0; i--)
+			w = w << 8 | b[i];
+		unsigned __int128 p = static_cast<unsigned __int128>(w) * m;
+		if(static_cast<uint64_t>(p) >= reject)
+			out.push_back(static_cast<uint64_t>(p >> 64));
+	}
+	return out;
+}
+
+template<class Xof>
+static void indices(const char* name, void (*one)(const uint8_t*, size_t, size_t, uint64_t, uint64_t*), void (*many)(const buffer*, size_t, size_t, uint64_t, uint64_t*)) {
+
+	const size_t keys = quick ? 100 : 300;
+	std::vector<std::vector<uint8_t>> key(keys);
+	std::vector<buffer> bufs(keys);
+	for(size_t i = 0; i < keys; i++) {
+		key[i] = noise(i * 2 / 3, i);
+		bufs[i] = buffer{key[i].data(), key[i].size()};
+	}
+
+	// m of 1, small, odd, powers of 2, and next to 2^64 where nearly half the words are rejected
+	for(uint64_t m : {uint64_t(1), uint64_t(2), uint64_t(7), uint64_t(1000), uint64_t(1) << 24, uint64_t(0x9E3779B97F4A7C15), uint64_t(1) << 63, (uint64_t(1) << 63) + 1, ~uint64_t(0)}) {
+		for(size_t k : {size_t(1), size_t(7), size_t(17), size_t(18), size_t(21), size_t(22), size_t(50)}) {
+
+			const std::string at = std::string(name) + " k = " + std::to_string(k) + ", m = " + std::to_string(m);
+			std::vector<uint64_t> all(keys * k);
+			many(bufs.data(), keys, k, m, all.data());
+
+			bool single = true, batch = true, range = true;
+			for(size_t i = 0; i < keys; i++) {
+				const std::vector<uint64_t> want = reference<Xof>(key[i], k, m);
+				std::vector<uint64_t> got(k);
+				one(key[i].data(), key[i].size(), k, m, got.data());
+				single &= got == want;
+				batch &= std::vector<uint64_t>(all.begin() + i * k, all.begin() + (i + 1) * k) == want;
+				for(uint64_t v : got)
+					range &= v < m;
+			}
+			check(single, at);
+			check(batch, at + ", batch");
+			check(range, at + ", out of range");
+		}
+	}
+
+	uint64_t untouched = 42;
+	many(bufs.data(), 0, 5, 10, &untouched);
+	check(untouched == 42, std::string(name) + " batch of no keys");
+
+	// [0, 0) has no index to give, nothing is written
+	check_throws<std::invalid_argument>([&] {
+		one(key[1].data(), key[1].size(), 1, 0, &untouched);
+	}, std::string(name) + " with m = 0");
+	check_throws<std::invalid_argument>([&] {
+		many(bufs.data(), keys, 1, 0, &untouched);
+	}, std::string(name) + " batch with m = 0");
+	check(untouched == 42, std::string(name) + " wrote with m = 0");
+}
+
+
+
+int main(int argc, char* argv[]) {
+	init(argc, argv);
+	for_each_backend([] {
+		indices<sha3::xof_128>("indices_128", sha3::indices_128<uint8_t>, sha3::indices_128_many);
+		indices<sha3::xof_256>("indices_256", sha3::indices_256<uint8_t>, sha3::indices_256_many);
+	});
+	return done();
+}
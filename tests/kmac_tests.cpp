@@ -0,0 +1,137 @@
+/*
+*	kmac_tests: cshake and kmac against the nist sp 800-185 samples and a python reference over keys and messages around the rate, under every backend
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I. tests/kmac_tests.cpp -o kmac_tests -lpthread
+*
+*	Usage:
+*		kmac_tests
+*/
+
+
+#include "sha_test.hpp"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+using namespace neo::hash;
+using namespace sha_test;
+
+
+
+// i * mul + add mod 251, the inputs of the python reference
+static std::vector<uint8_t> pattern(size_t n, size_t mul = 1, size_t add = 0) {
+	std::vector<uint8_t> v(n);
+	for(size_t i = 0; i < n; i++)
+		v[i] = static_cast<uint8_t>((i * mul + add) % 251);
+	return v;
+}
+
+// nist sp 800-185 cshake and kmac samples, the key 0x40 .. 0x5f and the data 00 01 02 03 or 00 .. c7
+static void samples() {
+
+	std::vector<uint8_t> key(32), x4 = pattern(4), x200(200);
+	for(size_t i = 0; i < key.size(); i++)
+		key[i] = static_cast<uint8_t>(0x40 + i);
+	for(size_t i = 0; i < x200.size(); i++)
+		x200[i] = static_cast<uint8_t>(i);
+
+	check_hex(sha3::hash_cshake_128<256>(x4.data(), x4.size(), "", "Email Signature"), "c1c36925b6409a04f1b504fcbca9d82b4017277cb5ed2b2065fc1d3814d5aaf5", "cshake128 sample #1");
+	check_hex(sha3::hash_cshake_128<256>(x200.data(), x200.size(), "", "Email Signature"), "c5221d50e4f822d96a2e8881a961420f294b7b24fe3d2094baed2c6524cc166b", "cshake128 sample #2");
+	check_hex(sha3::hash_cshake_256<512>(x4.data(), x4.size(), "", "Email Signature"), "d008828e2b80ac9d2218ffee1d070c48b8e4c87bff32c9699d5b6896eee0edd164020e2be0560858d9c00c037e34a96937c561a74c412bb4c746469527281c8c", "cshake256 sample #3");
+	check_hex(sha3::hash_cshake_256<512>(x200.data(), x200.size(), "", "Email Signature"), "07dc27b11e51fbac75bc7b3c1d983e8b4b85fb1defaf218912ac86430273091727f42b17ed1df63e8ec118f04b23633c1dfb1574c8fb55cb45da8e25afb092bb", "cshake256 sample #4");
+	check(sha3::hash_cshake_128<256>(x200.data(), x200.size(), "", "") == sha3::hash_shake_128<256>(x200.data(), x200.size()), "cshake128 with no strings isn't shake128");
+	check(sha3::hash_cshake_256<512>(x200.data(), x200.size(), "", "") == sha3::hash_shake_256<512>(x200.data(), x200.size()), "cshake256 with no strings isn't shake256");
+
+	const std::string tag = "My Tagged Application";
+	check_hex(sha3::kmac_128<256>(key.data(), key.size()).hash(x4.data(), x4.size()), "e5780b0d3ea6f7d3a429c5706aa43a00fadbd7d49628839e3187243f456ee14e", "kmac128 sample #1");
+	check_hex(sha3::kmac_128<256>(key.data(), key.size(), tag).hash(x4.data(), x4.size()), "3b1fba963cd8b0b59e8c1a6d71888b7143651af8ba0a7070c0979e2811324aa5", "kmac128 sample #2");
+	check_hex(sha3::kmac_128<256>(key.data(), key.size(), tag).hash(x200.data(), x200.size()), "1f5b4e6cca02209e0dcb5ca635b89a15e271ecc760071dfd805faa38f9729230", "kmac128 sample #3");
+	check_hex(sha3::kmac_256<512>(key.data(), key.size(), tag).hash(x4.data(), x4.size()), "20c570c31346f703c9ac36c61c03cb64c3970d0cfc787e9b79599d273a68d2f7f69d4cc3de9d104a351689f27cf6f5951f0103f33f4f24871024d9c27773a8dd", "kmac256 sample #4");
+	check_hex(sha3::kmac_256<512>(key.data(), key.size()).hash(x200.data(), x200.size()), "75358cf39e41494e949707927cee0af20a3ff553904c86b08f21cc414bcfd691589d27cf5e15369cbbff8b9a4c2eb17800855d0235ff635da82533ec6b759b69", "kmac256 sample #5");
+	check_hex(sha3::kmac_256<512>(key.data(), key.size(), tag).hash(x200.data(), x200.size()), "b58618f71f92e1d56c1b8c55ddd7cd188b97b4ca4d99831eb2699a837da2e4d970fbacfde50033aea585f1a2708510c32d07880801bd182898fe476876fc8965", "kmac256 sample #6");
+	check_hex(sha3::kmac_xof_128<256>(key.data(), key.size()).hash(x4.data(), x4.size()), "cd83740bbd92ccc8cf032b1481a0f4460e7ca9dd12b08a0c4031178bacd6ec35", "kmacxof128 sample #1");
+	check_hex(sha3::kmac_xof_128<256>(key.data(), key.size(), tag).hash(x200.data(), x200.size()), "47026c7cd793084aa0283c253ef658490c0db61438b8326fe9bddf281b83ae0f", "kmacxof128 sample #3");
+	check_hex(sha3::kmac_xof_256<512>(key.data(), key.size(), tag).hash(x4.data(), x4.size()), "1755133f1534752aad0748f2c706fb5c784512cab835cd15676b16c0c6647fa96faa7af634a0bf8ff6df39374fa00fad9a39e322a7c92065a64eb1fb0801eb2b", "kmacxof256 sample #4");
+}
+
+// sha256 of every output back to back, over keys and messages around the rates, with and without S; the same from python
+template<class Kmac>
+static void folded(const char* name, const char* want) {
+
+	sha2::hasher_256 all;
+	for(size_t key_len : {0, 1, 135, 136, 167, 168, 169, 300}) {
+		const std::vector<uint8_t> key = pattern(key_len);
+		for(size_t msg_len : {0, 1, 135, 136, 168, 1000}) {
+			const std::vector<uint8_t> msg = pattern(msg_len, 7, 3);
+			for(const char* custom : {"", "S"}) {
+				const Kmac mac(key.data(), key.size(), custom);
+				const sha_t<Kmac::bits> tag = mac.hash(msg.data(), msg.size());
+				all.update(tag.data(), tag.size());
+
+				// incremental, in uneven pieces, and again after reset()
+				Kmac inc(key.data(), key.size(), custom);
+				for(int round = 0; round < 2; round++) {
+					for(size_t off = 0; off < msg_len; off += 61)
+						inc.update(&msg[off], std::min<size_t>(61, msg_len - off));
+					check(inc.finalize() == tag, std::string(name) + " incremental, key of " + std::to_string(key_len) + ", message of " + std::to_string(msg_len));
+					inc.reset();
+				}
+			}
+		}
+	}
+	check_hex(all.finalize(), want, std::string(name) + " against the python reference");
+}
+
+template<size_t Bits>
+static void cshake_folded(const char* name, sha_t<Bits> (*cshake)(const uint8_t*, size_t, const std::string&, const std::string&), const char* want) {
+	const std::vector<std::pair<std::string, std::string>> strings_list = {{"", ""}, {"N", ""}, {"", "S"}, {"KMAC", std::string(200, 'x')}};
+	sha2::hasher_256 all;
+	for(size_t msg_len : {0, 1, 135, 136, 167, 168, 169, 1000}) {
+		const std::vector<uint8_t> msg = pattern(msg_len, 7, 3);
+		for(const std::pair<std::string, std::string>& strings : strings_list) {
+			sha_t<Bits> d = cshake(msg.data(), msg.size(), strings.first, strings.second);
+			all.update(d.data(), d.size());
+		}
+	}
+	check_hex(all.finalize(), want, std::string(name) + " against the python reference");
+}
+
+// a const mac serves several threads at once
+static void shared() {
+	const std::vector<uint8_t> key = pattern(40), msg = pattern(3000, 3);
+	const sha3::kmac_256<512> mac(key.data(), key.size(), "shared");
+	const sha_t<512> want = mac.hash(msg.data(), msg.size());
+	bool ok[4];
+	std::vector<std::thread> threads;
+	for(int t = 0; t < 4; t++)
+		threads.emplace_back([&, t] {
+			ok[t] = true;
+			for(int i = 0; i < 200; i++)
+				ok[t] &= mac.hash(msg.data(), msg.size()) == want;
+		});
+	for(std::thread& t : threads)
+		t.join();
+	check(ok[0] && ok[1] && ok[2] && ok[3], "kmac256 shared between threads");
+}
+
+
+
+int main(int argc, char* argv[]) {
+	init(argc, argv);
+	for_each_backend([] {
+		samples();
+		folded<sha3::kmac_128<256>>("kmac128", "bc39e37cf7e19b1c619bfa7ba7d2238a4193f8036bf1b92383b667730d5b9d5b");
+		folded<sha3::kmac_xof_128<256>>("kmacxof128", "0d91226acb7805d55bd39cacc3bcf2198fea88be7213eb9e77c9b2ddf98eeb1a");
+		folded<sha3::kmac_256<512>>("kmac256", "5f701e5f0b61501c514841fee21f4acf9144aba02a66d160e7f6c7909df8c0be");
+		folded<sha3::kmac_xof_256<512>>("kmacxof256", "cc7f143230be30d5f24f89d19d9723a822110010eb4482d0cc42ed914ea53eb7");
+		cshake_folded<256>("cshake128", sha3::hash_cshake_128<256, uint8_t>, "ec6001d2d5307f2472a470f5cd3f1f2307a7f3a19f609d1828f0bed878aa299d");
+		cshake_folded<512>("cshake256", sha3::hash_cshake_256<512, uint8_t>, "f76ee84f8ec422fc16eb891e195614227fc86dfb30bbeca4de72d50267e4cfd0");
+		shared();
+	});
+	return done();
+}
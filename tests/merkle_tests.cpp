@@ -0,0 +1,96 @@
+/*
+*	merkle_tests: merkle_tree roots against the rfc 6962 definition, inclusion proofs one by one and in batches, under every backend
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I. tests/merkle_tests.cpp -o merkle_tests -lpthread
+*
+*	Usage:
+*		merkle_tests [--quick]
+*/
+
+
+#include "sha_test.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+
+using namespace neo::hash;
+using namespace sha_test;
+
+
+
+// rfc 6962: a leaf is H(0x00 || digest), a node H(0x01 || left || right), an unpaired last node moves up unchanged
+template<class Hasher>
+static sha_t<Hasher::bits> reference_root(const std::vector<sha_t<Hasher::bits>>& leaves) {
+	const uint8_t leaf_prefix = 0x00, node_prefix = 0x01;
+	std::vector<sha_t<Hasher::bits>> level;
+	for(const sha_t<Hasher::bits>& d : leaves)
+		level.push_back(Hasher().update(&leaf_prefix, 1).update(d.data(), d.size()).finalize());
+	if(level.empty()) {
+		sha_t<Hasher::bits> zero;
+		zero.fill(0);
+		return zero;
+	}
+	while(level.size() > 1) {
+		std::vector<sha_t<Hasher::bits>> next;
+		for(size_t i = 0; i < level.size(); i += 2)
+			next.push_back(i + 1 < level.size() ? Hasher().update(&node_prefix, 1).update(level[i].data(), level[i].size()).update(level[i + 1].data(), level[i + 1].size()).finalize() : level[i]);
+		level = next;
+	}
+	return level[0];
+}
+
+template<class Hasher>
+static void trees(const char* name) {
+
+	typedef merkle_tree<Hasher> tree_t;
+	typedef sha_t<Hasher::bits> digest;
+
+	for(size_t n : {size_t(0), size_t(1), size_t(2), size_t(3), size_t(7), size_t(8), size_t(9), size_t(33), size_t(100), size_t(1000), size_t(quick ? 5000 : 70000)}) {
+
+		const std::string at = std::string(name) + " of " + std::to_string(n);
+		std::vector<digest> leaves(n);
+		for(size_t i = 0; i < n; i++)
+			leaves[i] = Hasher().update(&i, sizeof(i)).finalize();
+		tree_t tree(leaves.data(), n);
+		check(tree.size() == n && tree.root() == reference_root<Hasher>(leaves), at + " root");
+		if(!n)
+			continue;
+
+		std::vector<typename tree_t::proof> proofs;
+		for(size_t i = 0; i < n; i++)
+			proofs.push_back(tree.prove(i));
+		std::unique_ptr<bool[]> ok(new bool[n]);
+		check(tree_t::verify_many(tree.root(), n, leaves.data(), proofs.data(), n, ok.get()) == n, at + " proofs");
+		check(tree_t::verify(tree.root(), n, leaves[n - 1], proofs[n - 1]), at + " proof of the last leaf");
+
+		// a wrong leaf, a flipped sibling, a cut path and an index out of range all fail, the others in the batch still pass
+		if(n >= 4) {
+			std::vector<digest> bad = leaves;
+			bad[0] = leaves[1];
+			proofs[n - 1].path[0][0] ^= 1;
+			proofs[1].path.pop_back();
+			proofs[2].index = n;
+			check(tree_t::verify_many(tree.root(), n, bad.data(), proofs.data(), n, ok.get()) == n - 4, at + " bad proofs");
+			check(!ok[0] && !ok[1] && !ok[2] && !ok[n - 1] && ok[3], at + " bad proofs passed");
+
+			// a tree size of another height, and an inner node passed off as a leaf with the path above it
+			check(!tree_t::verify(tree.root(), n / 2, leaves[0], tree.prove(0)), at + " proof against half the size");
+			typename tree_t::proof inner = {1, std::vector<digest>(proofs[3].path.begin() + 1, proofs[3].path.end())};
+			check(!tree_t::verify(tree.root(), (n + 1) / 2, tree.level(1)[1], inner), at + " inner node as a leaf");
+		}
+	}
+}
+
+
+
+int main(int argc, char* argv[]) {
+	init(argc, argv);
+	for_each_backend([] {
+		trees<sha2::hasher_256>("merkle sha256");
+		trees<sha2::hasher_512>("merkle sha512");
+	});
+	return done();
+}
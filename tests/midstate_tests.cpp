@@ -0,0 +1,84 @@
+/*
+*	midstate_tests: save() / restore() snapshots of every hasher, resumed in place, by construction and through a byte copy
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I. tests/midstate_tests.cpp -o midstate_tests -lpthread
+*
+*	Usage:
+*		midstate_tests
+*/
+
+
+#include "sha_test.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+using namespace neo::hash;
+using namespace sha_test;
+
+
+
+template<class Hasher>
+static void snapshots(const char* name) {
+
+	typedef typename Hasher::midstate midstate;
+	static_assert(std::is_trivially_copyable<midstate>::value, "midstate must be trivially copyable");
+
+	const std::vector<uint8_t> msg = noise(700, 3);
+	for(size_t cut : {size_t(0), size_t(1), size_t(63), size_t(64), size_t(65), size_t(127), size_t(128), size_t(136), size_t(168), size_t(169), size_t(500)}) {
+
+		const std::string at = std::string(name) + " prefix of " + std::to_string(cut);
+		const sha_t<Hasher::bits> want = Hasher().update(msg.data(), msg.size()).finalize();
+
+		Hasher h;
+		h.update(msg.data(), cut);
+		const midstate m = h.save();
+		h.update(msg.data() + cut, msg.size() - cut);
+		check(h.finalize() == want, at + ", the hasher goes on after save()");
+
+		Hasher r(m);
+		r.update(msg.data() + cut, msg.size() - cut);
+		check(r.finalize() == want, at + ", constructed from the snapshot");
+
+		Hasher other;
+		other.update("something else", 14);
+		other.restore(m);
+		other.update(msg.data() + cut, msg.size() - cut);
+		check(other.finalize() == want, at + ", restore() over other data");
+
+		unsigned char raw[sizeof(midstate)];
+		std::memcpy(raw, &m, sizeof(m));
+		midstate copy;
+		std::memcpy(&copy, raw, sizeof(copy));
+		check(Hasher(copy).update(msg.data() + cut, msg.size() - cut).finalize() == want, at + ", through a byte copy");
+
+		// the same prefix fed in other pieces gives the same bytes
+		Hasher p;
+		for(size_t off = 0; off < cut; off += 13)
+			p.update(&msg[off], std::min<size_t>(13, cut - off));
+		midstate again = p.save();
+		check(std::memcmp(&again, &m, sizeof(m)) == 0, at + ", snapshots of the same prefix differ");
+	}
+}
+
+
+
+int main(int argc, char* argv[]) {
+	init(argc, argv);
+	snapshots<sha1::hasher>("sha1");
+	snapshots<sha2::hasher_224>("sha224");
+	snapshots<sha2::hasher_256>("sha256");
+	snapshots<sha2::hasher_384>("sha384");
+	snapshots<sha2::hasher_512>("sha512");
+	snapshots<sha2::hasher_512_256>("sha512/256");
+	snapshots<sha3::hasher_256>("sha3-256");
+	snapshots<sha3::hasher_512>("sha3-512");
+	snapshots<sha3::hasher_shake_128<256>>("shake128");
+	snapshots<sha3::hasher_shake_256<512>>("shake256");
+	return done();
+}
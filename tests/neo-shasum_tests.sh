@@ -0,0 +1,70 @@
+#!/bin/sh
+#
+#	neo-shasum_tests: neo-shasum against the coreutils sha*sum tools on the same files
+#
+#	Usage:
+#		sh tests/neo-shasum_tests.sh ./neo-shasum
+#
+#		builds a scratch directory of small, empty, mapped (> 1 MiB) and multi-window files with awkward names, then compares
+#		stdout and exit status of both tools for plain, --tag and -c runs; prints each mismatch, exits with 1 when there was any
+#
+
+LC_ALL=C
+export LC_ALL
+
+tool=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+[ -x "$tool" ] || { echo "usage: $0 path/to/neo-shasum"; exit 2; }
+
+dir=$(mktemp -d) || exit 2
+trap 'rm -rf "$dir"' EXIT
+cd "$dir" || exit 2
+
+checks=0
+failures=0
+
+# same stdout and exit status from both commands
+same() {
+	what=$1
+	shift
+	want=$(eval "$1" 2>/dev/null; echo "status $?")
+	got=$(eval "$2" 2>/dev/null; echo "status $?")
+	checks=$((checks + 1))
+	if [ "$want" != "$got" ]; then
+		failures=$((failures + 1))
+		echo "FAIL $what"
+		echo "  $1:"
+		echo "$want" | sed 's/^/    /'
+		echo "  $2:"
+		echo "$got" | sed 's/^/    /'
+	fi
+}
+
+mkdir d
+: > d/empty
+printf abc > d/abc
+printf 'with space' > 'd/a name'
+printf back > 'd/back\slash'
+head -c 1000 /dev/urandom > d/small
+head -c 3000000 /dev/urandom > d/mapped
+head -c 20000001 /dev/urandom > d/windows
+
+for a in 1 224 256 384 512; do
+	same "sha$a files" "sha${a}sum d/*" "'$tool' -a sha$a d/*"
+	same "sha$a --tag" "sha${a}sum --tag d/*" "'$tool' -a sha$a --tag d/*"
+done
+same "one job" "sha256sum d/*" "'$tool' -j 1 d/*"
+same "missing file" "sha256sum d/abc d/missing d/empty" "'$tool' d/abc d/missing d/empty"
+same "stdin" "sha256sum < d/mapped" "'$tool' < d/mapped"
+same "-r" "sha256sum d/*" "'$tool' -r d"
+
+sha512sum d/* > list
+sha512sum --tag d/abc d/small > tagged
+same "-c" "sha512sum -c list" "'$tool' -a sha512 -c list"
+same "-c --tag lines" "sha512sum -c tagged" "'$tool' -a sha512 -c tagged"
+same "-c --quiet" "sha512sum -c --quiet list" "'$tool' -a sha512 -c --quiet list"
+printf x >> d/small
+same "-c with a changed file" "sha512sum -c list" "'$tool' -a sha512 -c list"
+same "-c --status" "sha512sum -c --status list" "'$tool' -a sha512 -c --status list"
+
+echo "$checks checks, $failures failed"
+[ $failures = 0 ]
@@ -0,0 +1,145 @@
+/*
+*	parallel_tests: parallel_hash against one message at a time, on the shared pool, a pool of its own, a serial executor, from two threads at once and nested in a pool's own work
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I. tests/parallel_tests.cpp -o parallel_tests -lpthread
+*
+*	Usage:
+*		parallel_tests [--quick]
+*/
+
+
+#include "sha_test.hpp"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using namespace neo::hash;
+using namespace sha_test;
+
+
+
+// the executor interface run on the calling thread, chunk after chunk, with as many runs as a 4 thread pool would get
+struct serial_executor {
+	size_t size() const {
+		return 4;
+	}
+	template<class Fn>
+	void parallel_for(size_t count, size_t grain, Fn fn) {
+		for(size_t b = 0; b < count; b += grain)
+			fn(b, std::min(b + grain, count));
+	}
+};
+
+// count messages of 0 to 300 bytes, every 997th one a big outlier
+static std::vector<std::string> messages(size_t count, uint64_t seed) {
+	std::vector<std::string> msgs(count);
+	std::vector<uint8_t> lens = noise(count, seed);
+	const size_t big = quick ? 1 << 20 : 4 << 20;
+	for(size_t i = 0; i < count; i++) {
+		size_t len = i % 997 == 500 ? big + i : lens[i] + (lens[i] & 0x2c);
+		std::vector<uint8_t> bytes = noise(len, seed + i);
+		msgs[i].assign(bytes.begin(), bytes.end());
+	}
+	return msgs;
+}
+
+template<class Hasher>
+static void batches(const char* name, thread_pool& pool) {
+
+	typedef sha_t<Hasher::bits> digest;
+	digest zero;
+	zero.fill(0);
+
+	for(size_t count : {size_t(0), size_t(1), size_t(2), size_t(63), size_t(64), size_t(65), size_t(1000), size_t(quick ? 3000 : 20000)}) {
+
+		const std::string at = std::string(name) + " of " + std::to_string(count);
+		const std::vector<std::string> msgs = messages(count, count);
+		std::vector<buffer> bufs(count);
+		std::vector<digest> want(count);
+		for(size_t i = 0; i < count; i++) {
+			bufs[i] = buffer{msgs[i].data(), msgs[i].size()};
+			want[i] = Hasher().update(msgs[i].data(), msgs[i].size()).finalize();
+		}
+
+		std::vector<digest> got(count, zero);
+		parallel_hash<Hasher>(msgs.begin(), msgs.end(), got.begin());
+		check(got == want, at + " of strings on the shared pool");
+
+		got.assign(count, zero);
+		parallel_hash<Hasher>(bufs.data(), bufs.data() + count, got.data(), pool);
+		check(got == want, at + " of buffers on a pool of 3");
+
+		got.assign(count, zero);
+		serial_executor serial;
+		parallel_hash<Hasher>(bufs.data(), bufs.data() + count, got.data(), serial);
+		check(got == want, at + " on a serial executor");
+	}
+
+	// two callers on the same pool
+	const std::vector<std::string> a = messages(2000, 1), b = messages(1500, 2);
+	std::vector<digest> got_a(a.size()), got_b(b.size());
+	std::thread other([&] {
+		parallel_hash<Hasher>(b.begin(), b.end(), got_b.begin(), pool);
+	});
+	parallel_hash<Hasher>(a.begin(), a.end(), got_a.begin(), pool);
+	other.join();
+	bool ok = true;
+	for(size_t i = 0; i < a.size(); i++)
+		ok &= got_a[i] == Hasher().update(a[i].data(), a[i].size()).finalize();
+	for(size_t i = 0; i < b.size(); i++)
+		ok &= got_b[i] == Hasher().update(b[i].data(), b[i].size()).finalize();
+	check(ok, std::string(name) + " from two threads on one pool");
+}
+
+// parallel_hash from inside a parallel_for: into the same pool, into another one, and two pools into each other from two threads
+static void nested() {
+
+	typedef sha_t<256> digest;
+	const std::vector<std::string> msgs = messages(quick ? 500 : 3000, 7);
+	std::vector<digest> want(msgs.size());
+	for(size_t i = 0; i < msgs.size(); i++)
+		want[i] = sha2::hash_256(msgs[i].data(), msgs[i].size());
+
+	thread_pool a(3), b(2);
+	const auto inside = [&](thread_pool& outer, thread_pool& inner) {
+		std::vector<std::vector<digest>> got(6, std::vector<digest>(msgs.size()));
+		outer.parallel_for(got.size(), 1, [&](size_t s, size_t e) {
+			for(size_t i = s; i < e; i++)
+				parallel_hash<sha2::hasher_256>(msgs.begin(), msgs.end(), got[i].begin(), i % 2 ? inner : outer);
+		});
+		bool ok = true;
+		for(const std::vector<digest>& g : got)
+			ok &= g == want;
+		return ok;
+	};
+
+	check(inside(a, b), "parallel_hash nested in the same pool and in another one");
+	bool other = false;
+	std::thread t([&] {
+		other = inside(b, a);
+	});
+	const bool mine = inside(a, b);
+	t.join();
+	check(mine && other, "two pools nested into each other from two threads");
+}
+
+
+
+int main(int argc, char* argv[]) {
+	init(argc, argv);
+	thread_pool pool(3);
+	for_each_backend([&] {
+		batches<sha1::hasher>("sha1", pool);
+		batches<sha2::hasher_224>("sha224", pool);
+		batches<sha2::hasher_256>("sha256", pool);
+		batches<sha2::hasher_512>("sha512", pool);
+		batches<sha3::hasher_256>("sha3-256", pool);
+		batches<sha3::hasher_shake_128<256>>("shake128", pool);
+	});
+	nested();
+	return done();
+}
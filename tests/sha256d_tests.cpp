@@ -0,0 +1,96 @@
+/*
+*	sha256d_tests: hash_256d on the bitcoin genesis header, scan_256d against a plain loop over hash_256d, under every backend
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I. tests/sha256d_tests.cpp -o sha256d_tests -lpthread
+*
+*	Usage:
+*		sha256d_tests [--quick]
+*/
+
+
+#include "sha_test.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+using namespace neo::hash;
+using namespace sha_test;
+
+
+
+static const std::vector<uint8_t> genesis = bytes_of("0100000000000000000000000000000000000000000000000000000000000000000000003ba3edfd7a7b12b27ac72c3e67768f617fc81bc3888a51323a9fb8aa4b1e5e4a29ab5f49ffff001d1dac2b7c");
+static const uint32_t genesis_nonce = 2083236893;
+
+static std::vector<nonce_match> loop(const std::vector<uint8_t>& header, uint32_t first, uint64_t count, const sha_t<256>& target, size_t max_matches) {
+	std::vector<nonce_match> found;
+	std::vector<uint8_t> h = header;
+	for(uint64_t i = 0; i < count && (!max_matches || found.size() < max_matches); i++) {
+		uint32_t n = static_cast<uint32_t>(first + i);
+		for(size_t b = 0; b < 4; b++)
+			h[76 + b] = static_cast<uint8_t>(n >> (b * 8));
+		sha_t<256> d = sha2::hash_256d(h.data(), h.size());
+		if(d < target)
+			found.push_back({n, d});
+	}
+	return found;
+}
+
+static bool same(const std::vector<nonce_match>& a, const std::vector<nonce_match>& b) {
+	if(a.size() != b.size())
+		return false;
+	for(size_t i = 0; i < a.size(); i++)
+		if(a[i].nonce != b[i].nonce || a[i].digest != b[i].digest)
+			return false;
+	return true;
+}
+
+static void scans() {
+
+	// the genesis block hash, in the byte order it's usually printed in reversed
+	check_hex(sha2::hash_256d(genesis.data(), genesis.size()), "6fe28c0ab6f1b372c1a6a246ae63f74f931e8365e15a089c68d6190000000000", "sha256d of the genesis header");
+	sha_t<256> all;
+	all.fill(0xff);
+	std::vector<nonce_match> one = sha2::scan_256d(genesis.data(), genesis_nonce, 1, all);
+	check(one.size() == 1 && one[0].nonce == genesis_nonce && one[0].digest == sha2::hash_256d(genesis.data(), genesis.size()), "scan of the genesis nonce");
+	check(sha2::scan_256d(genesis.data(), 0, 0, all).empty(), "scan of no nonces");
+
+	// about 1 in 64 nonces below it
+	sha_t<256> target;
+	target.fill(0);
+	target[0] = 0x04;
+	const uint64_t count = quick ? 1 << 16 : 1 << 19;
+	for(uint32_t first : {uint32_t(0), genesis_nonce - 5000, uint32_t(0xFFFFFFFF) - 3000}) {
+		const std::string at = "scan from " + std::to_string(first);
+		const std::vector<nonce_match> want = loop(genesis, first, count, target, 0);
+		check(want.size() > count / 128, at + " found too few to compare");
+		check(same(sha2::scan_256d(genesis.data(), first, count, target), want), at);
+		check(same(sha2::scan_256d(genesis.data(), first, 777, target), loop(genesis, first, 777, target, 0)), at + ", 777 nonces");
+		for(size_t max_matches : {size_t(1), size_t(5), size_t(100)})
+			check(same(sha2::scan_256d(genesis.data(), first, count, target, max_matches), std::vector<nonce_match>(want.begin(), want.begin() + max_matches)), at + ", first " + std::to_string(max_matches));
+	}
+
+	// past 2^32 nonces every nonce has been seen: the count is capped, the first matches come once each and in order
+	for(uint32_t first : {uint32_t(0), uint32_t(0xFFFFFFFF) - 2}) {
+		const std::string at = "scan of 2^32 + 1000 from " + std::to_string(first);
+		const std::vector<nonce_match> want = loop(genesis, first, 10, all, 10);
+		check(same(sha2::scan_256d(genesis.data(), first, (uint64_t(1) << 32) + 1000, all, 10), want), at);
+	}
+
+	// nothing is below zero
+	sha_t<256> zero;
+	zero.fill(0);
+	check(sha2::scan_256d(genesis.data(), 0, 100000, zero).empty(), "scan below zero");
+}
+
+
+
+int main(int argc, char* argv[]) {
+	init(argc, argv);
+	for_each_backend([] {
+		scans();
+	});
+	return done();
+}
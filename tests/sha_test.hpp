@@ -0,0 +1,147 @@
+#pragma once
+
+#ifndef __NEO_SHA_TEST_HPP__
+#define __NEO_SHA_TEST_HPP__
+
+
+/*
+*	Notes:
+*		- Checks shared by the programs in tests/, each of them is built on its own (see the README)
+*		- A failed check prints what it was and where, the program goes on and exits with 1 at the end
+*/
+
+
+#include "sha.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+namespace sha_test {
+
+	static size_t failures = 0, checks = 0;
+	static bool quick = false;
+	static const char* context = "";
+
+	// --quick trims the slowest loops
+	inline void init(int argc, char* argv[]) {
+		for(int i = 1; i < argc; i++)
+			quick |= std::strcmp(argv[i], "--quick") == 0;
+	}
+	inline int done() {
+		std::printf("%zu checks, %zu failed\n", checks, failures);
+		return failures ? 1 : 0;
+	}
+
+	inline void check(bool ok, const std::string& what) {
+		checks++;
+		if(!ok) {
+			failures++;
+			std::printf("FAIL [%s] %s\n", context, what.c_str());
+		}
+	}
+
+	template<size_t Bits>
+	inline void check_hex(const neo::hash::sha_t<Bits>& d, const char* hex, const std::string& what) {
+		check(d.to_str() == hex, what + ": " + d.to_str() + " != " + hex);
+	}
+
+	template<class Ex, class Fn>
+	inline void check_throws(Fn fn, const std::string& what) {
+		bool thrown = false;
+		try {
+			fn();
+		}
+		catch(const Ex&) {
+			thrown = true;
+		}
+		check(thrown, what + " did not throw");
+	}
+
+	inline std::vector<uint8_t> bytes_of(const std::string& hex) {
+		std::vector<uint8_t> v(hex.size() / 2);
+		for(size_t i = 0; i < v.size(); i++)
+			v[i] = static_cast<uint8_t>(std::stoul(hex.substr(i * 2, 2), nullptr, 16));
+		return v;
+	}
+
+	// deterministic filler, the same on every run
+	inline std::vector<uint8_t> noise(size_t n, uint32_t seed) {
+		std::vector<uint8_t> v(n);
+		uint32_t x = seed * 2654435761u + 1;
+		for(size_t i = 0; i < n; i++) {
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			v[i] = static_cast<uint8_t>(x);
+		}
+		return v;
+	}
+
+	// around every block boundary of the 64, 128, 136 and 168 byte blocks, then a few multi-block lengths
+	inline std::vector<size_t> lengths() {
+		std::vector<size_t> l;
+		for(size_t i = 0; i <= 260; i++)
+			l.push_back(i);
+		for(size_t n : {511, 512, 513, 1000, 1343, 1344, 4095, 4096, 8191, 8192, 8193, 20000})
+			l.push_back(n);
+		return l;
+	}
+
+	inline const char* name(neo::hash::backend b) {
+		switch(b) {
+			case neo::hash::backend::scalar:
+				return "scalar";
+			case neo::hash::backend::sha_ni:
+				return "sha_ni";
+			case neo::hash::backend::avx2:
+				return "avx2";
+			case neo::hash::backend::avx512:
+				return "avx512";
+			default:
+				return "automatic";
+		}
+	}
+
+	// forces b on every kernel that has it, false when none does
+	inline bool force(neo::hash::backend b) {
+		bool any = false;
+		any |= neo::hash::sha1::set_backend(b);
+		any |= neo::hash::sha2::set_backend_256(b);
+		any |= neo::hash::sha2::set_backend_512(b);
+		any |= neo::hash::sha2::set_batch_backend_256(b);
+		any |= neo::hash::sha2::set_batch_backend_512(b);
+		any |= neo::hash::sha3::set_batch_backend(b);
+		return any;
+	}
+
+	// runs fn once per backend the cpu supports, scalar first so its results can be the reference of the others
+	template<class Fn>
+	inline void for_each_backend(Fn fn) {
+		using neo::hash::backend;
+		for(backend b : {backend::scalar, backend::sha_ni, backend::avx2, backend::avx512, backend::automatic}) {
+			force(backend::automatic);
+			if(!force(b))
+				continue;
+			context = name(b);
+			fn();
+		}
+		force(backend::automatic);
+		context = "";
+	}
+
+	// the first call stores got, the later ones must match it
+	template<class T>
+	inline void check_same(std::vector<T>& reference, const std::vector<T>& got, const std::string& what) {
+		if(reference.empty())
+			reference = got;
+		check(got == reference, what + " differs from scalar");
+	}
+
+}
+
+
+#endif
@@ -0,0 +1,101 @@
+/*
+*	stats_tests: hash_stats counters (NEO_SHA_STATS_TSC) against the blocks each call must compress, per thread and in total, under every backend
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I. tests/stats_tests.cpp -o stats_tests -lpthread
+*
+*	Usage:
+*		stats_tests
+*/
+
+
+#define NEO_SHA_STATS_TSC
+#include "sha_test.hpp"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using namespace neo::hash;
+using namespace sha_test;
+
+
+
+// the counters of a, moved by fn() on this thread
+template<class Fn>
+static hash_counters moved(hash_stats::algorithm a, Fn fn) {
+	hash_counters before = hash_stats::thread(a);
+	fn();
+	hash_counters after = hash_stats::thread(a);
+	after.calls -= before.calls;
+	after.blocks -= before.blocks;
+	after.bytes -= before.bytes;
+	after.cycles -= before.cycles;
+	for(size_t i = 0; i < 32; i++)
+		after.histogram[i] -= before.histogram[i];
+	return after;
+}
+
+// blocks moved by fn() between want and most, most defaults to want
+template<class Fn>
+static void blocks(hash_stats::algorithm a, uint64_t want, const std::string& what, Fn fn, uint64_t most = 0) {
+	const std::string at = std::string(hash_stats::name(a)) + " " + what;
+	hash_counters c = moved(a, fn);
+	check(c.blocks >= want && c.blocks <= std::max(want, most), at + ": " + std::to_string(c.blocks) + " blocks, not " + std::to_string(want));
+	check(c.bytes == c.blocks * hash_stats::block_size(a), at + " bytes");
+	uint64_t timed = 0;
+	for(size_t i = 0; i < 32; i++)
+		timed += c.histogram[i];
+	check(c.calls >= 1 && timed == c.calls && c.cycles > 0, at + " calls and timings");
+}
+
+static void counting() {
+
+	const std::vector<uint8_t> msg = noise(1000, 1);
+
+	// message plus padding: 1009 bytes in 64 byte blocks, 1017 in 128 byte ones, 1001 over the 136 or 168 byte rates
+	blocks(hash_stats::algorithm::sha1, 16, "1000 bytes", [&] { sha1::hash(msg.data(), msg.size()); });
+	blocks(hash_stats::algorithm::sha2_256, 16, "1000 bytes", [&] { sha2::hash_256(msg.data(), msg.size()); });
+	blocks(hash_stats::algorithm::sha2_256, 16, "sha224 of 1000 bytes", [&] { sha2::hash_224(msg.data(), msg.size()); });
+	blocks(hash_stats::algorithm::sha2_512, 8, "1000 bytes", [&] { sha2::hash_512(msg.data(), msg.size()); });
+	blocks(hash_stats::algorithm::sha2_512, 8, "sha512/256 of 1000 bytes", [&] { sha2::hash_512_256(msg.data(), msg.size()); });
+	blocks(hash_stats::algorithm::sha3_256, 8, "1000 bytes", [&] { sha3::hash_256(msg.data(), msg.size()); });
+	blocks(hash_stats::algorithm::shake_128, 6, "1000 bytes", [&] { sha3::hash_shake_128<256>(msg.data(), msg.size()); });
+	blocks(hash_stats::algorithm::sha2_256, 2, "incremental 64 bytes", [&] { sha2::hasher_256().update(msg.data(), 10).update(msg.data(), 54).finalize(); });
+
+	// every lane of a multi-lane call counts, an idle one too: up to a lane count (16 at most) of them per step
+	std::vector<buffer> bufs(13, buffer{msg.data(), 100});
+	std::vector<sha_t<256>> out(bufs.size());
+	blocks(hash_stats::algorithm::sha2_256, 26, "batch of 13", [&] { sha2::hash_256_many(bufs.data(), bufs.size(), out.data()); }, 2 * 16);
+	std::vector<sha_t<512>> out512(bufs.size());
+	blocks(hash_stats::algorithm::sha2_512, 13, "batch of 13", [&] { sha2::hash_512_many(bufs.data(), bufs.size(), out512.data()); }, 2 * 8);
+	blocks(hash_stats::algorithm::sha3_512, 26, "batch of 13", [&] { sha3::hash_512_many(bufs.data(), bufs.size(), out512.data()); }, 2 * 16);
+
+	// another algorithm doesn't move
+	check(moved(hash_stats::algorithm::sha2_512, [&] { sha2::hash_256(msg.data(), msg.size()); }).calls == 0, "sha256 counted as sha2-512");
+
+	// an exited thread's counts stay in total(), not in this thread's
+	hash_counters total = hash_stats::total(hash_stats::algorithm::sha1), mine = hash_stats::thread(hash_stats::algorithm::sha1);
+	std::thread([&] {
+		sha1::hash(msg.data(), msg.size());
+	}).join();
+	check(hash_stats::total(hash_stats::algorithm::sha1).blocks == total.blocks + 16, "total() after a thread exited");
+	check(hash_stats::thread(hash_stats::algorithm::sha1).blocks == mine.blocks, "thread() counted another thread");
+
+	check(hash_stats::active_backend(hash_stats::algorithm::sha2_256) == sha2::active_backend_256(), "active_backend(sha2-256)");
+	check(hash_stats::active_batch_backend(hash_stats::algorithm::sha2_512) == sha2::active_batch_backend_512(), "active_batch_backend(sha2-512)");
+	check(hash_stats::active_batch_backend(hash_stats::algorithm::sha3_256) == sha3::active_batch_backend(), "active_batch_backend(sha3-256)");
+}
+
+
+
+int main(int argc, char* argv[]) {
+	init(argc, argv);
+	static_assert(hash_stats::enabled() && hash_stats::timed(), "NEO_SHA_STATS_TSC is defined");
+	for_each_backend([] {
+		counting();
+	});
+	return done();
+}
@@ -0,0 +1,114 @@
+/*
+*	tree_tests: ParallelHash and KangarooTwelve against published vectors, under every Keccak backend
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I. tests/tree_tests.cpp -o tree_tests -lpthread
+*
+*	Usage:
+*		tree_tests [--quick]
+*/
+
+
+#include "sha_test.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+using namespace neo::hash;
+using namespace sha_test;
+
+
+
+// kangarootwelve test pattern (rfc 9861): 00 01 .. fa repeated
+static std::vector<uint8_t> ptn(size_t n) {
+	std::vector<uint8_t> v(n);
+	for(size_t i = 0; i < n; i++)
+		v[i] = static_cast<uint8_t>(i % 251);
+	return v;
+}
+static std::string str_of(const std::vector<uint8_t>& v) {
+	return std::string(v.begin(), v.end());
+}
+
+// sp 800-185 samples, rfc 9861 vectors; the ptn(100000) ones come from pycryptodome's cSHAKE and TurboSHAKE
+static void known_answers() {
+
+	const std::vector<uint8_t> x = bytes_of("000102030405060710111213141516172021222324252627");
+	check_hex(sha3::hash_parallel_128<256>(x.data(), x.size(), 8), "ba8dc1d1d979331d3f813603c67f72609ab5e44b94a0b8f9af46514454a2b4f5", "parallelhash128 sample 1");
+	check_hex(sha3::hash_parallel_128<256>(x.data(), x.size(), 8, "Parallel Data"), "fc484dcb3f84dceedc353438151bee58157d6efed0445a81f165e495795b7206", "parallelhash128 sample 2");
+	check_hex(sha3::hash_parallel_256<512>(x.data(), x.size(), 8), "bc1ef124da34495e948ead207dd9842235da432d2bbc54b4c110e64c451105531b7f2a3e0ce055c02805e7c2de1fb746af97a1dd01f43b824e31b87612410429", "parallelhash256 sample 4");
+
+	struct vector_t {
+		size_t m, c;
+		const char* hex;
+	};
+	const vector_t kt128[] = {
+		{0, 0, "1ac2d450fc3b4205d19da7bfca1b37513c0803577ac7167f06fe2ce1f0ef39e5"},
+		{1, 0, "2bda92450e8b147f8a7cb629e784a058efca7cf7d8218e02d345dfaa65244a1f"},
+		{17, 0, "6bf75fa2239198db4772e36478f8e19b0f371205f6a9a93a273f51df37122888"},
+		{289, 0, "0c315ebcdedbf61426de7dcf8fb725d1e74675d7f5327a5067f367b108ecb67c"},
+		{4913, 0, "cb552e2ec77d9910701d578b457ddf772c12e322e4ee7fe417f92c758f0d59d0"},
+		{83521, 0, "8701045e22205345ff4dda05555cbb5c3af1a771c2b89baef37db43d9998b9fe"},
+		{0, 1, "fab658db63e94a246188bf7af69a133045f46ee984c56e3c3328caaf1aa1a583"},
+		{8191, 0, "1b577636f723643e990cc7d6a659837436fd6a103626600eb8301cd1dbe553d6"},
+		{8192, 0, "48f256f6772f9edfb6a8b661ec92dc93b95ebd05a08a17b39ae3490870c926c3"},
+		{8192, 8189, "3ed12f70fb05ddb58689510ab3e4d23c6c6033849aa01e1d8c220a297fedcd0b"},
+	};
+	for(const vector_t& v : kt128) {
+		const std::vector<uint8_t> m = ptn(v.m);
+		check_hex(sha3::hash_kt128<256>(m.data(), m.size(), str_of(ptn(v.c))), v.hex, "kt128 ptn(" + std::to_string(v.m) + "), ptn(" + std::to_string(v.c) + ")");
+	}
+	const uint8_t ff = 0xff;
+	check_hex(sha3::hash_kt128<256>(&ff, 1, str_of(ptn(41))), "d848c5068ced736f4462159b9867fd4c20b808acc3d5bc48e0b06ba0a3762ec4", "kt128 ff, ptn(41)");
+	check_hex(sha3::hash_kt256<512>("", 0), "b23d2e9cea9f4904e02bec06817fc10ce38ce8e93ef4c89e6537076af8646404e3e8b68107b8833a5d30490aa33482353fd4adc7148ecb782855003aaebde4a9", "kt256 empty");
+	const std::vector<uint8_t> p4 = ptn(83521);
+	check_hex(sha3::hash_kt256<512>(p4.data(), p4.size()), "b06275d284cd1cf205bcbe57dccd3ec1ff6686e3ed15776383e1f2fa3c6ac8f08bf8a162829db1a44b2a43ff83dd89c3cf1ceb61ede659766d5ccf817a62ba8d", "kt256 ptn(83521)");
+
+	const std::vector<uint8_t> big = ptn(100000);
+	check_hex(sha3::hash_parallel_128<256>(big.data(), big.size(), 1024, "c"), "1da5609060e451675ceee5e2ce712433c03ef76070c840ded8ccbb9ecfdd4a6d", "parallelhash128 ptn(100000)");
+	check_hex(sha3::hash_parallel_256<512>(big.data(), big.size()), "cbc57ae6e387a7ddf44d7c7b5c3c14f6e3a3cf1a25a2bd861dbc01350d84d408acad50ba116c5da6b71f7d5ffaf78d3b9864f958a9e180d420ea36404379c7c6", "parallelhash256 ptn(100000)");
+	check_hex(sha3::hash_kt128<256>(big.data(), big.size(), "c"), "a7cbcfb64edb10fa96ce83c74246d2928d22e49384b659a18863f0a75254deee", "kt128 ptn(100000)");
+}
+
+// leaf counts that fill the lanes, partly fill them and spread over the pool, against the scalar results
+struct references {
+	std::vector<sha_t<256>> ph128, kt128;
+	std::vector<sha_t<512>> ph256, kt256;
+};
+
+static void differential(references& r) {
+
+	const std::vector<uint8_t> data = noise(quick ? 70000 : 300000, 77);
+	std::vector<sha_t<256>> ph128, kt128;
+	std::vector<sha_t<512>> ph256, kt256;
+	for(size_t len : {size_t(0), size_t(1), size_t(8191), size_t(8192), size_t(8193), size_t(65536), size_t(69999), data.size()}) {
+		ph128.push_back(sha3::hash_parallel_128<256>(data.data(), len, 1024, "c"));
+		ph256.push_back(sha3::hash_parallel_256<512>(data.data(), len));
+		kt128.push_back(sha3::hash_kt128<256>(data.data(), len, "c"));
+		kt256.push_back(sha3::hash_kt256<512>(data.data(), len));
+	}
+	check_same(r.ph128, ph128, "parallelhash128");
+	check_same(r.ph256, ph256, "parallelhash256");
+	check_same(r.kt128, kt128, "kt128");
+	check_same(r.kt256, kt256, "kt256");
+}
+
+
+
+int main(int argc, char* argv[]) {
+	init(argc, argv);
+	references r;
+	for_each_backend([&] {
+		known_answers();
+		differential(r);
+	});
+	check_throws<std::invalid_argument>([] {
+		sha3::hash_parallel_128<256>("abc", 3, 0);
+	}, "parallelhash128 with a block_size of 0");
+	check_throws<std::invalid_argument>([] {
+		sha3::hash_parallel_256<512>("", 0, 0);
+	}, "parallelhash256 with a block_size of 0");
+	return done();
+}
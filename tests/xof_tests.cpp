@@ -0,0 +1,102 @@
+/*
+*	xof_tests: the SHAKE readers against published output, squeezed in pieces of any size
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I. tests/xof_tests.cpp -o xof_tests -lpthread
+*
+*	Usage:
+*		xof_tests
+*/
+
+
+#include "sha_test.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+using namespace neo::hash;
+using namespace sha_test;
+
+
+
+static std::string hex_of(const uint8_t* p, size_t n) {
+	static const char digits[] = "0123456789abcdef";
+	std::string s;
+	for(size_t i = 0; i < n; i++) {
+		s += digits[p[i] >> 4];
+		s += digits[p[i] & 15];
+	}
+	return s;
+}
+
+// output past the first rate block, where hash_shake_* used to go wrong; the digests of 64 KiB of output come from hashlib
+static void known_answers() {
+
+	uint8_t out[521];
+	sha3::xof_128().absorb("", 0).squeeze(out, sizeof(out));
+	check(hex_of(&out[160], 16) == "aee7eef47cb0fca9767be1fda69419df", "shake128 empty, bytes 160 to 176");
+	check(hex_of(&out[505], 16) == "1a45be97290b6f4cffda2cf990051634", "shake128 empty, last bytes of 521");
+	sha3::xof_256().absorb("", 0).squeeze(out, 425);
+	check(hex_of(&out[160], 16) == "77231395f6147293b68ceab7a9e0c58d", "shake256 empty, bytes 160 to 176");
+	check(hex_of(&out[409], 16) == "ae0f5fb1369db78f3ac45f8c4ac5671d", "shake256 empty, last bytes of 425");
+
+	std::vector<uint8_t> big(1 << 16);
+	sha3::xof_128().absorb("abc", 3).squeeze(big.data(), big.size());
+	check_hex(sha2::hash_256(big.data(), big.size()), "050dd149f510a3dec0954c7df592ac3b939a0e02d11226be545eb298beb6c088", "64 KiB of shake128 abc");
+	sha3::xof_256().absorb("abc", 3).squeeze(big.data(), big.size());
+	check_hex(sha2::hash_256(big.data(), big.size()), "3c100f53cb7956460ff9582bf027852d0811b299e34b2b72fe0e91e97c28c107", "64 KiB of shake256 abc");
+
+	sha_t<4096> fixed = sha3::hash_shake_128<4096>("abc", 3);
+	sha3::xof_128().absorb("abc", 3).squeeze(out, 512);
+	check(hex_of(out, 512) == fixed.to_str(), "hash_shake_128<4096> vs xof_128");
+	sha_t<4096> fixed256 = sha3::hash_shake_256<4096>("abc", 3);
+	sha3::xof_256().absorb("abc", 3).squeeze(out, 512);
+	check(hex_of(out, 512) == fixed256.to_str(), "hash_shake_256<4096> vs xof_256");
+}
+
+// absorbing or squeezing in pieces gives the same stream as in one call
+template<class Xof>
+static void pieces(const char* name) {
+
+	const std::vector<uint8_t> msg = noise(1000, 5);
+	std::vector<uint8_t> whole(5000), cut(5000);
+	Xof().absorb(msg.data(), msg.size()).squeeze(whole.data(), whole.size());
+
+	for(size_t piece : {size_t(1), size_t(7), size_t(135), size_t(136), size_t(168), size_t(169), size_t(1000)}) {
+		Xof x;
+		for(size_t off = 0; off < msg.size(); off += piece)
+			x.absorb(&msg[off], std::min(piece, msg.size() - off));
+		for(size_t off = 0; off < cut.size(); off += piece + 3)
+			x.squeeze(&cut[off], std::min(piece + 3, cut.size() - off));
+		check(cut == whole, std::string(name) + " in pieces of " + std::to_string(piece));
+	}
+
+	Xof x;
+	x.absorb("junk", 4).squeeze(cut.data(), 10);
+	x.reset();
+	x.absorb(msg.data(), msg.size()).squeeze(cut.data(), cut.size());
+	check(cut == whole, std::string(name) + " reset()");
+
+	// absorbing into a reader that already squeezed throws, absorbing after 0 bytes squeezed too
+	check_throws<std::logic_error>([&] {
+		x.absorb("more", 4);
+	}, std::string(name) + " absorb() after squeeze()");
+	x.reset();
+	x.squeeze(cut.data(), 0);
+	check_throws<std::logic_error>([&] {
+		x.absorb("more", 4);
+	}, std::string(name) + " absorb() after an empty squeeze()");
+}
+
+
+
+int main(int argc, char* argv[]) {
+	init(argc, argv);
+	known_answers();
+	pieces<sha3::xof_128>("xof_128");
+	pieces<sha3::xof_256>("xof_256");
+	return done();
+}
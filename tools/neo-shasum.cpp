@@ -0,0 +1,419 @@
+/*
+*	neo-shasum: sha*sum compatible checksums of many files at once (POSIX)
+*
+*	Build:
+*		g++ -std=c++17 -O2 -I.. neo-shasum.cpp -o neo-shasum -lpthread   (from tools/)
+*
+*	Usage:
+*		neo-shasum [-a ALGORITHM] [-j JOBS] [-r] [--tag] [FILE]...
+*		neo-shasum [-a ALGORITHM] [-j JOBS] -c [--quiet] [--status] [FILE]...
+*
+*		ALGORITHM: sha1, sha224, sha256 (default), sha384, sha512, sha512-224, sha512-256, sha3-224, sha3-256, sha3-384, sha3-512
+*		files are hashed on JOBS threads (default: hardware threads), output keeps the argument order,
+*		large files are mapped and read ahead while the previous window is hashed
+*/
+
+
+#include "sha.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <csetjmp>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+using namespace neo::hash;
+
+
+
+// files from this size on are mapped, hashed a window at a time with the next window read ahead
+static const size_t map_threshold = size_t(1) << 20;
+static const size_t map_window    = size_t(8) << 20;
+static const size_t read_size     = size_t(256) << 10;
+
+struct algorithm_info {
+	const char* name;
+	const char* tag;
+	size_t hex_len;
+	bool (*hash)(int fd, std::string& hex, std::string& err);
+};
+
+struct job {
+	std::string path;
+	std::string expected;	// check mode
+	std::string hex, err;
+	bool done;
+};
+
+static const algorithm_info* alg;
+static bool tag_output = false, quiet = false, status_only = false;
+
+
+
+template<class Hasher>
+static bool hash_read(int fd, Hasher& h, std::string& err) {
+	static thread_local std::vector<uint8_t> buf(read_size);
+	while(true) {
+		ssize_t n = ::read(fd, buf.data(), buf.size());
+		if(n < 0) {
+			if(errno == EINTR)
+				continue;
+			err = std::strerror(errno);
+			return false;
+		}
+		if(n == 0)
+			return true;
+		h.update(buf.data(), static_cast<size_t>(n));
+	}
+}
+
+// a mapped file truncated by someone else faults with SIGBUS on the missing pages, the handler jumps back into the hash_fd that
+// owns the mapping on this thread so it becomes an error on that file instead of killing the process
+static thread_local sigjmp_buf* volatile bus_jump = nullptr;
+
+static void on_sigbus(int sig) {
+	if(bus_jump)
+		siglongjmp(*bus_jump, 1);
+	std::signal(sig, SIG_DFL);
+	std::raise(sig);
+}
+
+template<class Hasher>
+static bool hash_fd(int fd, std::string& hex, std::string& err) {
+
+	Hasher h;
+	struct stat st;
+
+	if(::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && static_cast<size_t>(st.st_size) >= map_threshold) {
+		size_t size = static_cast<size_t>(st.st_size);
+		void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(map != MAP_FAILED) {
+			sigjmp_buf jump;
+			if(sigsetjmp(jump, 1)) {
+				bus_jump = nullptr;
+				::munmap(map, size);
+				err = "Input/output error (file truncated while hashing)";
+				return false;
+			}
+			bus_jump = &jump;
+			const uint8_t* p = static_cast<const uint8_t*>(map);
+			::madvise(map, size, MADV_SEQUENTIAL);
+			for(size_t off = 0; off < size; off += map_window) {
+				size_t n = std::min(map_window, size - off);
+				if(off + n < size)
+					::madvise(const_cast<uint8_t*>(p + off + n), std::min(map_window, size - off - n), MADV_WILLNEED);
+				h.update(p + off, n);
+				::madvise(const_cast<uint8_t*>(p + off), n, MADV_DONTNEED);
+			}
+			bus_jump = nullptr;
+			::munmap(map, size);
+			hex = h.finalize().to_str();
+			return true;
+		}
+	}
+
+	if(!hash_read(fd, h, err))
+		return false;
+	hex = h.finalize().to_str();
+	return true;
+}
+
+static const algorithm_info algorithms[] = {
+	{"sha1",       "SHA1",       40,  hash_fd<sha1::hasher>},
+	{"sha224",     "SHA224",     56,  hash_fd<sha2::hasher_224>},
+	{"sha256",     "SHA256",     64,  hash_fd<sha2::hasher_256>},
+	{"sha384",     "SHA384",     96,  hash_fd<sha2::hasher_384>},
+	{"sha512",     "SHA512",     128, hash_fd<sha2::hasher_512>},
+	{"sha512-224", "SHA512/224", 56,  hash_fd<sha2::hasher_512_224>},
+	{"sha512-256", "SHA512/256", 64,  hash_fd<sha2::hasher_512_256>},
+	{"sha3-224",   "SHA3-224",   56,  hash_fd<sha3::hasher_224>},
+	{"sha3-256",   "SHA3-256",   64,  hash_fd<sha3::hasher_256>},
+	{"sha3-384",   "SHA3-384",   96,  hash_fd<sha3::hasher_384>},
+	{"sha3-512",   "SHA3-512",   128, hash_fd<sha3::hasher_512>},
+};
+
+
+
+static void hash_path(job& j) {
+
+	int fd = j.path == "-" ? 0 : ::open(j.path.c_str(), O_RDONLY | O_CLOEXEC);
+	if(fd < 0) {
+		j.err = std::strerror(errno);
+		return;
+	}
+
+	struct stat st;
+	if(::fstat(fd, &st) == 0 && S_ISDIR(st.st_mode))
+		j.err = "Is a directory";
+	else
+		alg->hash(fd, j.hex, j.err);
+
+	if(fd != 0)
+		::close(fd);
+}
+
+// coreutils escaping: names holding '\\', '\n' or '\r' get a leading backslash on the line and those chars escaped
+static std::string escape(const std::string& name, bool& escaped) {
+	std::string r;
+	escaped = false;
+	for(char c : name) {
+		if(c == '\\')
+			r += "\\\\", escaped = true;
+		else if(c == '\n')
+			r += "\\n", escaped = true;
+		else if(c == '\r')
+			r += "\\r", escaped = true;
+		else
+			r += c;
+	}
+	return r;
+}
+static std::string unescape(const std::string& name) {
+	std::string r;
+	for(size_t i = 0; i < name.size(); i++) {
+		if(name[i] == '\\' && i + 1 < name.size()) {
+			char c = name[++i];
+			r += c == 'n' ? '\n' : c == 'r' ? '\r' : c;
+		}
+		else
+			r += name[i];
+	}
+	return r;
+}
+
+// runs every job on jobs threads, report(i) is called in index order as soon as job i and all before it are done
+template<class Report>
+static void run(std::vector<job>& list, unsigned threads, Report report) {
+
+	std::atomic<size_t> next(0);
+	std::mutex mtx;
+	size_t reported = 0;
+
+	auto worker = [&] {
+		for(size_t i; (i = next++) < list.size(); ) {
+			hash_path(list[i]);
+			std::lock_guard<std::mutex> lock(mtx);
+			list[i].done = true;
+			for(; reported < list.size() && list[reported].done; reported++)
+				report(list[reported]);
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for(unsigned t = 1; t < threads && t < list.size(); t++)
+		pool.emplace_back(worker);
+	worker();
+	for(std::thread& t : pool)
+		t.join();
+}
+
+static void collect(const std::string& path, bool recursive, std::vector<job>& list) {
+
+	struct stat st;
+	if(recursive && path != "-" && ::lstat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+		DIR* dir = ::opendir(path.c_str());
+		if(dir) {
+			std::vector<std::string> names;
+			while(dirent* e = ::readdir(dir))
+				if(std::strcmp(e->d_name, ".") && std::strcmp(e->d_name, ".."))
+					names.push_back(e->d_name);
+			::closedir(dir);
+			std::sort(names.begin(), names.end());
+			for(const std::string& n : names)
+				collect(path.back() == '/' ? path + n : path + "/" + n, true, list);
+			return;
+		}
+	}
+
+	job j;
+	j.path = path;
+	j.done = false;
+	list.push_back(j);
+}
+
+static int compute(const std::vector<std::string>& args, bool recursive, unsigned threads) {
+
+	std::vector<job> list;
+	for(const std::string& a : args)
+		collect(a, recursive, list);
+
+	int rc = 0;
+	run(list, threads, [&](const job& j) {
+		if(!j.err.empty()) {
+			std::fprintf(stderr, "neo-shasum: %s: %s\n", j.path.c_str(), j.err.c_str());
+			rc = 1;
+			return;
+		}
+		bool escaped;
+		std::string name = escape(j.path, escaped);
+		if(tag_output)
+			std::printf("%s%s (%s) = %s\n", escaped ? "\\" : "", alg->tag, name.c_str(), j.hex.c_str());
+		else
+			std::printf("%s%s  %s\n", escaped ? "\\" : "", j.hex.c_str(), name.c_str());
+	});
+
+	return rc;
+}
+
+// "HEX  NAME", "HEX *NAME" or "TAG (NAME) = HEX", each optionally led by a backslash for escaped names
+static bool parse_line(std::string line, std::string& hex, std::string& name) {
+
+	if(!line.empty() && line.back() == '\r')
+		line.pop_back();
+	bool escaped = !line.empty() && line[0] == '\\';
+	if(escaped)
+		line.erase(0, 1);
+
+	std::string tag = std::string(alg->tag) + " (";
+	if(line.compare(0, tag.size(), tag) == 0) {
+		size_t eq = line.rfind(") = ");
+		if(eq == std::string::npos || eq < tag.size())
+			return false;
+		name = line.substr(tag.size(), eq - tag.size());
+		hex  = line.substr(eq + 4);
+	}
+	else {
+		if(line.size() < alg->hex_len + 2 || line[alg->hex_len] != ' ' || (line[alg->hex_len + 1] != ' ' && line[alg->hex_len + 1] != '*'))
+			return false;
+		hex  = line.substr(0, alg->hex_len);
+		name = line.substr(alg->hex_len + 2);
+	}
+
+	if(escaped)
+		name = unescape(name);
+	return hex.size() == alg->hex_len && std::all_of(hex.begin(), hex.end(), ::isxdigit);
+}
+
+static int check(const std::vector<std::string>& lists, unsigned threads) {
+
+	std::vector<job> list;
+	size_t bad_lines = 0;
+
+	for(const std::string& l : lists) {
+		FILE* f = l == "-" ? stdin : std::fopen(l.c_str(), "r");
+		if(!f) {
+			std::fprintf(stderr, "neo-shasum: %s: %s\n", l.c_str(), std::strerror(errno));
+			return 1;
+		}
+		std::string line;
+		for(int c; (c = std::fgetc(f)) != EOF || !line.empty(); ) {
+			if(c != '\n' && c != EOF) {
+				line += static_cast<char>(c);
+				continue;
+			}
+			job j;
+			j.done = false;
+			if(parse_line(line, j.expected, j.path)) {
+				std::transform(j.expected.begin(), j.expected.end(), j.expected.begin(), ::tolower);
+				list.push_back(j);
+			}
+			else if(!line.empty())
+				bad_lines++;
+			line.clear();
+			if(c == EOF)
+				break;
+		}
+		if(f != stdin)
+			std::fclose(f);
+	}
+
+	size_t failed = 0, unreadable = 0;
+	run(list, threads, [&](const job& j) {
+		bool ok = j.err.empty() && j.hex == j.expected;
+		if(!j.err.empty()) {
+			unreadable++;
+			if(!status_only)
+				std::fprintf(stderr, "neo-shasum: %s: %s\n", j.path.c_str(), j.err.c_str());
+		}
+		else if(!ok)
+			failed++;
+		if(!status_only && (!ok || !quiet))
+			std::printf("%s: %s\n", j.path.c_str(), !j.err.empty() ? "FAILED open or read" : ok ? "OK" : "FAILED");
+	});
+
+	std::fflush(stdout);
+	if(!status_only) {
+		if(bad_lines)
+			std::fprintf(stderr, "neo-shasum: WARNING: %zu line%s improperly formatted\n", bad_lines, bad_lines == 1 ? " is" : "s are");
+		if(unreadable)
+			std::fprintf(stderr, "neo-shasum: WARNING: %zu listed file%s could not be read\n", unreadable, unreadable == 1 ? "" : "s");
+		if(failed)
+			std::fprintf(stderr, "neo-shasum: WARNING: %zu computed checksum%s did NOT match\n", failed, failed == 1 ? "" : "s");
+	}
+	if(list.empty() && !status_only)
+		std::fprintf(stderr, "neo-shasum: no properly formatted checksum lines found\n");
+
+	return failed || unreadable || list.empty() ? 1 : 0;
+}
+
+
+
+int main(int argc, char* argv[]) {
+
+	struct sigaction bus = {};
+	bus.sa_handler = on_sigbus;
+	sigemptyset(&bus.sa_mask);
+	::sigaction(SIGBUS, &bus, nullptr);
+
+	alg = &algorithms[2];
+	unsigned threads = std::max(std::thread::hardware_concurrency(), 1u);
+	bool check_mode = false, recursive = false;
+	std::vector<std::string> args;
+
+	for(int i = 1; i < argc; i++) {
+		std::string a = argv[i];
+		if((a == "-a" || a == "--algorithm") && i + 1 < argc) {
+			std::string name = argv[++i];
+			alg = nullptr;
+			for(const algorithm_info& x : algorithms)
+				if(name == x.name)
+					alg = &x;
+			if(!alg) {
+				std::fprintf(stderr, "neo-shasum: unknown algorithm '%s'\n", name.c_str());
+				return 1;
+			}
+		}
+		else if((a == "-j" || a == "--jobs") && i + 1 < argc)
+			threads = std::max(std::atoi(argv[++i]), 1);
+		else if(a == "-c" || a == "--check")
+			check_mode = true;
+		else if(a == "-r" || a == "--recursive")
+			recursive = true;
+		else if(a == "--tag")
+			tag_output = true;
+		else if(a == "--quiet")
+			quiet = true;
+		else if(a == "--status")
+			status_only = true;
+		else if(a == "-b" || a == "--binary" || a == "-t" || a == "--text")
+			continue; // no newline translation either way, as on every posix sha*sum
+		else if(a == "--")
+			args.insert(args.end(), argv + i + 1, argv + argc), i = argc;
+		else if(a.size() > 1 && a[0] == '-') {
+			std::fprintf(stderr, "usage: neo-shasum [-a ALGORITHM] [-j JOBS] [-r] [--tag] [-c [--quiet] [--status]] [FILE]...\n");
+			return 1;
+		}
+		else
+			args.push_back(a);
+	}
+
+	if(args.empty())
+		args.push_back("-");
+
+	return check_mode ? check(args, threads) : compute(args, recursive, threads);
+}